@@ -37,10 +37,10 @@ syn keyword higStructureComponents key grain ensemble
 syn keyword higGrainComponents shape:key layer:key refindex lattice scaling transvec repetition dimensions xspacing yspacing domain volfraction
 syn keyword higEnsembleComponents spacing maxgrains distribution orientations
 syn keyword higInstrumentationComponents scattering detector
-syn keyword higScatteringComponents expt alphai inplanerot tilt photon polarization coherence spotarea smearing
+syn keyword higScatteringComponents expt alphai inplanerot tilt photon polarization coherence spotarea smearing psf
 syn keyword higDetectorComponents origin totalpixels pixelsize sdd directbeam
-syn keyword higComputationComponents pathprefix inputdir runname method outputregion resolution nslices structcorrelation saveff savesf
-syn keyword higFittingComponenets fitparam key variable range init referencedata algorithm path fitregion npoints algoname algoorder algoparam restart tolerance
+syn keyword higComputationComponents pathprefix inputdir runname method outputregion resolution nslices structcorrelation saveff savesf trianglemethod triangletolerance densitypadding outputformat
+syn keyword higFittingComponenets fitparam key variable range init referencedata algorithm path fitregion npoints algoname algoorder algoparam restart tolerance rowcuts colcuts cutwidth sparse levels
 syn keyword higShapeParam type min max stat p1 p2 nvalues nextgroup=higNumber skipwhite
 syn keyword higRefindexParam delta beta
 syn keyword higLatticeParam a b c type hkl abangle caratio
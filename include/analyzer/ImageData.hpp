@@ -23,6 +23,7 @@
 #include <common/enums.hpp>
 #include <analyzer/enums.hpp>
 #include <analyzer/Data.hpp>
+#include <file/raw_data.hpp>
 
 namespace hig{
 
@@ -76,9 +77,9 @@ namespace hig{
       set_data(data);
     } // set_data()
     void set_data(const real_t* data) {
-      data_.clear();
-      for(unsigned int i = 0; i < n_par_ * n_ver_; ++ i) data_.push_back(data[i]);
+      data_.assign(data, data + n_par_ * n_ver_);
     } // set_data()
+    bool set_data(const RawDataFile& file);
 
     /* getters */
     //real_t img_p (int iv, int ip) const;
@@ -36,6 +36,7 @@ namespace hig {
       unsigned int num_obs_;
       std::vector<std::pair<hig::real_t, hig::real_t> > plimits_;   // parameter limits/bounds
       std::vector<hig::real_t> psteps_;                             // parameter step sizes
+      ObjectiveFunctionPool pool_;    // for the batched gradient evaluations
 
     public:
       FitLMVMAlgo() { name_= algo_lmvm; max_iter_ = 200; max_hist_ = 200; tol_ = 1e-6; }
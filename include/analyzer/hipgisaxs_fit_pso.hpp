@@ -151,6 +151,12 @@ namespace hig {
       comm_t particle_comm_;
       comm_t pmasters_comm_;
 
+      // shared memory evaluation of the local particles
+      unsigned int num_threads_;          // number of particles evaluated concurrently
+      unsigned int sim_num_threads_;      // number of threads for each particle simulation
+      ObjectiveFunctionPool pool_;        // obj_func_ and its clones for the threads
+      bool evaluate_particles(std::vector <real_vec_t>&);
+
       bool construct_neighbor_lists();
       bool neighbor_data_exchange();
 
@@ -166,6 +172,7 @@ namespace hig {
       bool simulate_random_generation();      // random connectivity with degree k
 
       unsigned int decode_pso_algo_type(real_t val) { return (unsigned int) val; }
+      void reset_best_fitness();          // forget the fitness of another resolution level
 
     public:
       ParticleSwarmOptimization(int, char**, ObjectiveFunction*,
@@ -47,6 +47,8 @@ namespace hig {
 
     public:
 
+      virtual ~ObjectiveFunction() { }
+
       virtual real_vec_t operator()(const real_vec_t&) = 0;
       virtual int num_fit_params() const = 0;
       virtual std::vector <std::string> fit_param_keys() const = 0;
@@ -60,6 +62,11 @@ namespace hig {
       virtual bool set_reference_data(char*) = 0;
       virtual bool set_regularization(real_t) = 0;
       virtual unsigned int data_size() const = 0;
+      // coarse-to-fine fitting: number of resolution levels, and switching between them
+      virtual int num_levels() const { return 1; }
+      virtual bool set_level(int) { return true; }
+      // an independent instance for concurrent evaluation, NULL if not supported
+      virtual ObjectiveFunction* clone() const { return NULL; }
       real_t* get_reference_data() { return ref_data_->data(); }
       unsigned int* get_mask_data() { return &(mask_data_[0]); }
       //virtual unsigned int n_par() const { }
@@ -81,6 +88,41 @@ namespace hig {
   }; // class ObjectiveFunction
 
 
+  /**
+   * An objective function and its clones, to evaluate batches of parameter vectors
+   * concurrently, one OpenMP thread per function. A batch is either split into contiguous
+   * parts, each evaluated in order by one function, so that a function sees consecutive
+   * vectors of the batch and its simulation can reuse the products which do not depend on
+   * the changed parameters, or handed out one vector at a time to balance unequal costs.
+   * Without clones (one thread, no OpenMP, or MPI builds) the batch is evaluated in order
+   * by the objective function itself.
+   */
+  class ObjectiveFunctionPool {
+    private:
+      ObjectiveFunction* obj_func_;             // evaluated by thread 0
+      std::vector <ObjectiveFunction*> clones_; // for threads 1 and up
+      unsigned int sim_num_threads_;            // threads for each simulation
+
+    public:
+      ObjectiveFunctionPool(): obj_func_(NULL), sim_num_threads_(0) { }
+      ~ObjectiveFunctionPool() { clear(); }
+
+      /* use num functions, each simulating with the given threads (0 to share all) */
+      bool init(ObjectiveFunction*, unsigned int num, unsigned int sim_num_threads);
+      void clear();
+      unsigned int size() const { return clones_.size() + 1; }
+
+      // applied to all functions
+      bool set_reference_data(int);
+      bool set_level(int);
+      bool set_regularization(real_t);
+
+      /* evaluate all parameter vectors, in parallel when there are clones, in contiguous
+       * parts or dynamically scheduled */
+      bool evaluate(const std::vector <real_vec_t>&, std::vector <real_vec_t>&, bool contiguous);
+  }; // class ObjectiveFunctionPool
+
+
   // lmvm
   PetscReal EvaluateFunction(TaoSolver , real_vec_t , void *);
   // pounders
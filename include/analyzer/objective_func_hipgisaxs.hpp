@@ -18,12 +18,28 @@ namespace hig {
   class HipGISAXSObjectiveFunction : public ObjectiveFunction {
     private:
       HipGISAXS hipgisaxs_;   // hipgisaxs object
+      int narg_;              // arguments and input file, to construct clones
+      char** args_;
+      std::string config_;
       unsigned int n_par_;    // nqy
       unsigned int n_ver_;    // nqz
 
       real_t* mean_data_;     // buffer to store simulated data with mean parameter vector
       real_t reg_alpha_;      // alpha for regularization
 
+      struct level_t {        // reference data binned for a coarse fitting level
+        unsigned int n_par_, n_ver_;
+        real_vec_t data_;
+        uint_vec_t mask_;
+      }; // struct level_t
+      std::vector<level_t> levels_;   // level l has 2^l x 2^l pixel bins, level 0 is the data
+      int ref_index_;         // the reference data of the levels
+      int level_;             // current level
+      bool build_levels(unsigned int);
+
+      void mask_line_cuts(const std::vector<unsigned int>&, const std::vector<unsigned int>&,
+                          unsigned int);
+
     public:
       HipGISAXSObjectiveFunction(int, char**, DistanceMeasure*);
       HipGISAXSObjectiveFunction(int, char**, std::string);
@@ -43,6 +59,9 @@ namespace hig {
       unsigned int n_par() const { return n_par_; }
       unsigned int n_ver() const { return n_ver_; }
       unsigned int data_size() const { return n_par_ * n_ver_; }
+      int num_levels() const { return levels_.empty() ? 1 : levels_.size(); }
+      bool set_level(int);
+      ObjectiveFunction* clone() const;
       real_t analysis_tolerance(int n) const { return hipgisaxs_.analysis_tolerance(n); }
       real_t analysis_regularization(int n) const { return hipgisaxs_.analysis_regularization(n); }
       std::vector <std::string> fit_param_keys() const { return hipgisaxs_.fit_param_keys(); }
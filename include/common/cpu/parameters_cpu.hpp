@@ -31,6 +31,13 @@ namespace hig {
 	// padding shape definitions
 	const unsigned int CPU_T_PROP_SIZE_ = 8;
 
+	// q-points per ana_tile_t of the analytic form factor kernels
+	const unsigned int CPU_ANA_TILE_Q_ = 128;
+
+	// q-point tile of the detector based triangle kernels, the work space of a tile
+	// (21 reals per q-point) stays in L1
+	const unsigned int CPU_TRI_TILE_Q_ = 128;
+
 } // namespace hig
 
 #endif // __PARAMETERS_CPU_HPP_
@@ -101,7 +101,8 @@ namespace hig {
     shape_file_error,
     shape_file_data,    /* shape file format .dat */
     shape_file_hdf5,    /* shape file in HDF5 format */
-    shape_file_object    /* wavefront OBJ object file (e.g. from maya) */
+    shape_file_object,   /* wavefront OBJ object file (e.g. from maya) */
+    shape_file_density   /* raw binary real-space density grid */
   }; // enum ShapeFileType
 
   enum StructCorrelationType {
@@ -113,6 +114,22 @@ namespace hig {
     structcorr_GE,      /* both correlated */
   }; // enum StructCorrelationType
 
+  enum TriangleMethodType {
+    triangle_method_error,    /* error type */
+    triangle_method_approx,   /* default, centroid approximation of each triangle */
+    triangle_method_exact,    /* exact integration over each triangle */
+    triangle_method_auto,     /* approximation where |q| * triangle size is small enough */
+    triangle_method_tree      /* cluster expansion where |q| * cluster size is small enough */
+  }; // enum TriangleMethodType
+
+  enum OutputFormatType {
+    output_format_error,      /* error type */
+    output_format_binary,     /* default, raw binary data file in working precision */
+    output_format_binary32,   /* raw binary data file in single precision */
+    output_format_text,       /* formatted text */
+    output_format_hdf5        /* one hdf5 container for a whole sweep */
+  }; // enum OutputFormatType
+
 
   /**
    * fitting related enums
@@ -147,7 +164,12 @@ namespace hig {
     algo_pso_param_nparticle,   /* number of particles for pso algorithm */
     algo_pso_param_ngen,        /* number of generations for pso algorithm */
     algo_pso_param_tune_omega,  /* flag to enable tuning pso omega parameter */
-    algo_pso_param_type         /* type of the pso algorithm flavor */
+    algo_pso_param_type,        /* type of the pso algorithm flavor */
+    algo_pso_param_nthread,     /* number of particles evaluated concurrently by threads */
+    algo_pso_param_sim_nthread, /* number of threads for each particle simulation */
+    algo_lmvm_param_nthread,    /* number of gradient evaluations run concurrently by threads */
+    algo_lmvm_param_sim_nthread,  /* number of threads for each gradient evaluation */
+    algo_lmvm_param_one_sided   /* flag to use one-sided gradient differences */
   }; // enum FitAlgorithmParamType
 
 
@@ -158,7 +180,8 @@ namespace hig {
     reference_file_null,    /* default, null type */
     reference_file_error,    /* error type */
     reference_file_ascii,    /* plain text file */
-    reference_file_edf      /* EDF file format */
+    reference_file_edf,      /* EDF file format */
+    reference_file_raw      /* raw binary data file */
   }; // ReferenceFileType
 
 
@@ -179,6 +202,20 @@ namespace hig {
     metric_sqrt_c_norm_l2_residual        /* sqrt of intensities, c norm, l2 dist, residual */
   }; // enum FittingDistanceMetricType
 
+  /**
+   * stages of a simulation whose products are reused between fitting evaluations
+   * (bit flags, a parameter update invalidates a combination of these)
+   */
+  enum FitStage {
+    fit_stage_none    = 0,
+    fit_stage_layer   = 1,    /* qz_extended and propagation coefficients */
+    fit_stage_grains  = 2,    /* grain positions and orientations */
+    fit_stage_samples = 4,    /* grain scaling samples and repetitions */
+    fit_stage_ff      = 8,    /* form factors of the grains */
+    fit_stage_sf      = 16,   /* structure factors */
+    fit_stage_all     = 31
+  }; // enum FitStage
+
 } // namespace hig
 
 #endif /* _ENUMS_HPP_ */
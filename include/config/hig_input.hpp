@@ -126,6 +126,7 @@ namespace hig {
 
       bool compute_shape_domain(Shape&, vector3_t&, vector3_t&);
       bool compute_shapedef_minmax(vector3_t&, vector3_t&);
+      bool compute_density_minmax(const char*, vector3_t&, vector3_t&);
 
       /* iterators */
 
@@ -291,6 +292,12 @@ namespace hig {
         return key_list;
       } // fit_param_keys()
 
+      std::string fit_param_string(const std::string& key) const {
+        std::map <std::string, std::string>::const_iterator i = param_key_map_.find(key);
+        if(i == param_key_map_.end()) return "";
+        return (*i).second;
+      } // fit_param_string()
+
       // return list of min-max for all parameters
       std::vector <std::pair <real_t, real_t> > fit_param_limits() const {
         std::vector <std::pair <real_t, real_t> > plimits;
@@ -326,6 +333,11 @@ namespace hig {
 
       std::string reference_data_path(int i) const { return reference_data_[i].image_path(); }
       std::string reference_data_mask(int i) const { return reference_data_[i].image_mask(); }
+      bool reference_data_sparse(int i) const { return reference_data_[i].sparse(); }
+      unsigned int reference_data_levels(int i) const { return reference_data_[i].levels(); }
+      bool reference_data_linecuts(int i, std::vector<unsigned int>& rows,
+                                   std::vector<unsigned int>& cols, unsigned int& width) const {
+        return reference_data_[i].linecuts(rows, cols, width); }
       OutputRegionType reference_region_type(int i) const {
         return reference_data_[i].get_region_type(); }
       real_t reference_region_min_x(int i) const { return reference_data_[i].region_min_x(); }
@@ -74,12 +74,19 @@ namespace hig {
       virtual const std::string& runname() const { }
 
       virtual std::vector<std::string> fit_param_keys() const { }
+      /* the parameter variable name (e.g. shape['s1']:radius:mean) of a fit parameter key */
+      virtual std::string fit_param_string(const std::string& key) const { return ""; }
       virtual std::vector <std::pair <real_t, real_t> > fit_param_limits() const { }
       virtual real_vec_t fit_param_step_values() const { }
       virtual std::vector <real_t> fit_param_init_values() const { }
       virtual real_t param_space_mean(const std::string& key) const { }
       virtual std::string reference_data_path(int i) const { }
       virtual std::string reference_data_mask(int i) const { }
+      virtual bool reference_data_sparse(int i) const { return false; }
+      virtual unsigned int reference_data_levels(int i) const { return 1; }
+      virtual bool reference_data_linecuts(int i, std::vector<unsigned int>& rows,
+                                           std::vector<unsigned int>& cols,
+                                           unsigned int& width) const { return false; }
       virtual int num_fit_params() const { }
       virtual real_t reference_region_min_x(int i) const { }
       virtual real_t reference_region_min_y(int i) const { }
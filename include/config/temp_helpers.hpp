@@ -28,10 +28,17 @@ namespace hig {
       OutputRegionType region_type_;
       real_t x_min_, y_min_;
       real_t x_max_, y_max_;
+      std::vector<unsigned int> row_cuts_;    /* rows of the horizontal line cuts */
+      std::vector<unsigned int> col_cuts_;    /* columns of the vertical line cuts */
+      unsigned int cut_width_;                /* pixels on each side of a cut */
+      bool sparse_;                           /* simulate only the compared pixels */
+      unsigned int levels_;                   /* resolution levels, coarse to fine fitting */
 
     public:
-      FitReferenceData() { }
-      FitReferenceData(std::string p) : image_path_(p) { }
+      FitReferenceData(): x_min_(0), y_min_(0), x_max_(0), y_max_(0),
+                          cut_width_(0), sparse_(false), levels_(1) { }
+      FitReferenceData(std::string p) : image_path_(p), x_min_(0), y_min_(0), x_max_(0), y_max_(0),
+                                        cut_width_(0), sparse_(false), levels_(1) { }
       ~FitReferenceData() { }
 
       bool path(std::string p) { image_path_ = p; return true; }
@@ -41,6 +48,11 @@ namespace hig {
       bool npoints_parallel(unsigned int n) { np_parallel_ = n; return true; }
       bool npoints_perpendicular(unsigned int n) { np_perpendicular_ = n; return true; }
       bool region_type(OutputRegionType r) { region_type_ = r; return true; }
+      bool row_cuts(const std::vector<real_t>& r) { row_cuts_.assign(r.begin(), r.end()); return true; }
+      bool col_cuts(const std::vector<real_t>& c) { col_cuts_.assign(c.begin(), c.end()); return true; }
+      bool cut_width(unsigned int w) { cut_width_ = w; return true; }
+      bool sparse(bool s) { sparse_ = s; return true; }
+      bool levels(unsigned int l) { levels_ = l; return true; }
 
       std::string image_path() const { return image_path_; }
       std::string image_mask() const { return image_mask_; }
@@ -49,6 +61,14 @@ namespace hig {
       real_t region_min_y() const { return y_min_; }
       real_t region_max_x() const { return x_max_; }
       real_t region_max_y() const { return y_max_; }
+      bool sparse() const { return sparse_; }
+      unsigned int levels() const { return levels_; }
+      /* false if there are no line cuts */
+      bool linecuts(std::vector<unsigned int>& rows, std::vector<unsigned int>& cols,
+                    unsigned int& width) const {
+        rows = row_cuts_; cols = col_cuts_; width = cut_width_;
+        return !rows.empty() || !cols.empty();
+      } // linecuts()
 
       void print() {
         std::cout << "Reference Data:" << std::endl;
@@ -36,6 +36,8 @@ namespace hig {
       std::unordered_map <std::string, LatticeType>           LatticeKeyWords_;
       std::unordered_map <std::string, OutputRegionType>      OutputRegionKeyWords_;
       std::unordered_map <std::string, StructCorrelationType> StructCorrelationKeyWords_;
+      std::unordered_map <std::string, TriangleMethodType>    TriangleMethodKeyWords_;
+      std::unordered_map <std::string, OutputFormatType>      OutputFormatKeyWords_;
       std::unordered_map <std::string, FittingAlgorithmName>  FittingAlgorithmKeyWords_;
       std::unordered_map <std::string, FitAlgorithmParamType> FitAlgorithmParamKeyWords_;
       std::unordered_map <std::string, FittingDistanceMetric> FittingDistanceMetricKeyWords_;
@@ -98,6 +100,18 @@ namespace hig {
         else return structcorr_error;
       } // get_structcorr_type()
 
+
+      TriangleMethodType get_triangle_method_type(const std::string& str) {
+        if(TriangleMethodKeyWords_.count(str) > 0) return TriangleMethodKeyWords_[str];
+        else return triangle_method_error;
+      } // get_triangle_method_type()
+
+
+      OutputFormatType get_output_format_type(const std::string& str) {
+        if(OutputFormatKeyWords_.count(str) > 0) return OutputFormatKeyWords_[str];
+        else return output_format_error;
+      } // get_output_format_type()
+
       
       bool key_exists(const std::string& str) {
         if(KeyWords_.count(str) > 0 ||
@@ -174,9 +188,12 @@ namespace hig {
         KeyWords_[std::string("c")]               = struct_grain_lattice_c_token;
         KeyWords_[std::string("caratio")]         = struct_grain_lattice_caratio_token;
         KeyWords_[std::string("coherence")]       = instrument_scatter_coherence_token;
+        KeyWords_[std::string("colcuts")]         = fit_reference_data_colcuts_token;
         KeyWords_[std::string("computation")]     = compute_token;
+        KeyWords_[std::string("cutwidth")]        = fit_reference_data_cutwidth_token;
         KeyWords_[std::string("delta")]           = refindex_delta_token;
         KeyWords_[std::string("detector")]        = instrument_detector_token;
+        KeyWords_[std::string("densitypadding")]  = compute_densitypad_token;
         KeyWords_[std::string("dimensions")]      = struct_dims;
         KeyWords_[std::string("directbeam")]      = instrument_detector_dirbeam_token;
         KeyWords_[std::string("distancemetric")]  = fit_algorithm_distance_metric_token;
@@ -200,6 +217,7 @@ namespace hig {
         KeyWords_[std::string("lattice")]         = struct_grain_lattice_token;
         KeyWords_[std::string("layer")]           = layer_token;
         KeyWords_[std::string("layer:key")]       = struct_grain_lkey_token;
+        KeyWords_[std::string("levels")]          = fit_reference_data_levels_token;
         KeyWords_[std::string("locations")]       = unitcell_element_locations_token;
         KeyWords_[std::string("mask")]            = fit_reference_data_mask_token;
         KeyWords_[std::string("max")]             = max_token;
@@ -218,6 +236,7 @@ namespace hig {
         KeyWords_[std::string("orientations")]    = struct_ensemble_orient_token;
         KeyWords_[std::string("origin")]          = instrument_detector_origin_token;
         KeyWords_[std::string("originvec")]       = shape_originvec_token;
+        KeyWords_[std::string("outputformat")]    = compute_outputformat_token;
         KeyWords_[std::string("outputregion")]    = compute_outregion_token;
         KeyWords_[std::string("p1")]              = shape_param_p1_token;    // mean
         KeyWords_[std::string("p2")]              = shape_param_p2_token;    // std dev
@@ -232,6 +251,7 @@ namespace hig {
         KeyWords_[std::string("photon")]          = instrument_scatter_photon_token;
         KeyWords_[std::string("pixelsize")]       = instrument_detector_pixsize_token;
         KeyWords_[std::string("polarization")]    = instrument_scatter_polarize_token;
+        KeyWords_[std::string("psf")]             = instrument_scatter_psf_token;
         KeyWords_[std::string("pvalue")]          = fit_algorithm_param_value_token;
         KeyWords_[std::string("range")]           = fit_param_range_token;
         KeyWords_[std::string("regmax")]          = fit_reference_data_region_max_token;
@@ -247,6 +267,7 @@ namespace hig {
         KeyWords_[std::string("rot1")]            = struct_ensemble_orient_rot1_token;
         KeyWords_[std::string("rot2")]            = struct_ensemble_orient_rot2_token;
         KeyWords_[std::string("rot3")]            = struct_ensemble_orient_rot3_token;
+        KeyWords_[std::string("rowcuts")]         = fit_reference_data_rowcuts_token;
         KeyWords_[std::string("runname")]         = compute_runname_token;
         KeyWords_[std::string("saveff")]          = compute_saveff_token;
         KeyWords_[std::string("savesf")]          = compute_savesf_token;
@@ -257,6 +278,7 @@ namespace hig {
         KeyWords_[std::string("shape:key")]       = unitcell_element_skey_token;
         KeyWords_[std::string("smearing")]        = instrument_scatter_smearing_token;
         KeyWords_[std::string("spacing")]         = struct_ensemble_spacing_token;
+        KeyWords_[std::string("sparse")]          = fit_reference_data_sparse_token;
         KeyWords_[std::string("spotarea")]        = instrument_scatter_spotarea_token;
         KeyWords_[std::string("stat")]            = stat_token;
         KeyWords_[std::string("stddev")]          = stddev_token;
@@ -268,6 +290,8 @@ namespace hig {
         KeyWords_[std::string("tolerance")]       = fit_algorithm_tolerance_token;
         KeyWords_[std::string("totalpixels")]     = instrument_detector_totpix_token;
         KeyWords_[std::string("transvec")]        = struct_grain_transvec_token;
+        KeyWords_[std::string("trianglemethod")]  = compute_trianglemethod_token;
+        KeyWords_[std::string("triangletolerance")] = compute_triangletol_token;
         KeyWords_[std::string("type")]            = type_token;
         KeyWords_[std::string("unit")]            = instrument_scatter_photon_unit_token;
         KeyWords_[std::string("unitcell")]        = unitcell_token;
@@ -342,6 +366,20 @@ namespace hig {
         StructCorrelationKeyWords_[std::string("GnE")]  = structcorr_GnE;
         StructCorrelationKeyWords_[std::string("GE")]   = structcorr_GE;
 
+        /* triangle integration method keywords */
+
+        TriangleMethodKeyWords_[std::string("approx")]  = triangle_method_approx;
+        TriangleMethodKeyWords_[std::string("exact")]   = triangle_method_exact;
+        TriangleMethodKeyWords_[std::string("auto")]    = triangle_method_auto;
+        TriangleMethodKeyWords_[std::string("tree")]    = triangle_method_tree;
+
+        /* raw data output format keywords */
+
+        OutputFormatKeyWords_[std::string("binary")]    = output_format_binary;
+        OutputFormatKeyWords_[std::string("binary32")]  = output_format_binary32;
+        OutputFormatKeyWords_[std::string("text")]      = output_format_text;
+        OutputFormatKeyWords_[std::string("hdf5")]      = output_format_hdf5;
+
         /* fitting algorithm name keywords */
 
         FittingAlgorithmKeyWords_[std::string("lmvm")]          = algo_lmvm;
@@ -355,6 +393,11 @@ namespace hig {
         // pounders
         FitAlgorithmParamKeyWords_[std::string("pounders_delta")]       = algo_pounders_param_delta;
 
+        // lmvm
+        FitAlgorithmParamKeyWords_[std::string("lmvm_num_threads")]     = algo_lmvm_param_nthread;
+        FitAlgorithmParamKeyWords_[std::string("lmvm_sim_threads")]     = algo_lmvm_param_sim_nthread;
+        FitAlgorithmParamKeyWords_[std::string("lmvm_one_sided")]       = algo_lmvm_param_one_sided;
+
         // pso
         FitAlgorithmParamKeyWords_[std::string("pso_omega")]            = algo_pso_param_omega;
         FitAlgorithmParamKeyWords_[std::string("pso_phi1")]             = algo_pso_param_phi1;
@@ -363,6 +406,8 @@ namespace hig {
         FitAlgorithmParamKeyWords_[std::string("pso_num_generations")]  = algo_pso_param_ngen;
         FitAlgorithmParamKeyWords_[std::string("pso_tune_omega")]       = algo_pso_param_tune_omega;
         FitAlgorithmParamKeyWords_[std::string("pso_type")]             = algo_pso_param_type;
+        FitAlgorithmParamKeyWords_[std::string("pso_num_threads")]      = algo_pso_param_nthread;
+        FitAlgorithmParamKeyWords_[std::string("pso_sim_threads")]      = algo_pso_param_sim_nthread;
 
         /* fitting distance metric keywords */
 
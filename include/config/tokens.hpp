@@ -168,6 +168,10 @@ namespace hig {
     compute_structcorr_token,      /* defined grain/ensemble correlations */
     compute_saveff_token,
     compute_savesf_token,
+    compute_trianglemethod_token,  /* integration method for triangulated shapes */
+    compute_triangletol_token,     /* tolerance on |q| * size for approximating triangles */
+    compute_densitypad_token,      /* padding factor of the fft of density grid shapes */
+    compute_outputformat_token,    /* format of the raw data output files */
 
     /* experiment instrumentation - scatter and detector */
     instrument_token,
@@ -183,6 +187,7 @@ namespace hig {
     instrument_scatter_coherence_token,
     instrument_scatter_spotarea_token,
     instrument_scatter_smearing_token,
+    instrument_scatter_psf_token,
     instrument_detector_token,
     instrument_detector_origin_token,
     instrument_detector_totpix_token,
@@ -205,6 +210,11 @@ namespace hig {
     fit_reference_data_npoints_token,
     fit_reference_data_npoints_parallel_token,
     fit_reference_data_npoints_perpendicular_token,
+    fit_reference_data_rowcuts_token,
+    fit_reference_data_colcuts_token,
+    fit_reference_data_cutwidth_token,
+    fit_reference_data_sparse_token,
+    fit_reference_data_levels_token,
     fit_algorithm_token,
     fit_algorithm_distance_metric_token,
     fit_algorithm_name_token,
@@ -0,0 +1,174 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: ff_ana_tile.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __FF_ANA_TILE_HPP__
+#define __FF_ANA_TILE_HPP__
+
+#include <cmath>
+#include <vector>
+
+#include <common/typedefs.hpp>
+#include <common/cpu/parameters_cpu.hpp>
+#include <numerics/matrix.hpp>
+
+namespace hig {
+
+  /**
+   * Tiles of q-points for the vectorized analytic form factor kernels on cpu. A thread
+   * rotates the q-points of a tile once into split real and imaginary arrays, and the
+   * kernels evaluate the shape functions over them in simd lanes. The complex functions are
+   * built from the real cos, sin and exp of the lanes (ana_trig), each in its own loop, so
+   * that they are vectorized (with a vector math library) and not fused into a scalar sincos.
+   */
+  typedef struct {
+    real_t qr[3][CPU_ANA_TILE_Q_];    /* rotated q-points, real parts */
+    real_t qi[3][CPU_ANA_TILE_Q_];    /* and imaginary parts */
+    real_t ff_r[CPU_ANA_TILE_Q_];     /* form factor of the tile */
+    real_t ff_i[CPU_ANA_TILE_Q_];
+    real_t ar[CPU_ANA_TILE_Q_];       /* argument of ana_trig() */
+    real_t ai[CPU_ANA_TILE_Q_];
+    real_t c[CPU_ANA_TILE_Q_];        /* cos ar, sin ar, exp ai */
+    real_t s[CPU_ANA_TILE_Q_];
+    real_t e[CPU_ANA_TILE_Q_];
+    real_t acc[8][CPU_ANA_TILE_Q_];   /* partial sums and lane constants of the kernels */
+  } ana_tile_t;
+
+  /* below this |a|^2 the series of sinc a (and the like) are used */
+  const real_t ANA_SERIES_LIMIT_ = 1e-6;
+
+  /* rotate the q-points q0 .. q0 + nq - 1 of the grid into the tile, and clear its ff */
+  template <typename Grid>
+  static inline void load_ana_tile(ana_tile_t& tile, unsigned int q0, unsigned int nq,
+                                   unsigned int nqy, const Grid& qgrid, const RotMatrix_t& rot) {
+    for(unsigned int l = 0; l < nq; ++ l) {
+      unsigned int i_z = q0 + l, i_y = i_z % nqy;
+      complex_t mq[3];
+      rot.rotate(qgrid.qx(i_y), qgrid.qy(i_y), qgrid.qz_extended(i_z), mq[0], mq[1], mq[2]);
+      for(int d = 0; d < 3; ++ d) { tile.qr[d][l] = mq[d].real(); tile.qi[d][l] = mq[d].imag(); }
+      tile.ff_r[l] = 0.; tile.ff_i[l] = 0.;
+    } // for
+  } // load_ana_tile()
+
+  /* set the argument a = scale * q_d of ana_trig() */
+  static inline void ana_arg(ana_tile_t& tile, int d, real_t scale, unsigned int nq) {
+    const real_t *qr = tile.qr[d], *qi = tile.qi[d];
+    real_t *ar = tile.ar, *ai = tile.ai;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) { ar[l] = scale * qr[l]; ai[l] = scale * qi[l]; }
+  } // ana_arg()
+
+  /**
+   * cos ar, sin ar and exp ai of the argument a. with em = 1 / e, the complex functions are
+   *   sin a = s (e + em) / 2 + i c (e - em) / 2,  cos a = c (e + em) / 2 - i s (e - em) / 2,
+   *   exp(i a) = em (c + i s),  exp(-i a) = e (c - i s)
+   */
+  static inline void ana_trig(ana_tile_t& tile, unsigned int nq) {
+    const real_t *ar = tile.ar, *ai = tile.ai;
+    real_t *c = tile.c, *s = tile.s, *e = tile.e;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) c[l] = std::cos(ar[l]);
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) s[l] = std::sin(ar[l]);
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) e[l] = std::exp(ai[l]);
+  } // ana_trig()
+
+  /* sinc a = sin a / a of one lane from its cos ar, sin ar and exp ai, 1 - a^2 / 6 near 0 */
+  static inline void ana_sinc_lane(real_t ar, real_t ai, real_t c, real_t s, real_t e,
+                                   real_t& re, real_t& im) {
+    real_t em = 1. / e;
+    real_t sr = s * (e + em) * 0.5, si = c * (e - em) * 0.5;
+    real_t a2 = ar * ar + ai * ai;
+    bool series = a2 < ANA_SERIES_LIMIT_;
+    real_t d = series ? 1. : 1. / a2;
+    // sin a conj(a) / |a|^2
+    real_t fr = (sr * ar + si * ai) * d, fi = (si * ar - sr * ai) * d;
+    re = series ? 1. - (ar * ar - ai * ai) / 6. : fr;
+    im = series ? - ar * ai / 3. : fi;
+  } // ana_sinc_lane()
+
+  /* sinc a of the argument of the last ana_trig() */
+  static inline void ana_sinc(const ana_tile_t& tile, real_t* re, real_t* im, unsigned int nq) {
+    const real_t *ar = tile.ar, *ai = tile.ai, *c = tile.c, *s = tile.s, *e = tile.e;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l)
+      ana_sinc_lane(ar[l], ai[l], c[l], s[l], e[l], re[l], im[l]);
+  } // ana_sinc()
+
+  /* exp(i a) sinc a of the argument of the last ana_trig() */
+  static inline void ana_expi_sinc(const ana_tile_t& tile, real_t* re, real_t* im,
+                                   unsigned int nq) {
+    const real_t *ar = tile.ar, *ai = tile.ai, *c = tile.c, *s = tile.s, *e = tile.e;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      real_t fr, fi;
+      ana_sinc_lane(ar[l], ai[l], c[l], s[l], e[l], fr, fi);
+      // exp(i a) = (c + i s) / e
+      real_t xr = c[l] / e[l], xi = s[l] / e[l];
+      re[l] = xr * fr - xi * fi;
+      im[l] = xr * fi + xi * fr;
+    } // for
+  } // ana_expi_sinc()
+
+  /* sum of w_i size_i sinc(size_i q_d / 2) over the sizes, with expi also times the
+   * exp(i size_i q_d / 2) */
+  static inline void ana_sinc_sum(ana_tile_t& tile, int d, const std::vector<real_t>& size,
+                                  const std::vector<real_t>& w, bool expi,
+                                  real_t* sum_r, real_t* sum_i, unsigned int nq) {
+    real_t *re = tile.acc[6], *im = tile.acc[7];
+    for(unsigned int l = 0; l < nq; ++ l) { sum_r[l] = 0.; sum_i[l] = 0.; }
+    for(unsigned int i = 0; i < size.size(); ++ i) {
+      real_t f = w[i] * size[i];
+      ana_arg(tile, d, 0.5 * size[i], nq);
+      ana_trig(tile, nq);
+      if(expi) ana_expi_sinc(tile, re, im, nq);
+      else ana_sinc(tile, re, im, nq);
+      #pragma omp simd
+      for(unsigned int l = 0; l < nq; ++ l) { sum_r[l] += f * re[l]; sum_i[l] += f * im[l]; }
+    } // for
+  } // ana_sinc_sum()
+
+  /* ff *= exp(i q.t), nothing to do when there is no translation */
+  static inline void ana_translate(ana_tile_t& tile, const vector3_t& t, unsigned int nq) {
+    if(t[0] == 0 && t[1] == 0 && t[2] == 0) return;
+    real_t *ar = tile.ar, *ai = tile.ai;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      ar[l] = tile.qr[0][l] * t[0] + tile.qr[1][l] * t[1] + tile.qr[2][l] * t[2];
+      ai[l] = tile.qi[0][l] * t[0] + tile.qi[1][l] * t[1] + tile.qi[2][l] * t[2];
+    } // for
+    ana_trig(tile, nq);
+    const real_t *c = tile.c, *s = tile.s, *e = tile.e;
+    real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      real_t em = 1. / e[l];
+      real_t xr = em * c[l], xi = em * s[l];
+      real_t fr = ff_r[l] * xr - ff_i[l] * xi, fi = ff_r[l] * xi + ff_i[l] * xr;
+      ff_r[l] = fr; ff_i[l] = fi;
+    } // for
+  } // ana_translate()
+
+  /* apply the translation and write the form factor of the tile to ff[q0 ..] */
+  static inline void store_ana_tile(ana_tile_t& tile, const vector3_t& t, unsigned int q0,
+                                    unsigned int nq, std::vector<complex_t>& ff) {
+    ana_translate(tile, t, nq);
+    for(unsigned int l = 0; l < nq; ++ l) ff[q0 + l] = complex_t(tile.ff_r[l], tile.ff_i[l]);
+  } // store_ana_tile()
+
+} // namespace hig
+
+#endif // __FF_ANA_TILE_HPP__
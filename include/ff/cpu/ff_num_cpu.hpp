@@ -20,6 +20,8 @@
 #include <common/typedefs.hpp>
 #include <common/globals.hpp>
 #include <numerics/matrix.hpp>	
+#include <ff/triangle_table.hpp>
+#include <ff/triangle_tree.hpp>
 
 namespace hig {
 	
@@ -34,12 +36,22 @@ namespace hig {
 
 			bool init();	// TODO ...
 	
-            unsigned int compute_exact_triangle(triangle_t *, int,
+            unsigned int compute_exact_triangle(const TriangleTable &,
                     complex_t *&, 
                     int, real_t *, real_t *, int, complex_t *,
                     RotMatrix_t &, real_t &);
 
-            unsigned int compute_approx_triangle(real_vec_t &,
+            unsigned int compute_auto_triangle(const TriangleTable &, real_t,
+                    complex_t *&,
+                    int, real_t *, real_t *, int, complex_t *,
+                    RotMatrix_t &, real_t &, real_t &, real_t &);
+
+            unsigned int compute_tree_triangle(const TriangleTree &, const TriangleTable &,
+                    real_t, complex_t *&,
+                    int, real_t *, real_t *, int, complex_t *,
+                    RotMatrix_t &, real_t &, real_t &, real_t &);
+
+            unsigned int compute_approx_triangle(const real_vec_t &,
                     complex_t *&,
                     int, real_t *, real_t *,
                     int, complex_t *, RotMatrix_t &, real_t &); 
@@ -0,0 +1,68 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: density_grid.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __DENSITY_GRID_HPP__
+#define __DENSITY_GRID_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * Form factor of a shape given as a real-space density grid of box shaped voxels, centered
+   * at the origin. The voxel sum
+   *    C(q) = V sum_j rho_j exp(-i dot(q, r_j))
+   * is sampled once with a zero-padded 3-D FFT, on a q-grid of spacing 2 pi / (m d) along
+   * each dimension, for m padded grid points of size d. Form factors at arbitrary (rotated)
+   * q-points are then tri-cubically interpolated from these samples, and multiplied with
+   * the form factor of a voxel, prod_a d_a sinc(q_a d_a / 2) / d_a. C is periodic up to a sign
+   * with period 2 pi / d, so that q-points beyond the sampled range are folded back.
+   * The (small) imaginary parts of the q-points are accounted for to first order, through
+   * the interpolated gradient of C.
+   */
+  class DensityGrid {
+    private:
+      unsigned int n_[3];               /* grid size */
+      unsigned int m_[3];               /* padded transform size */
+      real_t voxel_[3];                 /* voxel size */
+      real_t dq_[3];                    /* sample spacing in q */
+      std::vector<complex_t> samples_;  /* C at k dq, k in [-m/2, m/2), stored at k mod m */
+
+    public:
+      DensityGrid() { n_[0] = n_[1] = n_[2] = 0; m_[0] = m_[1] = m_[2] = 0; }
+      ~DensityGrid() { }
+
+      /* transform the given densities of an n[0] x n[1] x n[2] grid (x varying fastest),
+       * each dimension padded by at least the given factor */
+      bool build(const real_t*, const unsigned int*, const real_t*, unsigned int = 2);
+      void clear() { samples_.clear(); n_[0] = n_[1] = n_[2] = 0; m_[0] = m_[1] = m_[2] = 0; }
+      bool empty() const { return samples_.empty(); }
+
+      unsigned int size(int d) const { return n_[d]; }
+      unsigned int padded_size(int d) const { return m_[d]; }
+      real_t voxel(int d) const { return voxel_[d]; }
+      real_t extent(int d) const { return n_[d] * voxel_[d]; }
+
+      /* form factor at the given q-point, in the frame of the grid */
+      complex_t form_factor(const complex_t*) const;
+
+  }; // class DensityGrid
+
+} // namespace hig
+
+#endif // __DENSITY_GRID_HPP__
@@ -24,6 +24,7 @@
 #endif
 
 #include <common/typedefs.hpp>
+#include <common/enums.hpp>
 #include <numerics/matrix.hpp>
 #include <ff/ff_ana.hpp>
 #include <ff/ff_num.hpp>
@@ -67,7 +68,7 @@ namespace hig {
                   shape_param_list_t& params,
                   real_t single_thickness,
                   vector3_t& transvec, real_t shp_tau, real_t shp_eta,
-                  RotMatrix_t &
+                  RotMatrix_t &, const QGridView&
                   #ifdef USE_MPI
                     , woo::MultiNode&, std::string
                   #endif
@@ -79,7 +80,7 @@ namespace hig {
       bool read_form_factor(const char* filename,
                   unsigned int nqx, unsigned int nqy, unsigned int nqz);
       void print_ff(unsigned int nqx, unsigned int nqy, unsigned int nqz);
-      void save_ff(unsigned int nqz, const char* filename);
+      void save_ff(unsigned int nqz, const char* filename, OutputFormatType format = output_format_text);
       void save (unsigned, unsigned, const char *);
       void printff(unsigned int nqx, unsigned int nqy, unsigned int nqz) {
         std::cout << "ff:" << std::endl;
@@ -89,6 +90,13 @@ namespace hig {
       } // printff()
 
       complex_t* ff(void) { return &ff_[0]; }
+
+      // integration method for numerical (triangulated) shapes
+      void triangle_method(TriangleMethodType m, real_t tol) { numeric_ff_.triangle_method(m, tol); }
+      void density_padding(unsigned int p) { numeric_ff_.density_padding(p); }
+
+      // hand over the computed form factor data (leaves this object empty)
+      void swap_ff(std::vector<complex_t>& v) { ff_.swap(v); }
   }; // class FormFactor
 
 } // namespace
@@ -28,6 +28,7 @@
 #include <common/globals.hpp>
 #include <common/enums.hpp>
 #include <model/shape.hpp>
+#include <model/qgrid.hpp>
 
 #include <numerics/matrix.hpp>
 
@@ -42,6 +43,7 @@ namespace hig {
       unsigned int nqx_;
       unsigned int nqy_;
       unsigned int nqz_;
+      QGridView qgrid_;     /* q-grid of the current computation */
       RotMatrix_t rot_;
       
 
@@ -53,7 +55,7 @@ namespace hig {
       AnalyticFormFactor() { }
       ~AnalyticFormFactor() { }
 
-      bool init(RotMatrix_t &, std::vector<complex_t> &);
+      bool init(RotMatrix_t &, std::vector<complex_t> &, const QGridView&);
       void clear();
 
       bool compute(ShapeName , real_t , real_t , vector3_t ,
@@ -107,6 +109,13 @@ namespace hig {
       void compute_meshpoints(const real_t, const real_t, const complex_t, const real_t*,
               complex_t&, complex_t&, complex_t&);
 
+      /* exp(i mq.t) for a rotated q-point mq; unity (no exp) when there is no translation */
+      static inline complex_t translation_phase(const complex_t* mq, const vector3_t& t) {
+        if(t[0] == 0 && t[1] == 0 && t[2] == 0) return complex_t(1.0, 0.0);
+        complex_t temp = mq[0] * t[0] + mq[1] * t[1] + mq[2] * t[2];
+        return std::exp(complex_t(-temp.imag(), temp.real()));
+      } // translation_phase()
+
   }; // class AnalyticFormFactor
 
 } // namespace hig
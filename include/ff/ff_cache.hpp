@@ -0,0 +1,81 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: ff_cache.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __FF_CACHE_HPP__
+#define __FF_CACHE_HPP__
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <common/typedefs.hpp>
+#include <common/globals.hpp>
+#include <common/enums.hpp>
+#include <model/shape.hpp>
+#include <model/qgrid.hpp>
+#include <numerics/matrix.hpp>
+
+namespace hig {
+
+  /**
+   * Cache of untranslated form factors. A translated copy of a shape differs from the
+   * untranslated one only by the phase exp(i q.t), so for a given shape, parameter set
+   * and rotation the form factor is computed once and each location is then added with
+   * a phase multiply-accumulate. The cached data depends on the current q-grid (including
+   * qz_extended), hence the cache must be cleared whenever the q-grid changes.
+   */
+  class FormFactorCache {
+    public:
+      typedef std::vector<complex_t> ff_vec_t;
+
+    private:
+      typedef std::map<std::string, ff_vec_t> cache_t;
+
+      cache_t cache_;             /* key -> untranslated form factor */
+      unsigned int max_entries_;  /* bound on the number of stored form factors */
+      unsigned int hits_;
+      unsigned int misses_;
+
+    public:
+      FormFactorCache(unsigned int max_entries = 16):
+        max_entries_(max_entries), hits_(0), misses_(0) { }
+      ~FormFactorCache() { }
+
+      void clear() { cache_.clear(); hits_ = 0; misses_ = 0; }
+
+      /* construct the key identifying a shape, its parameters and rotation */
+      static std::string key(const std::string&, ShapeName, const std::string&,
+                             const shape_param_list_t&, const RotMatrix_t&);
+
+      /* returns NULL when not present */
+      const ff_vec_t* find(const std::string&);
+
+      /* takes over the contents of the given vector, returns the stored form factor */
+      const ff_vec_t* insert(const std::string&, ff_vec_t&);
+
+      /* ff[i] += dn2 * ff0[i] * exp(i (rot q_i) . transvec), for i < sz */
+      static bool accumulate(const ff_vec_t&, complex_t, const vector3_t&, const RotMatrix_t&,
+                             bool, unsigned int, const QGridView&, std::vector<complex_t>&);
+
+      unsigned int size() const { return cache_.size(); }
+      unsigned int hits() const { return hits_; }
+      unsigned int misses() const { return misses_; }
+
+  }; // class FormFactorCache
+
+} // namespace hig
+
+#endif // __FF_CACHE_HPP__
@@ -45,6 +45,7 @@
 #endif // FF_NUM_GPU
 
 #include <numerics/matrix.hpp>
+#include <ff/shape_mesh_store.hpp>
 
 #include <woo/timer/woo_boostchronotimers.hpp>
 
@@ -71,27 +72,36 @@ namespace hig {
           NumericFormFactor(int block_cuda_y, int block_cuda_z):
                   block_cuda_t_(0),
                   block_cuda_y_(block_cuda_y), block_cuda_z_(block_cuda_z),
-                  gff_(block_cuda_y, block_cuda_z) { }
+                  gff_(block_cuda_y, block_cuda_z), method_(triangle_method_approx), tol_(0.1), density_pad_(2) { }
         #endif
         #ifdef KERNEL2
           NumericFormFactor(int block_cuda_t, int block_cuda_y, int block_cuda_z):
                   block_cuda_t_(block_cuda_t), block_cuda_y_(block_cuda_y),
                   block_cuda_z_(block_cuda_z),
-                  gff_(block_cuda_t, block_cuda_y, block_cuda_z) { }
+                  gff_(block_cuda_t, block_cuda_y, block_cuda_z),
+                  method_(triangle_method_approx), tol_(0.1), density_pad_(2) { }
         #else
-          NumericFormFactor(int block_cuda): block_cuda_(block_cuda), gff_(block_cuda) { }
+          NumericFormFactor(int block_cuda): block_cuda_(block_cuda), gff_(block_cuda),
+                  method_(triangle_method_approx), tol_(0.1), density_pad_(2) { }
         #endif // KERNEL2
       #elif defined USE_MIC  // use MICs for numerical
-        NumericFormFactor(): mff_() { }
+        NumericFormFactor(): mff_(), method_(triangle_method_approx), tol_(0.1), density_pad_(2) { }
       #else          // use CPUs for numerical
-        NumericFormFactor(): cff_() { }
+        NumericFormFactor(): cff_(), method_(triangle_method_approx), tol_(0.1), density_pad_(2) { }
       #endif  // FF_NUM_GPU
 
       ~NumericFormFactor() { }
 
-      bool init(RotMatrix_t &, std::vector<complex_t>&);
+      bool init(RotMatrix_t &, std::vector<complex_t>&, const QGridView&);
       void clear() { }        // TODO ...
 
+      /* integration method used for triangulated shapes, and the tolerance on |q| times
+       * the triangle radius below which the automatic method approximates */
+      void triangle_method(TriangleMethodType m, real_t tol) { method_ = m; tol_ = tol; }
+      TriangleMethodType triangle_method() const { return method_; }
+      /* padding factor of the transforms of density grid shapes */
+      void density_padding(unsigned int p) { density_pad_ = p; }
+
       bool compute(const char* filename, std::vector<complex_t>& ff,
               RotMatrix_t &
               #ifdef USE_MPI
@@ -105,6 +115,14 @@ namespace hig {
                 , woo::MultiNode&, std::string
               #endif
               );
+
+      /* form factor of a density grid shape, interpolated from its transform */
+      bool compute_density(const char* filename, std::vector<complex_t>& ff,
+              RotMatrix_t &
+              #ifdef USE_MPI
+                , woo::MultiNode&, std::string
+              #endif
+              );
     private:
 
       // TODO: make these for gpu only ...
@@ -122,13 +140,38 @@ namespace hig {
         NumericFormFactorC cff_;    // for computation only on CPU
       #endif
 
+      TriangleMethodType method_;   /* exact or approximated integration over triangles */
+      real_t tol_;                  /* tolerance of the automatic method */
+      unsigned int density_pad_;    /* padding factor of density grid transforms */
+
       unsigned int nqx_;
       unsigned int nqy_;
       unsigned int nqz_;
 
+      QGridView qgrid_;     /* q-grid of the current computation */
       RotMatrix_t rot_;
   
       ShapeFileType get_shapes_file_format(const char*);
+      /* get the parsed shape file from the mesh store, loading (and broadcasting) if needed */
+      const ShapeMeshStore::shape_def_entry_t* load_shape_def(const char*
+                    #ifdef USE_MPI
+                      , woo::MultiNode&, std::string
+                    #endif
+                    );
+      const ShapeMeshStore::triangles_entry_t* load_triangles(const char*
+                    #ifdef USE_MPI
+                      , woo::MultiNode&, std::string
+                    #endif
+                    );
+      bool read_triangles(const char*, std::vector<triangle_t>&);
+      /* density grid shapes: raw binary (.vox), or hdf5 files with a density dataset */
+      bool is_density_file(const char*);
+      bool read_density(const char*, std::vector<real_t>&, unsigned int*, real_t*);
+      const ShapeMeshStore::density_entry_t* load_density(const char*
+                    #ifdef USE_MPI
+                      , woo::MultiNode&, std::string
+                    #endif
+                    );
       unsigned int read_shapes_file_dat(const char* filename, real_vec_t& shape_def);
       unsigned int read_shapes_file(const char* filename,
 //                    #ifndef __SSE3__
@@ -47,12 +47,12 @@ namespace hig {
       ~NumericFormFactorG() {}
 
       /* Spherical Q_grid */
-      unsigned int compute_exact_triangle(triangle_t *, int, 
+      unsigned int compute_exact_triangle(const triangle_t *, int, 
               cucomplex_t * &, 
               int, real_t *, real_t *, int,
               cucomplex_t *, RotMatrix_t &, real_t &);
 
-      unsigned int compute_approx_triangle(std::vector<real_t> &, 
+      unsigned int compute_approx_triangle(const std::vector<real_t> &, 
               cucomplex_t * &,
               int, real_t *, real_t *, int, 
               cucomplex_t *, RotMatrix_t &, real_t &);
@@ -0,0 +1,116 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: shape_mesh_store.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+
+#ifndef __SHAPE_MESH_STORE_HPP__
+#define __SHAPE_MESH_STORE_HPP__
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <ctime>
+
+#include <common/typedefs.hpp>
+#include <ff/triangle_table.hpp>
+#include <ff/triangle_tree.hpp>
+#include <ff/density_grid.hpp>
+
+namespace hig {
+
+  /**
+   * Process-wide store of parsed shape definition files, keyed by the file path and its
+   * modification time. Entries hold the triangle data in the layout consumed directly by
+   * the numeric form factor kernels, and are never modified or removed once inserted (a
+   * changed file gets a new entry next to the old one), so the returned pointers remain
+   * valid across grains and fitting iterations, until clear().
+   * The store grows by one entry per version of each file used: it is meant for the few
+   * shape files of a run, and clear() releases everything once no entry is in use.
+   * All the functions may be called concurrently, from any thread.
+   */
+  class ShapeMeshStore {
+    public:
+      /* packed triangle properties, as used by compute_approx_triangle */
+      typedef struct {
+        std::time_t mtime_;
+        unsigned int num_triangles_;
+        real_vec_t shape_def_;
+      } shape_def_entry_t;
+
+      /* triangle vertices, in the order of the leaves of their octree, and their
+       * descriptors as used by compute_exact_triangle */
+      typedef struct {
+        std::time_t mtime_;
+        std::vector<triangle_t> triangles_;
+        TriangleTree tree_;
+        TriangleTable table_;
+      } triangles_entry_t;
+
+      /* transformed density grid, as used by compute_density */
+      typedef struct {
+        std::time_t mtime_;
+        unsigned int padding_;
+        DensityGrid grid_;
+      } density_entry_t;
+
+    private:
+      /* file path and modification time, the density grids also by their padding */
+      typedef std::pair<std::string, std::time_t> version_t;
+      typedef std::pair<version_t, unsigned int> density_key_t;
+
+      std::map<version_t, shape_def_entry_t> shape_defs_;
+      std::map<version_t, triangles_entry_t> triangles_;
+      std::map<density_key_t, density_entry_t> densities_;
+
+      /* singleton */
+      ShapeMeshStore() { }
+      ShapeMeshStore(const ShapeMeshStore&);
+      ShapeMeshStore& operator=(const ShapeMeshStore&);
+
+    public:
+      static ShapeMeshStore& instance() {
+        static ShapeMeshStore store;
+        return store;
+      } // instance()
+
+      /* modification time of the given file, returns false if it can not be accessed */
+      static bool mtime(const std::string&, std::time_t&);
+
+      /* return NULL when no entry of this version of the file is present */
+      const shape_def_entry_t* find_shape_def(const std::string&, std::time_t) const;
+      const triangles_entry_t* find_triangles(const std::string&, std::time_t) const;
+      /* also NULL when the stored grid was transformed with a different padding */
+      const density_entry_t* find_density(const std::string&, std::time_t, unsigned int) const;
+
+      /* take over the contents of the given data as the entry of this version of the file.
+       * an existing entry of the same version is returned unchanged */
+      const shape_def_entry_t* insert_shape_def(const std::string&, std::time_t,
+                                                unsigned int, real_vec_t&);
+      const triangles_entry_t* insert_triangles(const std::string&, std::time_t,
+                                                std::vector<triangle_t>&);
+      /* transform the given n[0] x n[1] x n[2] densities, with the given voxel size and padding */
+      const density_entry_t* insert_density(const std::string&, std::time_t,
+                                            const std::vector<real_t>&, const unsigned int*,
+                                            const real_t*, unsigned int);
+
+      /* invalidates all the entries handed out */
+      void clear();
+
+  }; // class ShapeMeshStore
+
+} // namespace hig
+
+#endif // __SHAPE_MESH_STORE_HPP__
@@ -0,0 +1,93 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: triangle_table.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __TRIANGLE_TABLE_HPP__
+#define __TRIANGLE_TABLE_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * Descriptors of the triangles of a mesh, for the exact triangle form factor. All the
+   * q-independent geometry (vertices, unit face and edge normals, unit edge directions,
+   * edge lengths and areas) is computed once, and stored as a structure of arrays: one
+   * 64-byte aligned array per field, each padded to a multiple of 8 entries.
+   * For the selection between exact and centroid approximated integration, the table also
+   * keeps the centroid and the radius (largest centroid to vertex distance) of each
+   * triangle, and the largest radius within each cluster of cluster_size_ consecutive
+   * triangles.
+   */
+  class TriangleTable {
+    public:
+      /* fields, the per-vertex and per-edge ones are indexed as FIELD + 3 * i + dim */
+      enum {
+        vertex_ = 0,        /* vertices v_i, in counter-clockwise order */
+        normal_ = 9,        /* unit face normal */
+        edge_normal_ = 12,  /* unit normal of edge e (v_e -> v_e+1), in the face plane */
+        edge_dir_ = 21,     /* unit direction of edge e */
+        edge_len_ = 30,     /* length of edge e, indexed as edge_len_ + e */
+        area_ = 33,
+        centroid_ = 34,
+        radius_ = 37,
+        num_fields_ = 38
+      };
+
+      enum { cluster_size_ = 32 };
+
+      /* case classification hints */
+      enum {
+        tri_regular_ = 0,
+        tri_degenerate_ = 1 /* zero area, contributes nothing */
+      };
+
+    private:
+      unsigned int num_triangles_;
+      unsigned int stride_;           /* padded length of each field */
+      real_t* data_;                  /* num_fields_ * stride_ reals */
+      std::vector<unsigned char> flags_;
+      std::vector<real_t> cluster_radius_;
+
+      bool allocate(unsigned int);
+      void release();
+
+    public:
+      TriangleTable(): num_triangles_(0), stride_(0), data_(NULL) { }
+      TriangleTable(const TriangleTable&);
+      TriangleTable& operator=(const TriangleTable&);
+      ~TriangleTable() { release(); }
+
+      /* compute the descriptors of the given triangles */
+      bool build(const triangle_t*, unsigned int);
+      void clear() { release(); }
+
+      unsigned int size() const { return num_triangles_; }
+      unsigned int stride() const { return stride_; }
+      bool empty() const { return num_triangles_ == 0; }
+
+      const real_t* field(int f) const { return data_ + (size_t) f * stride_; }
+      const unsigned char* flags() const { return flags_.empty() ? NULL : &flags_[0]; }
+
+      unsigned int num_clusters() const { return cluster_radius_.size(); }
+      real_t cluster_radius(unsigned int c) const { return cluster_radius_[c]; }
+
+  }; // class TriangleTable
+
+} // namespace hig
+
+#endif // __TRIANGLE_TABLE_HPP__
@@ -0,0 +1,79 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: triangle_tree.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __TRIANGLE_TREE_HPP__
+#define __TRIANGLE_TREE_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * Octree over the triangle centroids of a mesh, for the hierarchical (treecode) evaluation
+   * of its form factor. The form factor of a closed mesh is, by the divergence theorem,
+   *    F(q) = i / q^2 sum_t dot(q, n_t) int_t exp(-i dot(q, r)) dS,
+   * and the contribution of a cluster of triangles around its center C is expanded as
+   *    exp(-i dot(q, C)) [ q_a M0_a - i q_a q_b M1_ab - q_a q_b q_c M2_abc / 2 ],
+   * with the surface moments
+   *    M0_a = sum_t n_a A_t,  M1_ab = sum_t n_a int_t d_b,  M2_abc = sum_t n_a int_t d_b d_c,
+   * where d = r - C. The truncation error is bounded by A |q|^2 R^3 exp(|q| R) / 6 times
+   * |exp(-i dot(q, C))|, for a cluster of total area A and radius R.
+   * Building the tree reorders the triangles, so that each node covers a contiguous range.
+   */
+  class TriangleTree {
+    public:
+      typedef struct {
+        real_t center_[3];
+        real_t radius_;           /* largest distance of a vertex from the center */
+        real_t area_;             /* total area */
+        real_t m0_[3];            /* surface moments, see above */
+        real_t m1_[9];            /* [a][b] */
+        real_t m2_[18];           /* [a][bc], bc = xx, xy, xz, yy, yz, zz */
+        unsigned int begin_;      /* range of triangles */
+        unsigned int end_;
+        int first_child_;         /* children are consecutive, -1 for leaves */
+        int num_children_;
+      } node_t;
+
+    private:
+      std::vector<node_t> nodes_;     /* root is the first node */
+      unsigned int depth_;
+
+      void split(unsigned int, std::vector<triangle_t>&, std::vector<real_t>&,
+                 unsigned int, unsigned int);
+      void moments(node_t&, const std::vector<triangle_t>&) const;
+
+    public:
+      TriangleTree(): depth_(0) { }
+      ~TriangleTree() { }
+
+      /* build the tree, reordering the given triangles. leaves hold at most the given
+       * number of triangles */
+      bool build(std::vector<triangle_t>&, unsigned int = 32);
+      void clear() { nodes_.clear(); depth_ = 0; }
+
+      bool empty() const { return nodes_.empty(); }
+      unsigned int size() const { return nodes_.size(); }
+      unsigned int depth() const { return depth_; }
+      const node_t& node(unsigned int i) const { return nodes_[i]; }
+
+  }; // class TriangleTree
+
+} // namespace hig
+
+#endif // __TRIANGLE_TREE_HPP__
@@ -19,7 +19,9 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
 #include <map>
+#include <limits>
 
 #include <common/typedefs.hpp>
 
@@ -27,32 +29,73 @@ namespace hig {
 
   const size_t EDF_CHUNK_SIZE = 512;
 
+  /* value types of EDF payloads */
+  enum EDFDataType {
+    edf_type_error,
+    edf_type_int8, edf_type_uint8,
+    edf_type_int16, edf_type_uint16,
+    edf_type_int32, edf_type_uint32,
+    edf_type_float32, edf_type_float64
+  }; // enum EDFDataType
+
+
+  /**
+   * Reader of (multi-frame) EDF files. The file is memory mapped and each header is parsed
+   * once; the payloads are not read until used. Frames whose type and byte order match the
+   * host are accessed in place, others are converted on access.
+   */
   class EDFReader {
     public:
       EDFReader(const char*);
-      ~EDFReader() { }
-
-      bool get_data(real_t *&, unsigned int&, unsigned int&);
-
-    private:
-      bool is_white_space(char);
-      bool get_next_item(char*, int&, const int, char*, int&, bool&, char*, int&, bool&);
-      bool header_done(char*, const int, const int);
-      bool extract_header(std::ifstream&, char*, size_t);
-      bool extract_data(std::ifstream&, char*, size_t);
-      unsigned int convert_to_unsigned(const std::string&);
-      void print_header(void);
-      void print_data(void);
+      ~EDFReader();
+
+      /* the first frame as real_ts. the pointer is valid until the next call */
+      bool get_data(const real_t *&, unsigned int&, unsigned int&);
+      /* a frame as real_ts, as get_data() */
+      bool frame(unsigned int, const real_t *&, unsigned int&, unsigned int&);
+
+      unsigned int num_frames() const { return frames_.size(); }
+      EDFDataType type(unsigned int i) const { return frames_[i].type_; }
+      bool header(unsigned int, const std::string&, std::string&) const;
+
+      /* in place view of a frame, NULL if its type or byte order does not match T */
+      template <typename T> const T* view(unsigned int i) const {
+        if(i >= frames_.size() || !frames_[i].native_) return NULL;
+        EDFDataType t = frames_[i].type_;
+        bool real = (t == edf_type_float32 || t == edf_type_float64);
+        bool is_signed = real || t == edf_type_int8 || t == edf_type_int16 || t == edf_type_int32;
+        if(sizeof(T) != type_size(t) || std::numeric_limits<T>::is_integer == real ||
+           std::numeric_limits<T>::is_signed != is_signed) return NULL;
+        return reinterpret_cast<const T*>(map_ + frames_[i].offset_);
+      } // view()
 
     private:
-      std::map <std::string, std::string> header_;  /* header key -> value map */
-      std::vector <real_t> data_;          /* the data as real_ts */
-      unsigned int rows_;
-      unsigned int cols_;
+      struct Frame {
+        std::map <std::string, std::string> header_;  /* header key -> value map */
+        EDFDataType type_;
+        bool native_;                   /* byte order of the host */
+        size_t offset_;                 /* of the payload in the file */
+        unsigned int rows_;
+        unsigned int cols_;
+      }; // struct Frame
+
+      const char* map_;                 /* the mapped file */
+      size_t map_size_;
+      std::vector <Frame> frames_;
+      std::vector <real_t> data_;       /* converted frame */
+
+      bool parse(const char*);
+      bool parse_header(size_t&, Frame&);
+      static size_t type_size(EDFDataType);
+      void print_header(unsigned int);
 
   }; // class EDFReader
 
 
+  /**
+   * Writer of EDF files with float payloads, in one bulk write per frame. Consecutive
+   * frames of the same size can be written into one multi-frame file.
+   */
   class EDFWriter {
     public:
       EDFWriter(const char * name) :filename_(name), pixel_(172.E-06) {}
@@ -62,6 +105,8 @@ namespace hig {
       void setSize(int r, int c){ nrow_ = r; ncol_ = c; }
       void sdd(real_t ); // calculate SDD for Xi-cam (HipIES) compatibility
       void Write(real_t *);
+      /* nframes frames, stored one after the other in data */
+      bool Write(const real_t *, unsigned int nframes);
 
     private:
       const char * filename_;
@@ -73,6 +118,8 @@ namespace hig {
     
       EDFWriter(){} // forbid default constructor
 
+      std::string header(unsigned int, unsigned int) const;
+
   }; // EDFWriter
 
 } // namespace hig
@@ -0,0 +1,104 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: hdf5_results.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __HDF5_RESULTS_HPP__
+#define __HDF5_RESULTS_HPP__
+
+#ifdef USE_PARALLEL_HDF5
+
+#include <string>
+#include <vector>
+#include <hdf5.h>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * Single HDF5 container for the results of a sweep over (alphai, phi, tilt). The file has
+   * the coordinate datasets /alphai, /phi and /tilt (degrees), and one chunked, compressed
+   * dataset per quantity, indexed by the sweep coordinates:
+   *    /intensity    [alphai, phi, tilt, row, col]
+   *    /averaged     [alphai, row, col]               over phi and tilt, if swept
+   *    /ff, /sf      [alphai, phi, tilt, structure, q] |ff| and |sf| of the first grain
+   * Results are staged as they are computed, by any process, and written by flush(). In MPI
+   * builds the file is opened on a communicator, and open(), flush() and close() are
+   * collective on it: all processes must call flush() the same number of times, each
+   * writing its staged blocks with collective writes.
+   */
+  class HDF5ResultWriter {
+    public:
+      enum Quantity { intensity = 0, averaged, ff, sf, num_quantities };
+
+    private:
+      struct Block {
+        Quantity quantity_;
+        hsize_t index_[4];              /* leading (sweep) indices into the dataset */
+        std::vector<real_t> data_;
+      }; // struct Block
+
+      hid_t file_;
+      hid_t dxpl_;                      /* transfer properties of the writes */
+      hid_t dset_[num_quantities];      /* negative if not present */
+      unsigned int rank_[num_quantities];
+      hsize_t dims_[num_quantities][5];
+      std::vector<Block> staged_;
+      #ifdef USE_MPI
+        MPI_Comm comm_;
+      #endif
+
+      bool create(Quantity, const char*, unsigned int, const hsize_t*, hid_t);
+      bool write_coordinates(const char*, const std::vector<real_t>&);
+      bool write(Quantity, const Block*);
+      void stage(Quantity, const hsize_t*, const real_t*, size_t);
+
+    public:
+      HDF5ResultWriter();
+      ~HDF5ResultWriter() { close(); }
+
+      /**
+       * create the container. the coordinates give the sweep values, nrow x ncol the image
+       * size, and nstruct x nq the size of the form and the structure factors, included if
+       * the respective flags are set
+       */
+      bool open(const std::string&, const std::vector<real_t>&, const std::vector<real_t>&,
+                const std::vector<real_t>&, unsigned int, unsigned int, bool,
+                unsigned int, unsigned int, bool, bool
+                #ifdef USE_MPI
+                  , MPI_Comm
+                #endif
+                );
+      bool is_open() const { return file_ >= 0; }
+
+      /* copy a result into the staging area. out of range indices are ignored */
+      void stage_intensity(int, int, int, const real_t*);
+      void stage_averaged(int, const real_t*);
+      void stage_factor(Quantity, int, int, int, int, const complex_t*);
+
+      /* write and drop all staged results */
+      bool flush();
+      bool close();
+
+  }; // class HDF5ResultWriter
+
+} // namespace hig
+
+#endif // USE_PARALLEL_HDF5
+
+#endif // __HDF5_RESULTS_HPP__
@@ -27,6 +27,8 @@ extern "C" {
 #include <stdlib.h>
 
 void h5_shape_reader(const char* hdf5_filename, double** shape_def, unsigned int* num_triangles);
+int h5_has_density(const char* hdf5_filename);
+int h5_density_reader(const char* hdf5_filename, double** density, unsigned int* dims, double* voxel);
 
 #ifdef __cplusplus
 }
@@ -17,7 +17,11 @@
 #ifndef _HIG_FILE_READER_
 #define _HIG_FILE_READER_
 
+#include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <common/typedefs.hpp>
 #include <file/objectshape_reader.hpp>
@@ -35,7 +39,7 @@ namespace hig {
 extern "C" {
 #endif
 
-  unsigned int c_hdf5_shape_reader(const char* filename, double** shape_def, unsigned int* num_triangles) {
+  inline unsigned int c_hdf5_shape_reader(const char* filename, double** shape_def, unsigned int* num_triangles) {
     // improve this later ...
     // for now just call the old function
     h5_shape_reader(filename, shape_def, num_triangles);
@@ -102,6 +106,90 @@ extern "C" {
         return num_triangles;
       } // obj_shape_reader()
 
+      /**
+       * density grid in the raw binary format: the grid size nx, ny, nz (3 x uint32), the voxel
+       * size along x, y, z (3 x float64), followed by the nx x ny x nz densities (float64),
+       * x varying fastest. with header_only, only the sizes are read.
+       * returns the number of voxels, 0 on failure
+       */
+      unsigned int raw_density_reader(const char* filename, std::vector<real_t> &density,
+                    unsigned int* dims, real_t* voxel, bool header_only = false) {
+        std::ifstream f(filename, std::ios::in | std::ios::binary);
+        if(!f.is_open()) {
+          std::cerr << "error: cannot open density grid file " << filename << std::endl;
+          return 0;
+        } // if
+        unsigned int n[3] = { 0, 0, 0 };
+        double d[3] = { 0., 0., 0. };
+        f.read((char*) n, 3 * sizeof(unsigned int));
+        f.read((char*) d, 3 * sizeof(double));
+        if(!f.good() || n[0] < 1 || n[1] < 1 || n[2] < 1) {
+          std::cerr << "error: invalid density grid header in " << filename << std::endl;
+          return 0;
+        } // if
+        for(int i = 0; i < 3; ++ i) { dims[i] = n[i]; voxel[i] = d[i]; }
+        size_t num_voxels = (size_t) n[0] * n[1] * n[2];
+        if(header_only) return num_voxels;
+
+        std::vector<double> temp(num_voxels);
+        f.read((char*) &temp[0], num_voxels * sizeof(double));
+        if(!f.good()) {
+          std::cerr << "error: density grid file " << filename << " is truncated" << std::endl;
+          return 0;
+        } // if
+        density.assign(temp.begin(), temp.end());
+        return num_voxels;
+      } // raw_density_reader()
+
+      /**
+       * point spread kernel as a text matrix, one row of whitespace separated values per
+       * line, the rows in increasing y. empty lines are skipped.
+       * returns the number of values, 0 on failure
+       */
+      unsigned int psf_reader(const char* filename, std::vector<real_t> &kernel,
+                    unsigned int &kx, unsigned int &ky) {
+        std::ifstream f(filename);
+        if(!f.is_open()) {
+          std::cerr << "error: cannot open point spread kernel file " << filename << std::endl;
+          return 0;
+        } // if
+        kernel.clear(); kx = ky = 0;
+        std::string line;
+        while(std::getline(f, line)) {
+          std::istringstream row(line);
+          unsigned int n = 0;
+          real_t v;
+          while(row >> v) { kernel.push_back(v); ++ n; }
+          if(n == 0) continue;
+          if(ky > 0 && n != kx) {
+            std::cerr << "error: rows of different lengths in point spread kernel "
+                      << filename << std::endl;
+            kernel.clear(); kx = ky = 0;
+            return 0;
+          } // if
+          kx = n; ++ ky;
+        } // while
+        return kernel.size();
+      } // psf_reader()
+
+      #ifdef USE_PARALLEL_HDF5
+      bool hdf5_is_density(const char* filename) {
+        return h5_has_density(filename) != 0;
+      } // hdf5_is_density()
+
+      unsigned int hdf5_density_reader(const char* filename, std::vector<real_t> &density,
+                    unsigned int* dims, real_t* voxel) {
+        double* temp = NULL;
+        double d[3];
+        int num_voxels = h5_density_reader(filename, &temp, dims, d);
+        if(num_voxels < 1 || temp == NULL) return 0;
+        for(int i = 0; i < 3; ++ i) voxel[i] = d[i];
+        density.assign(temp, temp + num_voxels);
+        free(temp);
+        return num_voxels;
+      } // hdf5_density_reader()
+      #endif
+
   }; // class HiGFileReader
 
 } // namespace hig
@@ -0,0 +1,109 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: raw_data.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __RAW_DATA_HPP__
+#define __RAW_DATA_HPP__
+
+#include <string>
+
+#include <common/typedefs.hpp>
+#include <common/enums.hpp>
+
+namespace hig {
+
+  /**
+   * Binary raw data files (.hgr). A file is a 64 byte header, followed by the metadata text
+   * (key=value lines), padded so that the payload starts at a multiple of 64 bytes, and the
+   * payload, with the first dimension varying fastest. All header fields and the payload
+   * are little endian. The header is:
+   *    0   char[6]   magic "HIGRAW"
+   *    6   uint16    version
+   *    8   uint8     value type (RawDataType)
+   *    9   uint8     number of dimensions (1 to 3)
+   *   10   uint16    reserved
+   *   12   uint32    metadata size in bytes
+   *   16   uint64[3] dimensions (unused ones are 1)
+   *   40   uint64    payload offset
+   *   48   byte[16]  reserved
+   */
+  enum RawDataType {
+    raw_data_error = 0,
+    raw_data_float32 = 1,
+    raw_data_float64 = 2,
+    raw_data_complex64 = 3,
+    raw_data_complex128 = 4
+  }; // enum RawDataType
+
+  const unsigned int RAW_DATA_HEADER_SIZE = 64;
+  const unsigned int RAW_DATA_VERSION = 1;
+
+  /* file extension for the given output format, including the dot */
+  const char* raw_data_extension(OutputFormatType);
+
+  /**
+   * write the values of data, of the given dimensions, in one bulk write. the values are
+   * stored as floats when single is set, else as doubles. returns false on errors
+   */
+  bool write_raw_data(const std::string&, const real_t*, unsigned int, const unsigned int*,
+                      bool single, const std::string& meta = std::string());
+  bool write_raw_data(const std::string&, const complex_t*, unsigned int, const unsigned int*,
+                      bool single, const std::string& meta = std::string());
+
+
+  /**
+   * Read-only view of a raw data file. On little endian hosts the file is memory mapped,
+   * and the payload is accessed in place; elsewhere it is read and byte swapped once.
+   */
+  class RawDataFile {
+    private:
+      void* map_;                   /* mapped file, NULL if not mapped */
+      size_t map_size_;
+      char* buffer_;                /* payload copy when not mapped */
+      const char* payload_;
+      RawDataType type_;
+      unsigned int ndims_;
+      size_t dims_[3];
+      std::string meta_;
+
+      bool parse_header(const unsigned char*, size_t);
+
+    public:
+      RawDataFile(): map_(NULL), map_size_(0), buffer_(NULL), payload_(NULL),
+                     type_(raw_data_error), ndims_(0) { dims_[0] = dims_[1] = dims_[2] = 0; }
+      ~RawDataFile() { close(); }
+
+      bool open(const std::string&);
+      void close();
+
+      RawDataType type() const { return type_; }
+      unsigned int ndims() const { return ndims_; }
+      size_t dim(unsigned int i) const { return (i < 3) ? dims_[i] : 0; }
+      size_t size() const { return dims_[0] * dims_[1] * dims_[2]; }
+      const std::string& meta() const { return meta_; }
+      bool meta(const std::string&, std::string&) const;
+
+      /* the payload in place, NULL if its precision does not match real_t */
+      const real_t* real_data() const;
+      const complex_t* complex_data() const;
+
+      /* copy the payload of a real type into data, converting to real_t */
+      bool copy(real_t*) const;
+
+  }; // class RawDataFile
+
+} // namespace hig
+
+#endif // __RAW_DATA_HPP__
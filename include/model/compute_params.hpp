@@ -33,6 +33,10 @@ namespace hig {
       std::string runname_;
       std::string method_;  // TODO: ... change to enum - "dwba" ?
       StructCorrelationType correlation_;    /* grain/ensemble correlation type */
+      TriangleMethodType triangle_method_;   /* integration of triangulated shapes */
+      real_t triangle_tol_;                  /* max |q| * radius of approximated triangles or clusters */
+      unsigned int density_pad_;             /* padding factor of density grid transforms */
+      OutputFormatType output_format_;       /* format of the raw data output files */
       struct OutputRegion {
         OutputRegionType type_;
         vector2_t minpoint_;
@@ -57,6 +61,10 @@ namespace hig {
       bool saveff() const { return saveff_; }
       bool savesf() const { return savesf_; }
       StructCorrelationType param_structcorrelation() const { return correlation_; }
+      TriangleMethodType triangle_method() const { return triangle_method_; }
+      real_t triangle_tolerance() const { return triangle_tol_; }
+      unsigned int density_padding() const { return density_pad_; }
+      OutputFormatType output_format() const { return output_format_; }
 
       /* setters */
 
@@ -78,6 +86,10 @@ namespace hig {
       void palette(std::string p) { palette_ = p; }
       void nslices(real_t d) { nslices_ = (unsigned int) d; }
       void structcorrelation(StructCorrelationType c) { correlation_ = c; }
+      void triangle_method(TriangleMethodType m) { triangle_method_ = m; }
+      void triangle_tolerance(real_t t) { triangle_tol_ = t; }
+      void density_padding(real_t p) { density_pad_ = (unsigned int) p; }
+      void output_format(OutputFormatType f) { output_format_ = f; }
 
       /* getters */
       OutputRegion output_region() const { return output_region_; }
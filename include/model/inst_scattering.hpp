@@ -45,6 +45,7 @@ namespace hig {
       real_t spot_area_;
       //vector3_t smearing_;
       real_t smearing_;
+      std::string psf_;           /* file of the detector point spread kernel, if any */
 
     public:
       ScatteringParams();
@@ -63,6 +64,7 @@ namespace hig {
       //void smearing(real_t v, real_t w, real_t x) {
       //  smearing_[0] = v; smearing_[1] = w; smearing_[2] = x; }
       void smearing(real_t s) { smearing_ = s; }
+      void psf(std::string s) { psf_ = s; }
 
       void alphai_min(real_t d) { alpha_i_.min_ = d; }
       void alphai_max(real_t d) { alpha_i_.max_ = d; }
@@ -82,6 +84,7 @@ namespace hig {
 
       // getters
       real_t smearing() const { return smearing_; }
+      const std::string& psf() const { return psf_; }
 
       void tilt(real_t & vmin, real_t & vmax, real_t & vstep) const {
         vmin = tilt_.min_; vmax = tilt_.max_; vstep= tilt_.step_;
@@ -123,6 +126,7 @@ namespace hig {
               << " coherence_ = " << coherence_ << std::endl
               << " spot_area_ = " << spot_area_ << std::endl
               << " smearing_ = " << smearing_ << std::endl
+              << " psf_ = " << psf_ << std::endl
               //<< " smearing_ = [" << smearing_[0] << ", " << smearing_[1] << ", "
               //<< smearing_[2] << "]" << std::endl
               << std::endl;
@@ -23,6 +23,7 @@
 
 #include <common/typedefs.hpp>
 #include <model/common.hpp>
+#include <model/qgrid.hpp>
 
 namespace hig {
 
@@ -47,7 +48,7 @@ namespace hig {
       real_t thickness() const { return thickness_; }
       int order() const { return order_; }
       real_t z_val() const { return z_val_; }
-      complex_t one_minus_n2() { return refindex_.one_minus_n2(); }
+      complex_t one_minus_n2() const { return refindex_.one_minus_n2(); }
 
       /* setters */
       void key(std::string s) { key_ = s; }
@@ -75,6 +76,11 @@ namespace hig {
     private:
       std::vector<Layer> layers_;
 
+      /* number of angles processed together by the batched recursion */
+      static const int PARRATT_BLOCK_ = 64;
+
+      void parratt_block(const real_t*, int, real_t, int, complex_t*, complex_t*) const;
+
     public:
       // constructors
       MultiLayer();
@@ -94,8 +100,15 @@ namespace hig {
       // calculate Ts and Rs of an angle
       complex_vec_t parratt_recursion(real_t, real_t, int);
 
+      // Ts and Rs of the given layer for a batch of angles, zero for angles not above
+      // the horizon. the angles are processed in blocks, vectorized across the angles
+      void parratt_batch(const real_t*, int, real_t, int, complex_t*, complex_t*) const;
+
+      // the parameters of the layer stack which the coefficients depend on
+      void signature(std::vector<real_t>&) const;
+
       // calculate transmission and reflection coefficents
-      bool propagation_coeffs(complex_vec_t &, real_t, real_t, int);
+      bool propagation_coeffs(complex_vec_t &, real_t, real_t, int, const QGridView&);
 
       /** DEBUG **/
      void debug_multilayer();
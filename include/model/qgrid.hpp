@@ -24,6 +24,12 @@
 
 namespace hig {
 
+  class QGridView;
+
+  /**
+   * Q-grid data of a simulation. Each simulation context owns its own grid; the process-wide
+   * instance() is kept as the default grid for code paths that are not context aware yet.
+   */
   class QGrid {       
     /* data types for qgrid data */
     typedef std::vector<real_t> qvec_t;
@@ -41,19 +47,28 @@ namespace hig {
       qvec_t qx_;
       qvec_t qy_;
       qvec_t qz_;
-      qvec_t alpha_;
+      qvec_t alpha_;                        /* exit angle of each row */
+      qvec_t theta_;                        /* in-plane exit angle of each column */
       cqvec_t qz_extended_;
+      real_t k0_;
+      real_t alpha_i_;
+      /* row major pixel (row * ncol + col) of each point, empty when all pixels are points */
+      std::vector<unsigned int> pixels_;
 
-      /* singleton */
-      QGrid() { }
+      /* non-copyable */
       QGrid(const QGrid&);
       QGrid& operator=(const QGrid&);
 
       bool pixel_to_kspace(vector2_t, real_t, real_t, real_t, real_t, vector2_t, vector3_t&);
       vector3_t pixel_to_kspace(vector2_t, real_t, real_t, real_t, real_t, vector2_t);
       bool kspace_to_pixel();    // not implemented yet ...
+      void fill_points();
 
     public:
+      QGrid(): nrow_(0), ncol_(0), k0_(0.), alpha_i_(0.) { }
+      ~QGrid() { }
+
+      /* default process-wide grid */
       static QGrid& instance() {
         static QGrid qgrid;
         return qgrid;
@@ -62,12 +77,21 @@ namespace hig {
       /* create the Q-grid */
       bool create(const ComputeParams &, real_t, real_t, int);
       bool create_qz_extended(real_t, real_t, complex_t); 
+      /* restore a previously created qz_extended */
+      void qz_extended(const cqvec_t& qz) { qz_extended_ = qz; }
       bool create_test();
 
       /* for fitting */
       bool update(unsigned int, unsigned int, real_t, real_t, real_t, real_t,
             real_t, real_t, real_t, int);
 
+      /**
+       * restrict the points to the given pixels, sorted row major indices into the
+       * nrow x ncol image. an empty list selects all pixels. create() and update() select
+       * all pixels, the qz_extended has to be recreated after a selection
+       */
+      bool select(const std::vector<unsigned int>&);
+
       /* temporary for steepest descent fitting */
       bool create_z_cut(real_t, real_t, real_t, real_t);
 
@@ -82,6 +106,12 @@ namespace hig {
       vector2_t qmin() const   { return qmin_;               }
       vector2_t qmax() const   { return qmax_;               }
 
+      /* selected pixels */
+      bool sparse() const      { return !pixels_.empty();    }
+      unsigned int npoints() const { return qz_.size();      }
+      unsigned int pixel(unsigned int i) const { return pixels_.empty() ? i : pixels_[i]; }
+      const unsigned int* pixels() const { return pixels_.empty() ? NULL : &pixels_[0]; }
+
 
       /* NOTE: delta are not constants in q-space */
       /* deltas */ 
@@ -116,11 +146,88 @@ namespace hig {
       real_t* qz(void) { return &qz_[0]; }
       complex_t* qz_extended(void) { return &qz_extended_[0]; }
 
+      /* read-only view of the current data, invalidated when the grid is modified */
+      QGridView view() const;
+
       /* debug */
-      void save (const char *);
+      void save (const char *, OutputFormatType format = output_format_text);
 
   }; // class QGrid
 
+
+  /**
+   * Non-owning read-only view of a q-grid, passed explicitly to the compute kernels so that
+   * they do not depend on global state. The accessors mirror those of QGrid.
+   */
+  class QGridView {
+    private:
+      int nqx_;
+      int nqy_;
+      int nqz_;
+      int nqz_extended_;
+      int nrow_;
+      int ncol_;
+      int nalpha_;
+      const unsigned int* pixels_;
+      const real_t* qx_;
+      const real_t* qy_;
+      const real_t* qz_;
+      const real_t* alpha_;
+      const complex_t* qz_extended_;
+
+    public:
+      QGridView():
+        nqx_(0), nqy_(0), nqz_(0), nqz_extended_(0), nrow_(0), ncol_(0), nalpha_(0),
+        pixels_(NULL), qx_(NULL), qy_(NULL), qz_(NULL), alpha_(NULL), qz_extended_(NULL) { }
+      QGridView(int nqx, int nqy, int nqz, int nqz_extended, int nrow, int ncol, int nalpha,
+                const unsigned int* pixels,
+                const real_t* qx, const real_t* qy, const real_t* qz, const real_t* alpha,
+                const complex_t* qz_extended):
+        nqx_(nqx), nqy_(nqy), nqz_(nqz), nqz_extended_(nqz_extended),
+        nrow_(nrow), ncol_(ncol), nalpha_(nalpha), pixels_(pixels),
+        qx_(qx), qy_(qy), qz_(qz), alpha_(alpha), qz_extended_(qz_extended) { }
+
+      /* sizes */
+      int nqx() const          { return nqx_;          }
+      int nqy() const          { return nqy_;          }
+      int nqz() const          { return nqz_;          }
+      int nqz_extended() const { return nqz_extended_; }
+      int nrows() const        { return nrow_;         }
+      int ncols() const        { return ncol_;         }
+      int nalpha() const       { return nalpha_;       }
+
+      /* pixel and image row of the i-th point */
+      unsigned int pixel(unsigned int i) const { return (pixels_ == NULL) ? i : pixels_[i]; }
+      unsigned int row(unsigned int i) const   { return pixel(i) / ncol_; }
+
+      /* value accessors */
+      real_t qx(int i) const { return qx_[i]; }
+      real_t qy(int i) const { return qy_[i]; }
+      real_t qz(int i) const { return qz_[i]; }
+      complex_t qz_extended(int i) const { return qz_extended_[i]; }
+      real_t qx(unsigned int i) const { return qx_[i]; }
+      real_t qy(unsigned int i) const { return qy_[i]; }
+      real_t qz(unsigned int i) const { return qz_[i]; }
+      complex_t qz_extended(unsigned int i) const { return qz_extended_[i]; }
+      real_t alpha(unsigned int i) const { return alpha_[i]; }
+
+      /* raw data */
+      const real_t* qx() const { return qx_; }
+      const real_t* qy() const { return qy_; }
+      const real_t* qz() const { return qz_; }
+      const complex_t* qz_extended() const { return qz_extended_; }
+
+  }; // class QGridView
+
+
+  inline QGridView QGrid::view() const {
+    return QGridView(qx_.size(), qy_.size(), qz_.size(), qz_extended_.size(), nrow_, ncol_,
+                     alpha_.size(), pixels(),
+                     qx_.empty() ? NULL : &qx_[0], qy_.empty() ? NULL : &qy_[0],
+                     qz_.empty() ? NULL : &qz_[0], alpha_.empty() ? NULL : &alpha_[0],
+                     qz_extended_.empty() ? NULL : &qz_extended_[0]);
+  } // QGrid::view()
+
 } // namespace hig
 
 #endif // __QGRID_HPP__ */
@@ -141,7 +141,7 @@ namespace hig {
 
       void abangle(real_t d) { abangle_ = d; }
       void caratio(real_t d) { caratio_ = d; }
-      void bragg_angles(vector3_t, vector3_t, real_t, real_vec_t &);
+      void bragg_angles(vector3_t, vector3_t, real_t, vector2_t, vector2_t, real_vec_t &);
 
       friend class Grain;
 
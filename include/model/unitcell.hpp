@@ -33,6 +33,7 @@ namespace hig {
 
       typedef location_list_t::iterator location_iterator_t;
       typedef element_list_t::iterator element_iterator_t;
+      typedef element_list_t::const_iterator element_citerator_t;
 
     private:
       std::string key_;         /* unique key for the unit cell */
@@ -58,6 +59,8 @@ namespace hig {
       inline string_t key() const { return key_; }
       inline element_iterator_t element_begin() { return elements_.begin(); }
       inline element_iterator_t element_end() { return elements_.end(); }
+      inline element_citerator_t element_cbegin() const { return elements_.cbegin(); }
+      inline element_citerator_t element_cend() const { return elements_.cend(); }
 
       /* modifiers ... TODO */
       //bool update_element(const string_t&, const vector3_t&);
@@ -175,11 +175,6 @@ namespace hig {
       } // convolution_gaussian_2d()
 
 
-      bool gaussian_fft ( real_t * &data, unsigned nx, unsigned ny, real_t sigma) {
-        real_t  * image_f;
-        real_t  * filter, * filter_f;
-      }
-
 /*      bool compute_conv_2d_valid1(unsigned int a_xsize, unsigned int a_ysize, const double *a,
                   unsigned int b_xsize, unsigned int b_ysize, const double *b,
                   unsigned int& c_xsize, unsigned int& c_ysize, double* &c) {
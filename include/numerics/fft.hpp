@@ -0,0 +1,73 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: fft.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __FFT_HPP__
+#define __FFT_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * In-place radix-2 complex FFTs, computing sum_j a_j exp(sign i 2 pi j k / n). The inverse
+   * (sign = 1) is not normalized. All sizes must be powers of two.
+   */
+
+  /* smallest power of two not less than n */
+  extern unsigned int fft_size(unsigned int n);
+
+  extern bool fft_1d(complex_t* data, unsigned int n, int sign);
+
+  /* transform of an nx x ny x nz array, x varying fastest */
+  extern bool fft_3d(complex_t* data, unsigned int nx, unsigned int ny, unsigned int nz, int sign);
+
+  /**
+   * Twiddle factors of an nx x ny transform, in both directions, computed once and reused by
+   * every execution. execute() is serial, so that independent arrays can be transformed
+   * concurrently, each with its own buffer of line_size() values. execute_parallel()
+   * distributes the lines of one array over the threads.
+   */
+  class FFTPlan2D {
+    private:
+      unsigned int nx_, ny_;
+      std::vector<complex_t> wx_[2], wy_[2];    /* [0]: sign -1, [1]: sign 1 */
+
+      /* number of columns gathered together */
+      static const unsigned int COLS_ = 8;
+
+      void columns(complex_t*, unsigned int, const complex_t*, complex_t*) const;
+
+    public:
+      FFTPlan2D(): nx_(0), ny_(0) { }
+      ~FFTPlan2D() { }
+
+      bool init(unsigned int nx, unsigned int ny);
+      void clear() { nx_ = ny_ = 0; for(int i = 0; i < 2; ++ i) { wx_[i].clear(); wy_[i].clear(); } }
+      bool empty() const { return nx_ == 0; }
+      unsigned int nx() const { return nx_; }
+      unsigned int ny() const { return ny_; }
+
+      size_t line_size() const { return (size_t) COLS_ * ny_; }
+
+      void execute(complex_t* data, int sign, complex_t* line) const;
+      void execute_parallel(complex_t* data, int sign) const;
+  }; // class FFTPlan2D
+
+} // namespace hig
+
+#endif // __FFT_HPP__
@@ -0,0 +1,64 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: gaussian_smearing.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __GAUSSIAN_SMEARING_HPP__
+#define __GAUSSIAN_SMEARING_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+
+namespace hig {
+
+  /**
+   * Separable 2-D Gaussian smearing of a row-major image, normalized by the kernel weights
+   * falling inside the image. Each pass filters contiguous rows; the vertical pass runs on
+   * the image transposed in tiles, and the result is transposed back. Small sigmas use a
+   * direct kernel truncated at 4 sigma, larger ones the fourth order recursive Gaussian of
+   * Deriche, whose cost does not depend on sigma. The scratch buffers are kept between
+   * calls, so an object should not be used concurrently.
+   */
+  class GaussianSmearing {
+    private:
+      std::vector<real_t> scratch_;         /* transposed image */
+      std::vector<real_t> weights_;         /* direct kernel */
+      std::vector<real_t> norm_;            /* kernel weights inside a line */
+
+      /* smallest sigma, in pixels, for which the recursive filter is used */
+      static const real_t RECURSIVE_MIN_SIGMA_;
+
+      bool use_recursive(real_t sigma) const { return sigma >= RECURSIVE_MIN_SIGMA_; }
+      void init_direct(real_t);
+      void filter_rows(const real_t*, real_t*, unsigned int, unsigned int, real_t);
+      void direct_line(const real_t*, real_t*, unsigned int) const;
+      void recursive_line(const real_t*, real_t*, unsigned int, real_t) const;
+      void line_norm(unsigned int, real_t);
+
+    public:
+      GaussianSmearing() { }
+      ~GaussianSmearing() { }
+
+      /* smear the nx x ny image (x varying fastest), sigma in pixels */
+      bool smear(real_t*, unsigned int, unsigned int, real_t);
+
+      /* release the scratch buffers */
+      void clear();
+
+  }; // class GaussianSmearing
+
+} // namespace hig
+
+#endif // __GAUSSIAN_SMEARING_HPP__
@@ -93,7 +93,10 @@ namespace hig {
         return *this;
       }
 
-      // DEBUG -- print 
+      // element access (row i, column j)
+      CUDAFY real_t operator()(int i, int j) const { return data_[3 * i + j]; }
+
+      // DEBUG -- print
       void print() const {
         for (int i = 0; i < 9; i++){
           std::cout << "  " << data_[i];
@@ -131,6 +134,14 @@ namespace hig {
         return res;
       }
 
+      // Matrix-vector multiplication (Rotation), without allocation
+      void rotate(real_t x, real_t y, complex_t z,
+              complex_t & mx, complex_t & my, complex_t & mz) const {
+        mx = data_[0] * x + data_[1] * y + data_[2] * z;
+        my = data_[3] * x + data_[4] * y + data_[5] * z;
+        mz = data_[6] * x + data_[7] * y + data_[8] * z;
+      }
+
 #ifdef USE_GPU
       __device__ void rotate(real_t x, real_t y, cucomplex_t z, 
               cucomplex_t &mx, cucomplex_t &my, cucomplex_t &mz){
@@ -0,0 +1,84 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: psf_convolution.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __PSF_CONVOLUTION_HPP__
+#define __PSF_CONVOLUTION_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+#include <numerics/fft.hpp>
+
+namespace hig {
+
+  /**
+   * Convolution of a row-major image with an arbitrary (non-separable) point spread kernel,
+   * centered at (kx / 2, ky / 2), through FFTs (directly for very small kernels). The result
+   * has the size of the image, and is normalized by the kernel weight falling inside the
+   * image, as the Gaussian smearing.
+   * Images whose zero-padded transform is small enough are done in one tile, larger ones by
+   * overlap-add over tiles of at least twice the kernel size. Two real tiles are packed into
+   * the real and imaginary parts of one complex transform, since the kernel is real.
+   * The kernel transform, the FFT plan and the normalization are kept for the image size
+   * last used, so that repeated convolutions (e.g. in fitting) only pay for the transforms of
+   * the image. An object should not be used concurrently.
+   */
+  class PSFConvolution {
+    private:
+      std::vector<real_t> kernel_;          /* normalized to unit sum */
+      unsigned int kx_, ky_;
+
+      /* plan for the current image size */
+      unsigned int nx_, ny_;                /* image size */
+      unsigned int bx_, by_;                /* image block of a tile */
+      FFTPlan2D plan_;                      /* tile transforms */
+      std::vector<complex_t> spectrum_;     /* kernel transform, scaled by the inverse size */
+      std::vector<real_t> norm_;            /* inverse kernel weights inside the image */
+      std::vector<real_t> full_;            /* full convolution, (nx + kx - 1) x (ny + ky - 1) */
+      std::vector<complex_t> tiles_;        /* per thread tile and line buffers */
+
+      /* largest transform size along a dimension for which the image is not tiled */
+      static const unsigned int MAX_SINGLE_TILE_ = 2048;
+      /* smallest tile size when tiling */
+      static const unsigned int MIN_TILE_ = 256;
+      /* largest kernel, in number of values, applied directly */
+      static const unsigned int MAX_DIRECT_TAPS_ = 49;
+
+      bool plan(unsigned int, unsigned int);
+      void tile_pair(const real_t*, long int, long int, complex_t*, complex_t*);
+      void convolve_full(const real_t*);
+
+    public:
+      PSFConvolution(): kx_(0), ky_(0), nx_(0), ny_(0), bx_(0), by_(0) { }
+      ~PSFConvolution() { }
+
+      /* set the kx x ky kernel (x varying fastest), dropping the current plan */
+      bool kernel(const real_t*, unsigned int, unsigned int);
+      bool empty() const { return kernel_.empty(); }
+      unsigned int kx() const { return kx_; }
+      unsigned int ky() const { return ky_; }
+
+      /* convolve the nx x ny image (x varying fastest) in place */
+      bool convolve(real_t*, unsigned int, unsigned int);
+
+      /* drop the kernel and the plan */
+      void clear();
+
+  }; // class PSFConvolution
+
+} // namespace hig
+
+#endif // __PSF_CONVOLUTION_HPP__
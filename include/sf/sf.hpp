@@ -23,7 +23,9 @@
 
 #include <common/typedefs.hpp>
 #include <common/globals.hpp>
+#include <common/enums.hpp>
 #include <model/structure.hpp>
+#include <model/qgrid.hpp>
 #include <numerics/matrix.hpp>
 
 #ifdef USE_GPU
@@ -39,6 +41,7 @@ namespace hig {
       unsigned int ny_;
       unsigned int nz_;
       StructureType type_;
+      QGridView qgrid_;     /* q-grid of the current computation */
 
       #ifdef SF_GPU
         StructureFactorG gsf_;
@@ -48,10 +51,18 @@ namespace hig {
       StructureFactor();
       ~StructureFactor();
       void putStructureType(StructureType d){ type_ = d; }
+
+      /* the liquid-like structure factors depend neither on the grain orientation, position
+       * nor repetition: they need to be computed only once per structure and q-grid */
+      static bool grain_invariant(StructureType d) {
+        return (d == paracrystal_type || d == percusyevick_type);
+      } // grain_invariant()
+      bool grain_invariant() const { return grain_invariant(type_); }
       void clear(void);
 
       bool compute_structure_factor(std::string, vector3_t, Lattice*, vector3_t, vector3_t,
-                      RotMatrix_t &, std::shared_ptr<Paracrystal> , std::shared_ptr<PercusYevick> 
+                      RotMatrix_t &, std::shared_ptr<Paracrystal> , std::shared_ptr<PercusYevick>,
+                      const QGridView&
                       #ifdef USE_MPI
                         , woo::MultiNode&, std::string
                       #endif
@@ -66,7 +77,7 @@ namespace hig {
       #endif
       complex_t & operator[](unsigned int i) const { return sf_[i]; }
 
-      void save_sf(const std::string& filename);
+      void save_sf(const std::string& filename, OutputFormatType format = output_format_text);
       void save(const char* filename);
 
       StructureFactor & operator=(const StructureFactor & rhs);
@@ -0,0 +1,55 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: dwba_combine.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __DWBA_COMBINE_HPP__
+#define __DWBA_COMBINE_HPP__
+
+#include <vector>
+
+#include <common/typedefs.hpp>
+#include <sf/sf.hpp>
+
+namespace hig {
+
+  /**
+   * Combines the DWBA channels of a grain into its intensity image:
+   *   image[i] += | weight * sum_k fc_k[i] * sf_k[i] * ff_k[i] |^2
+   * fc and ff do not change between the scaling samples of a grain, so their product is
+   * formed once per grain (prepare) into a scratch buffer that is reused across grains,
+   * and each sample then only streams through this buffer and the structure factor.
+   */
+  class DWBACombine {
+    private:
+      std::vector<complex_t> fcff_;   /* fc * ff, channel-major: [k * imsize + i] */
+      unsigned int imsize_;           /* number of pixels */
+      unsigned int nchannels_;        /* 4 for gisaxs, 1 for saxs */
+
+    public:
+      DWBACombine(): imsize_(0), nchannels_(0) { }
+      ~DWBACombine() { }
+
+      /* fc may be NULL (saxs), in which case it is taken as one */
+      bool prepare(const complex_t* fc, const std::vector<complex_t>& ff,
+                   unsigned int imsize, unsigned int nchannels);
+
+      /* add the intensity of one structure factor sample to image */
+      bool accumulate(const StructureFactor& sf, real_t weight, real_t* image) const;
+
+  }; // class DWBACombine
+
+} // namespace hig
+
+#endif // __DWBA_COMBINE_HPP__
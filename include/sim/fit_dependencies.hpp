@@ -0,0 +1,61 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: fit_dependencies.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __FIT_DEPENDENCIES_HPP__
+#define __FIT_DEPENDENCIES_HPP__
+
+#include <string>
+#include <map>
+
+#include <common/typedefs.hpp>
+#include <common/enums.hpp>
+#include <config/input.hpp>
+
+namespace hig {
+
+  /**
+   * Dependency graph from fit parameters to the simulation stages (FitStage) of each
+   * structure. For instance, a shape parameter invalidates only the form factors of the
+   * structures whose unit cell contains the shape, a lattice parameter only the structure
+   * factors of its structure, while a layer parameter invalidates the propagation
+   * coefficients and everything depending on them, for all structures.
+   */
+  class FitDependencies {
+    public:
+      typedef std::map<std::string, unsigned int> stage_map_t;   /* structure key -> stages */
+
+    private:
+      map_t values_;      /* last applied value of each fit parameter */
+
+      /* stages of each structure depending on the given parameter variable */
+      static bool param_stages(const std::string&, const Input&, stage_map_t&);
+
+    public:
+      FitDependencies() { }
+      ~FitDependencies() { }
+
+      /* compare the given parameters with the previously applied ones, and add the stages
+       * invalidated by the changed ones to dirty. the given values are then recorded */
+      bool update(const map_t&, const Input&, stage_map_t&);
+
+      /* forget all recorded values, the next update invalidates everything it touches */
+      void clear() { values_.clear(); }
+
+  }; // class FitDependencies
+
+} // namespace hig
+
+#endif // __FIT_DEPENDENCIES_HPP__
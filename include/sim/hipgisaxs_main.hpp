@@ -30,6 +30,12 @@
 #include <ff/ff.hpp>
 #include <sf/sf.hpp>
 #include <image/image.hpp>
+#include <sim/simulation_context.hpp>
+#include <sim/sweep_cache.hpp>
+#include <sim/fit_dependencies.hpp>
+#include <numerics/gaussian_smearing.hpp>
+#include <numerics/psf_convolution.hpp>
+#include <file/hdf5_results.hpp>
 
 #ifdef YAML
   #include <config/yaml_input.hpp>
@@ -60,6 +66,18 @@ namespace hig {
       MultiLayer multilayer_; 
       Input * input_;
       std::string output_subdir_;
+      SimulationContext context_;   /* per-simulation state, including the q-grid */
+      SweepCache sweep_;            /* work shared by the runs of a sweep or fit */
+      FitDependencies fit_deps_;    /* fit parameters to invalidated stages */
+      GaussianSmearing smearing_;   /* keeps its scratch buffers between runs */
+      PSFConvolution psf_;          /* detector point spread, keeps its plan between runs */
+      std::vector<real_t> psf_kernel_;  /* point spread kernel as read, in detector pixels */
+      unsigned int psf_kx_, psf_ky_;
+      unsigned int qbin_;           /* detector pixels per q-grid pixel along each axis */
+      #ifdef USE_PARALLEL_HDF5
+        HDF5ResultWriter results_;  /* result container of a sweep */
+      #endif
+      int sweep_index_[3];          /* (alphai, phi, tilt) indices of the current run */
 
       class SampleRotation {
         friend class HipGISAXS;
@@ -129,8 +147,14 @@ namespace hig {
       bool compute_rotation_matrix_y(real_t, vector3_t&, vector3_t&, vector3_t&);
       bool compute_rotation_matrix_z(real_t, vector3_t&, vector3_t&, vector3_t&);
 
-      void save_gisaxs(real_t *final_data, std::string output);
+      void save_gisaxs(real_t *final_data, std::string output, const std::string& meta = std::string());
+      bool open_container(const std::vector<real_t>&, const std::vector<real_t>&,
+                          const std::vector<real_t>&, bool);
+      bool use_container() const { return input_->compute().output_format() == output_format_hdf5; }
       bool gaussian_smearing(real_t*&, real_t);
+      bool load_psf();
+      bool bin_psf(unsigned int);
+      bool psf_convolution(real_t*);
 
       bool normalize(real_t*&, unsigned int);
 
@@ -227,6 +251,11 @@ namespace hig {
 
       string_t reference_data_path(int i) const { return input_->reference_data_path(i); }
       string_t reference_data_mask(int i) const { return input_->reference_data_mask(i); }
+      bool reference_data_sparse(int i) const { return input_->reference_data_sparse(i); }
+      unsigned int reference_data_levels(int i) const { return input_->reference_data_levels(i); }
+      bool reference_data_linecuts(int i, std::vector<unsigned int>& rows,
+                                   std::vector<unsigned int>& cols, unsigned int& width) const {
+        return input_->reference_data_linecuts(i, rows, cols, width); }
 
       int num_fit_params() const { return input_->num_fit_params(); }
       std::vector<real_t> fit_param_init_values() const { return input_->fit_param_init_values(); }
@@ -235,7 +264,18 @@ namespace hig {
       const std::string& path() const { return input_->path(); }
       const std::string& runname() const { return input_->runname(); }
 
-      bool override_qregion(unsigned int n_par, unsigned int n_ver, unsigned int i);
+      /**
+       * resample the q-grid to the n_par x n_ver pixels of the reference region i, or with
+       * bin > 1, to the centers of its bin x bin pixel bins (partial bins are dropped)
+       */
+      bool override_qregion(unsigned int n_par, unsigned int n_ver, unsigned int i,
+                            unsigned int bin = 1);
+      /**
+       * simulate only the pixels where the nrow x ncol mask is nonzero, and the halo around
+       * them reached by the smearing and the point spread kernel. an empty mask, or a change
+       * of the q-region, selects all pixels again
+       */
+      bool select_pixels(const std::vector<unsigned int>&);
 
       #ifdef USE_MPI
         woo::MultiNode* multi_node_comm() { return &multi_node_; }
@@ -0,0 +1,66 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: simulation_context.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __SIMULATION_CONTEXT_HPP__
+#define __SIMULATION_CONTEXT_HPP__
+
+#include <model/qgrid.hpp>
+
+namespace hig {
+
+  /**
+   * Per-simulation state which used to live in process-wide singletons. Each HipGISAXS
+   * object owns a context, so that several simulations (e.g. for different incidence
+   * angles or fitting candidates) can exist and run concurrently in one process. The
+   * compute kernels receive the q-grid explicitly as a QGridView taken from the context.
+   */
+  class SimulationContext {
+    private:
+      QGrid* qgrid_;      /* the q-grid of this simulation */
+      bool own_qgrid_;    /* false when bound to the default process-wide grid */
+
+      /* non-copyable */
+      SimulationContext(const SimulationContext&);
+      SimulationContext& operator=(const SimulationContext&);
+
+    public:
+      /* the gpu kernels still read the default grid, so bind to it in those builds */
+      SimulationContext():
+        #if defined(FF_ANA_GPU) || defined(SF_GPU)
+          qgrid_(&QGrid::instance()), own_qgrid_(false)
+        #else
+          qgrid_(new QGrid()), own_qgrid_(true)
+        #endif
+        { }
+
+      ~SimulationContext() {
+        if(own_qgrid_) delete qgrid_;
+        qgrid_ = NULL;
+      } // ~SimulationContext()
+
+      QGrid& qgrid() { return *qgrid_; }
+      const QGrid& qgrid() const { return *qgrid_; }
+
+      /* view of the current q-grid data, take a new one after every grid modification */
+      QGridView qgrid_view() const { return qgrid_->view(); }
+
+      bool owns_qgrid() const { return own_qgrid_; }
+
+  }; // class SimulationContext
+
+} // namespace hig
+
+#endif // __SIMULATION_CONTEXT_HPP__
@@ -0,0 +1,132 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: sweep_cache.hpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifndef __SWEEP_CACHE_HPP__
+#define __SWEEP_CACHE_HPP__
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <common/typedefs.hpp>
+#include <common/enums.hpp>
+#include <sf/sf.hpp>
+
+namespace hig {
+
+  /**
+   * Work shared between the simulations of an alpha_i / phi / tilt sweep, or between the
+   * evaluations of a fit. Within a sweep:
+   *  - the grain ensemble of a structure (positions, orientations, weights, scalings and
+   *    repetitions) does not depend on any of the swept angles, and is set up once,
+   *  - qz_extended and the propagation coefficients of a layer, as well as the grain
+   *    invariant structure factors, depend only on alpha_i, and are shared by the whole
+   *    batch of phi and tilt angles of one incidence angle. The layer data are matched
+   *    against the incidence angle and the layer stack they were computed for, so that
+   *    they are reused by all structures in a layer, and by all evaluations of a fit which
+   *    leave the layers unchanged, without any explicit invalidation.
+   * When fitting, the angles are fixed and the form factor of each grain and the summed
+   * intensity of each structure are kept as well. Entries are then dropped selectively,
+   * by invalidate(), according to the stages (FitStage) depending on the updated parameters.
+   * The cache is active only between begin() and end(), otherwise nothing is kept.
+   */
+  class SweepCache {
+    public:
+      /* grain ensemble of a structure, the raw arrays are owned by the cache */
+      typedef struct {
+        int num_grains_;
+        real_t* dd_;                          /* grain positions */
+        real_t* nn_;                          /* grain orientations */
+        real_t* wght_;                        /* grain orientation weights */
+        bool samples_valid_;                  /* false when the below need to be recomputed */
+        std::vector<real_t> scaling_samples_;
+        std::vector<real_t> scaling_weights_;
+        std::vector<vector3_t> repeats_;
+      } grains_t;
+
+      /* layer dependent data, valid for the incidence angle and layer stack it was computed for */
+      typedef struct {
+        real_t alphai_;
+        std::vector<real_t> stack_;             /* MultiLayer::signature() */
+        std::vector<complex_t> qz_extended_;
+        complex_vec_t fc_;
+      } layer_t;
+
+      /* products of a structure, kept only when fitting */
+      typedef struct {
+        std::vector<std::vector<complex_t> > grain_ff_;   /* form factor of each local grain */
+        bool intensity_valid_;
+        std::vector<real_t> intensity_;                   /* summed local grain intensities */
+      } products_t;
+
+    private:
+      bool active_;
+      bool fitting_;                                  /* keep the products */
+      real_t alphai_;                                 /* incidence angle of the batch */
+      std::map<std::string, grains_t> grains_;        /* structure key -> grains */
+      std::map<int, layer_t> layers_;                 /* layer order -> last layer data */
+      std::map<std::string, StructureFactor> sfs_;    /* structure key -> invariant sf */
+      std::map<std::string, products_t> products_;   /* structure key -> products */
+      size_t max_ff_bytes_;                           /* bound on the kept form factors */
+      size_t ff_bytes_;
+
+      void clear_grains();
+      void erase_grains(const std::string&);
+      void clear_ff(products_t&);
+
+      SweepCache(const SweepCache&);
+      SweepCache& operator=(const SweepCache&);
+
+    public:
+      SweepCache(size_t max_ff_bytes = ((size_t) 1 << 30)):
+        active_(false), fitting_(false), alphai_(0), max_ff_bytes_(max_ff_bytes), ff_bytes_(0) { }
+      ~SweepCache() { end(); }
+
+      void begin(bool fitting = false) { end(); active_ = true; fitting_ = fitting; }
+      void end() { clear_grains(); clear_batch(); layers_.clear(); active_ = false; fitting_ = false; }
+      bool active() const { return active_; }
+      bool fitting() const { return active_ && fitting_; }
+
+      /* start the batch for an incidence angle, dropping the data of the previous one */
+      void begin_batch(real_t alphai) { clear_batch(); alphai_ = alphai; }
+      void clear_batch() { sfs_.clear(); products_.clear(); ff_bytes_ = 0; }
+      real_t batch_alphai() const { return alphai_; }
+
+      /* drop the entries of a structure depending on the given stages */
+      void invalidate(const std::string&, unsigned int);
+
+      /* all of these return NULL when the cache is not active or the entry is not present */
+      grains_t* find_grains(const std::string&);
+      const layer_t* find_layer(int, real_t, const std::vector<real_t>&) const;
+      StructureFactor* find_sf(const std::string&);
+      /* returns NULL when not fitting, creates an empty entry if not present */
+      products_t* products(const std::string&, unsigned int);
+
+      /* take over the contents of the given data, returns NULL when the cache is not active */
+      grains_t* insert_grains(const std::string&, grains_t&);
+      /* replaces the data of the layer order */
+      const layer_t* insert_layer(int, layer_t&);
+      /* returns the (empty) structure factor to be computed */
+      StructureFactor* insert_sf(const std::string&);
+      /* keep a copy of the form factor of a local grain, if it fits within the bound.
+       * this may be called concurrently for different grains */
+      bool keep_ff(products_t*, unsigned int, const std::vector<complex_t>&);
+
+  }; // class SweepCache
+
+} // namespace hig
+
+#endif // __SWEEP_CACHE_HPP__
@@ -81,6 +81,7 @@ namespace woo {
 			inline bool is_valid() const { return valid_; }
 			inline int master() const { return master_rank_; }
 			inline int is_master() const { return (master_rank_ == rank_); }
+			inline MPI_Comm comm() const { return world_; }
 
 			MultiNodeComm& operator=(const MPI_Comm& comm) {
 				if(valid_) {
@@ -428,6 +429,7 @@ namespace woo {
 			inline int size(comm_t key) { return comms_.at(key).size(); }
 			inline int rank(comm_t key) { return comms_.at(key).rank(); }
 			inline bool is_master(comm_t key) { return comms_.at(key).is_master(); }
+			inline MPI_Comm comm(comm_t key) { return comms_.at(key).comm(); }
 			inline bool is_idle(comm_t key) { return comms_.at(key).is_idle(); }
 			inline int master(comm_t key) { return comms_.at(key).master(); }
 
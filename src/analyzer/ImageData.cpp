@@ -76,6 +76,23 @@ namespace hig {
     return array;
   } // ImageData::read_string_values()
 
+  bool ImageData::set_data(const RawDataFile& file) {
+    if(file.ndims() != 2) {
+      std::cerr << "error: image data must be two dimensional" << std::endl;
+      return false;
+    } // if
+    n_par_ = file.dim(0);
+    n_ver_ = file.dim(1);
+    const real_t* data = file.real_data();
+    if(data != NULL) {
+      set_data(data);
+      return true;
+    } // if
+    data_.resize(n_par_ * n_ver_);
+    return file.copy(&data_[0]);
+  } // ImageData::set_data()
+
+
   bool ImageData::read(string_t filename) {
     int nv = -1;
     int np = 0;
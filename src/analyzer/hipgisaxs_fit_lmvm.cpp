@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #include <analyzer/hipgisaxs_fit_lmvm.hpp>
 
@@ -36,13 +37,29 @@ namespace hig {
   // context for lmvm
   typedef struct {
     ObjectiveFunction* obj_func_;
+    ObjectiveFunctionPool* pool_;
     std::vector<hig::real_t> psteps_;
+    std::vector<std::pair<hig::real_t, hig::real_t> > plimits_;
+    bool one_sided_;
   } lmvm_ctx_t;
 
 
   bool FitLMVMAlgo::run(int argc, char **argv, int algo_num, int img_num) {
 
-    if(!(*obj_func_).set_reference_data(img_num)) return false;
+    // the 2n + 1 (n + 1 one-sided) evaluations of a gradient are run as one batch, on up to
+    // lmvm_num_threads simulations
+    real_t temp_val = 0.0;
+    bool one_sided = false;
+    unsigned int num_threads = 1, sim_num_threads = 0;
+    if((*obj_func_).analysis_algo_param(algo_num, "lmvm_one_sided", temp_val))
+      one_sided = (temp_val > 0.5);
+    if((*obj_func_).analysis_algo_param(algo_num, "lmvm_num_threads", temp_val))
+      num_threads = std::max((int) temp_val, 1);
+    if((*obj_func_).analysis_algo_param(algo_num, "lmvm_sim_threads", temp_val))
+      sim_num_threads = std::max((int) temp_val, 0);
+    num_threads = std::min(num_threads, (unsigned int) (one_sided ? 1 : 2) * num_params_ + 1);
+    if(!pool_.init(obj_func_, num_threads, sim_num_threads) || !pool_.set_reference_data(img_num))
+      return false;
 
     static char help[] = "** Attempting fitting using LMVM algorithm...";
     std::cout << help << " [ " << img_num << " ]" << std::endl;
@@ -76,10 +93,17 @@ namespace hig {
     real_t reg_init = (*obj_func_).analysis_regularization(algo_num);
     real_t reg_factor = reg_init;
 
+    // coarse-to-fine: each level starts from the solution of the coarser one
+    for(int level = (*obj_func_).num_levels() - 1; level >= 0; -- level) {
+
+    if(!pool_.set_level(level)) { PetscFinalize(); return false; }
+    num_obs_ = (*obj_func_).data_size();
+    reg_factor = reg_init;
+
     for(int reg_iter = 0; reg_iter < MAX_ITER_REG_; ++ reg_iter) {
 
     std::cout << "++ Regularization optimization iteration " << reg_iter + 1 << std::endl;
-    (*obj_func_).set_regularization(reg_factor);
+    pool_.set_regularization(reg_factor);
 
     Vec f;            // gradient vector
     PetscReal hist[max_hist_], resid[max_hist_];
@@ -98,7 +122,10 @@ namespace hig {
 
     lmvm_ctx_t ctx;
     ctx.obj_func_ = obj_func_;
+    ctx.pool_ = &pool_;
     ctx.psteps_ = psteps_;
+    ctx.plimits_ = plimits_;
+    ctx.one_sided_ = one_sided;
 
     //ierr = TaoSetObjectiveAndGradientRoutine(tao, HipGISAXSFormFunctionGradient, obj_func_);
     ierr = TaoSetObjectiveAndGradientRoutine(tao, HipGISAXSFormFunctionGradient, (void*) &ctx);
@@ -172,6 +199,8 @@ namespace hig {
 
     } // for reg_iter
 
+    } // for level
+
     ierr = VecDestroy(&x0);
     ierr = VecDestroy(&xmin);
     ierr = VecDestroy(&xmax);
@@ -190,9 +219,8 @@ namespace hig {
   PetscErrorCode HipGISAXSFormFunctionGradient(Tao tao, Vec X, PetscReal *f, Vec G, void *ptr) {
     lmvm_ctx_t* ctx = (lmvm_ctx_t*) ptr;
     PetscInt i, j, size;
-    PetscReal fxp, fxm, dx = 0.04;
+    PetscReal dx = 0.04;
     PetscReal *x, *g;
-    real_vec_t xvec, xpvec, xmvec;
     PetscErrorCode ierr;
 
     /* Get pointers to vector data */
@@ -200,20 +228,56 @@ namespace hig {
     ierr = VecGetArray(G, &g);
     ierr = VecGetSize(X, &size);
 
-    /* Compute Objective Funtion at X */
-    for(i = 0; i < size; ++ i) xvec.push_back(x[i]);
-    *f = EvaluateFunction(tao, xvec, ctx->obj_func_);
-
-    /* Evaluate gradients */
+    /* The batch: X, followed by X + h e_i and X - h e_i for each parameter i, with the
+     * step h = pstep / 2. One-sided, only one of them with h = pstep: forward, backward when
+     * forward would leave the parameter bounds, and a central difference clamped to the
+     * bounds when both would */
+    std::vector<real_vec_t> batch(1, real_vec_t(x, x + size));
+    std::vector<real_t> steps;
+    std::vector<std::pair<int, int> > points;   // batch indices of the difference for each i
     for(i = 0; i < size; ++ i) {
-      xpvec = xmvec = xvec;
       real_t pstep = ctx->psteps_[i];
       pstep = (pstep > TINY_) ? pstep : dx;
-      xpvec[i] = xvec[i] + 0.5 * pstep;
-      xmvec[i] = xvec[i] - 0.5 * pstep;
-      fxp = EvaluateFunction(tao, xpvec, ctx->obj_func_);
-      fxm = EvaluateFunction(tao, xmvec, ctx->obj_func_);
-      g[i] = (fxp - fxm) / dx;
+      int k = batch.size();
+      if(ctx->one_sided_) {
+        bool bounded = (size_t) i < ctx->plimits_.size();
+        real_t lower = bounded ? ctx->plimits_[i].first : x[i] - pstep;
+        real_t upper = bounded ? ctx->plimits_[i].second : x[i] + pstep;
+        if(x[i] + pstep <= upper) {
+          batch.push_back(batch[0]); batch.back()[i] += pstep;
+          points.push_back(std::make_pair(k, 0)); steps.push_back(pstep);
+        } else if(x[i] - pstep >= lower) {
+          batch.push_back(batch[0]); batch.back()[i] -= pstep;
+          points.push_back(std::make_pair(0, k)); steps.push_back(pstep);
+        } else {
+          real_t hi = std::min(x[i] + 0.5 * pstep, upper), lo = std::max(x[i] - 0.5 * pstep, lower);
+          batch.push_back(batch[0]); batch.back()[i] = hi;
+          batch.push_back(batch[0]); batch.back()[i] = lo;
+          points.push_back(std::make_pair(k, k + 1)); steps.push_back(hi - lo);
+        } // if-else
+      } else {
+        batch.push_back(batch[0]); batch.back()[i] += 0.5 * pstep;
+        batch.push_back(batch[0]); batch.back()[i] -= 0.5 * pstep;
+        points.push_back(std::make_pair(k, k + 1)); steps.push_back(pstep);
+      } // if-else
+    } // for
+    ierr = VecRestoreArray(X, &x);
+
+    std::cout << "++ [lmvm] evaluating objective function and gradient [ " << batch.size()
+              << " evaluations ]..." << std::endl;
+    std::vector<real_vec_t> dist;
+    if(!ctx->pool_->evaluate(batch, dist, true)) {
+      ierr = VecRestoreArray(G, &g);
+      return 1;
+    } // if
+    *f = dist[0][0];
+    std::cout << "** [lmvm] distance = " << *f << std::endl;
+
+    /* Evaluate gradients */
+    for(i = 0; i < size; ++ i) {
+      // a parameter pinned by its bounds has no gradient
+      if(steps[i] > 0) g[i] = (dist[points[i].first][0] - dist[points[i].second][0]) / steps[i];
+      else g[i] = 0.0;
     } // for
 
     /* Restore vectors */
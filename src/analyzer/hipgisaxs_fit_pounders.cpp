@@ -168,108 +168,117 @@ namespace hig {
     real_t reg_init = (*obj_func_).analysis_regularization(algo_num);
     real_t reg_factor = reg_init;
 
-    for(int reg_iter = 0; reg_iter < MAX_ITER_REG_; ++ reg_iter) {
+    // coarse-to-fine: each level starts from the solution of the coarser one
+    for(int level = (*obj_func_).num_levels() - 1; level >= 0; -- level) {
+
+      if(!(*obj_func_).set_level(level)) { PetscFinalize(); return false; }
+      num_obs_ = (*obj_func_).data_size();
+      reg_factor = reg_init;
+
+      for(int reg_iter = 0; reg_iter < MAX_ITER_REG_; ++ reg_iter) {
+
+        std::cout << "++ Regularization optimization iteration " << reg_iter + 1 << std::endl;
 
-      std::cout << "++ Regularization optimization iteration " << reg_iter + 1 << std::endl;
+        (*obj_func_).set_regularization(reg_factor);
 
-      (*obj_func_).set_regularization(reg_factor);
+        Vec f;
+        PetscReal hist[max_hist_], resid[max_hist_];
+        PetscInt nhist = max_hist_;
 
-      Vec f;
-      PetscReal hist[max_hist_], resid[max_hist_];
-      PetscInt nhist = max_hist_;
+        Tao tao;
+        TaoConvergedReason reason;
 
-      Tao tao;
-      TaoConvergedReason reason;
+        // allocate vectors
+        ierr = VecCreateSeq(PETSC_COMM_SELF, num_obs_, &f);
 
-      // allocate vectors
-      ierr = VecCreateSeq(PETSC_COMM_SELF, num_obs_, &f);
+        // create TAO solver with pounders
+        ierr = TaoCreate(PETSC_COMM_SELF, &tao);
+        ierr = TaoSetType(tao, TAOPOUNDERS); CHKERRQ(ierr);
 
-      // create TAO solver with pounders
-      ierr = TaoCreate(PETSC_COMM_SELF, &tao);
-      ierr = TaoSetType(tao, TAOPOUNDERS); CHKERRQ(ierr);
+        // check for command line options
+        ierr = TaoSetFromOptions(tao);
 
-      // check for command line options
-      ierr = TaoSetFromOptions(tao);
+        // set objective function
+        ierr = TaoSetSeparableObjectiveRoutine(tao, f, EvaluateFunction, (void*) obj_func_);
+        // set jacobian function
+        // ierr = TaoSetJacobianRoutine(tao, J, J, EvaluateJacobian, (void*) &user); CHKERRQ(ierr);
 
-      // set objective function
-      ierr = TaoSetSeparableObjectiveRoutine(tao, f, EvaluateFunction, (void*) obj_func_);
-      // set jacobian function
-      // ierr = TaoSetJacobianRoutine(tao, J, J, EvaluateJacobian, (void*) &user); CHKERRQ(ierr);
+        // set the convergence test function
+        ierr = TaoSetConvergenceTest(tao, &convergence_test, NULL);
 
-      // set the convergence test function
-      ierr = TaoSetConvergenceTest(tao, &convergence_test, NULL);
+        TaoSetMaximumIterations(tao, max_iter_);
+        #ifdef PETSC_37
+          ierr = TaoSetConvergenceHistory(tao, hist, resid, NULL, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
+        #elif defined PETSC_36
+          ierr = TaoSetHistory(tao, hist, resid, NULL, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
+        #else
+          ierr = TaoSetHistory(tao, hist, resid, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
+        #endif // PETSC_36
 
-      TaoSetMaximumIterations(tao, max_iter_);
-      #ifdef PETSC_37
-        ierr = TaoSetConvergenceHistory(tao, hist, resid, NULL, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
-      #elif defined PETSC_36
-        ierr = TaoSetHistory(tao, hist, resid, NULL, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
-      #else
-        ierr = TaoSetHistory(tao, hist, resid, NULL, max_hist_, PETSC_TRUE); CHKERRQ(ierr);
-      #endif // PETSC_36
+        std::cout << "++ [pounders] Setting tolerances = " << tol_ << std::endl;
+        #ifdef PETSC_37
+          ierr = TaoSetTolerances(tao, tol_, tol_, tol_); CHKERRQ(ierr);
+        #else
+          ierr = TaoSetTolerances(tao, tol_, tol_, tol_, tol_, tol_); CHKERRQ(ierr);
+        #endif
 
-      std::cout << "++ [pounders] Setting tolerances = " << tol_ << std::endl;
-      #ifdef PETSC_37
-        ierr = TaoSetTolerances(tao, tol_, tol_, tol_); CHKERRQ(ierr);
-      #else
-        ierr = TaoSetTolerances(tao, tol_, tol_, tol_, tol_, tol_); CHKERRQ(ierr);
-      #endif
+        ierr = TaoSetVariableBounds(tao, xmin, xmax); CHKERRQ(ierr);
 
-      ierr = TaoSetVariableBounds(tao, xmin, xmax); CHKERRQ(ierr);
+        // set the initial parameter vector (initial guess)
+        ierr = TaoSetInitialVector(tao, x0); CHKERRQ(ierr);
 
-      // set the initial parameter vector (initial guess)
-      ierr = TaoSetInitialVector(tao, x0); CHKERRQ(ierr);
+        // perform the solve
+        ierr = TaoSolve(tao); CHKERRQ(ierr);
 
-      // perform the solve
-      ierr = TaoSolve(tao); CHKERRQ(ierr);
+        // temporary, to check the details
+        TaoView(tao, PETSC_VIEWER_STDOUT_SELF);
 
-      // temporary, to check the details
-      TaoView(tao, PETSC_VIEWER_STDOUT_SELF);
+        ierr = TaoGetConvergedReason(tao, &reason);
+        std::cout << "** [pounders] converged reason: " << reason << std::endl;
 
-      ierr = TaoGetConvergedReason(tao, &reason);
-      std::cout << "** [pounders] converged reason: " << reason << std::endl;
+        #if defined PETSC_36 || defined PETSC_37
+          ierr = TaoGetConvergenceHistory(tao, NULL, NULL, NULL, NULL, &nhist); CHKERRQ(ierr);
+        #else
+          TaoGetHistory(tao, 0, 0, 0, &nhist);
+        #endif
 
-      #if defined PETSC_36 || defined PETSC_37
-        ierr = TaoGetConvergenceHistory(tao, NULL, NULL, NULL, NULL, &nhist); CHKERRQ(ierr);
-      #else
-        TaoGetHistory(tao, 0, 0, 0, &nhist);
-      #endif
+        PetscPrintf(PETSC_COMM_WORLD, "** [pounders] history: [ iter\tobj_val\tresidual ]\n");
+        for(int i = 0; i < nhist; ++ i)
+          PetscPrintf(PETSC_COMM_WORLD, ">> \t%d\t%g\t%g\n", i, hist[i], resid[i]);
+
+        PetscInt iterate; // current iterate number
+        PetscReal f_cv,   // current function value
+                  gnorm,  // square of gradient norm (distance)
+                  cnorm,  // infeasibility of current solution w.r.t. constraints
+                  xdiff;  // current trust region step length
+        ierr = TaoGetSolutionStatus(tao, &iterate, &f_cv, &gnorm, &cnorm, &xdiff, &reason);
+        std::cout << "** [pounders] converged reason    : " << reason   << std::endl
+                  << "** [pounders] iterate number      : " << iterate  << std::endl
+                  << "** [pounders] function value      : " << f_cv     << std::endl
+                  << "** [pounders] distance            : " << gnorm    << std::endl
+                  << "** [pounders] infeasibility       : " << cnorm    << std::endl
+                  << "** [pounders] trust region length : " << xdiff    << std::endl;
+
+        // obtain the parameter solution vector
+        TaoGetSolutionVector(tao, &x0); xn_.clear();
+        for(PetscInt j = 0; j < num_params_; ++ j) {
+          VecGetValues(x0, 1, &j, &y);
+          xn_.push_back(y);
+        } // for
+
+        std::cout << "** [pounders] final parameter vector: [ ";
+        for(real_vec_t::iterator i = xn_.begin(); i != xn_.end(); ++ i) std::cout << *i << " ";
+        std::cout << "]" << std::endl;
+
+        ierr = TaoDestroy(&tao);
+        ierr = VecDestroy(&f);
 
-      PetscPrintf(PETSC_COMM_WORLD, "** [pounders] history: [ iter\tobj_val\tresidual ]\n");
-      for(int i = 0; i < nhist; ++ i)
-        PetscPrintf(PETSC_COMM_WORLD, ">> \t%d\t%g\t%g\n", i, hist[i], resid[i]);
-
-      PetscInt iterate; // current iterate number
-      PetscReal f_cv,   // current function value
-                gnorm,  // square of gradient norm (distance)
-                cnorm,  // infeasibility of current solution w.r.t. constraints
-                xdiff;  // current trust region step length
-      ierr = TaoGetSolutionStatus(tao, &iterate, &f_cv, &gnorm, &cnorm, &xdiff, &reason);
-      std::cout << "** [pounders] converged reason    : " << reason   << std::endl
-                << "** [pounders] iterate number      : " << iterate  << std::endl
-                << "** [pounders] function value      : " << f_cv     << std::endl
-                << "** [pounders] distance            : " << gnorm    << std::endl
-                << "** [pounders] infeasibility       : " << cnorm    << std::endl
-                << "** [pounders] trust region length : " << xdiff    << std::endl;
-
-      // obtain the parameter solution vector
-      TaoGetSolutionVector(tao, &x0); xn_.clear();
-      for(PetscInt j = 0; j < num_params_; ++ j) {
-        VecGetValues(x0, 1, &j, &y);
-        xn_.push_back(y);
-      } // for
-
-      std::cout << "** [pounders] final parameter vector: [ ";
-      for(real_vec_t::iterator i = xn_.begin(); i != xn_.end(); ++ i) std::cout << *i << " ";
-      std::cout << "]" << std::endl;
-
-      ierr = TaoDestroy(&tao);
-      ierr = VecDestroy(&f);
-
-      reg_factor /= 5.0;
-      if(reg_factor <= TINY_) break;
-
-    } // for reg_iter
+        reg_factor /= 5.0;
+        if(reg_factor <= TINY_) break;
+
+      } // for reg_iter
+
+    } // for level
 
     ierr = VecDestroy(&x0);
     ierr = VecDestroy(&xmin);
@@ -48,6 +48,9 @@ namespace hig {
     // max number of generations
     max_iter_ = ngen;
 
+    num_threads_ = 1;
+    sim_num_threads_ = 0;
+
     init();
   } // ParticleSwarmOptimization::ParticleSwarmOptimization()
 
@@ -109,6 +112,13 @@ namespace hig {
     } else {
       type_ = decode_pso_algo_type(temp_val);
     } // if-else
+    // threads per particle and per simulation. by default the simulation gets all threads
+    num_threads_ = 1;
+    sim_num_threads_ = 0;
+    if((*obj_func_).analysis_algo_param(algo_num, "pso_num_threads", temp_val))
+      num_threads_ = std::max((int) temp_val, 1);
+    if((*obj_func_).analysis_algo_param(algo_num, "pso_sim_threads", temp_val))
+      sim_num_threads_ = std::max((int) temp_val, 0);
 
     init();
   } // ParticleSwarmOptimization::ParticleSwarmOptimization()
@@ -119,6 +129,31 @@ namespace hig {
   } // ParticleSwarmOptimization::~ParticleSwarmOptimization()
 
 
+  /* compute the fitness of all local particles, concurrently when the pool has clones */
+  bool ParticleSwarmOptimization::evaluate_particles(std::vector <real_vec_t>& fitness) {
+    if(pool_.size() > 1) {
+      std::vector <real_vec_t> x;
+      for(int i = 0; i < num_particles_; ++ i) x.push_back(particles_[i].param_values_);
+      // particles differ in all parameters and in cost: balance them dynamically
+      return pool_.evaluate(x, fitness, false);
+    } // if
+    fitness.clear();
+    fitness.resize(num_particles_);
+    for(int i = 0; i < num_particles_; ++ i) {
+      #ifdef USE_MPI
+      if((*multi_node_).is_master(root_comm_))
+      #endif
+        std::cout << "** Particle " << i << std::endl;
+      #ifdef USE_MPI
+        // tell hipgisaxs about the communicator to work with
+        (*obj_func_).update_sim_comm(particle_comm_);
+      #endif
+      fitness[i] = (*obj_func_)(particles_[i].param_values_);
+    } // for
+    return true;
+  } // ParticleSwarmOptimization::evaluate_particles()
+
+
   bool ParticleSwarmOptimization::init() {
     params_ = (*obj_func_).fit_param_keys();
     num_params_ = (*obj_func_).num_fit_params();
@@ -424,19 +459,46 @@ namespace hig {
   } // ParticleSwarmOptimization::get_best_values()
 
 
+  void ParticleSwarmOptimization::reset_best_fitness() {
+    best_fitness_ = std::numeric_limits<real_t>::max();
+    for(unsigned int i = 0; i < num_particles_; ++ i) {
+      particles_[i].best_fitness_ = std::numeric_limits<real_t>::max();
+      particles_[i].best_fitness_global_ = std::numeric_limits<real_t>::max();
+    } // for
+  } // ParticleSwarmOptimization::reset_best_fitness()
+
+
   bool ParticleSwarmOptimization::run(int narg, char** args, int algo_num, int img_num) {
     #ifdef USE_MPI
     if((*multi_node_).is_master(root_comm_))
     #endif
       std::cout << "Running Particle Swarm Optimization ..." << std::endl;
 
-    if(!(*obj_func_).set_reference_data(img_num)) return false;
+    if(!pool_.init(obj_func_, std::min(num_threads_, num_particles_), sim_num_threads_) ||
+       !pool_.set_reference_data(img_num))
+      return false;
 
     woo::BoostChronoTimer gen_timer;
     double total_time = 0;
 
+    // coarse-to-fine: each coarse level runs half of the remaining generations
+    int num_levels = (*obj_func_).num_levels();
+    int level = num_levels - 1, level_end = (level > 0) ? max_iter_ / 2 : max_iter_;
+    if(!pool_.set_level(level)) return false;
+
     for(int gen = 0; gen < max_iter_; ++ gen) {
 
+      if(level > 0 && gen >= level_end) {
+        while(level > 0 && gen >= level_end) {
+          -- level;
+          level_end = (level > 0) ? gen + (max_iter_ - gen) / 2 : max_iter_;
+        } // while
+        if(!pool_.set_level(level)) return false;
+        // the swarm keeps its positions and velocities, but the fitness values are not
+        // comparable across levels
+        reset_best_fitness();
+      } // if
+
       #ifdef USE_MPI
       if((*multi_node_).is_master(root_comm_))
       #endif
@@ -525,22 +587,13 @@ namespace hig {
     myrank = (*multi_node_).rank(root_comm_);
     #endif
 
-    for(int i = 0; i < num_particles_; ++ i) {
+    // compute the fitness
+    std::vector <real_vec_t> fitness;
+    if(!evaluate_particles(fitness)) return false;
 
-      #ifdef USE_MPI
-      if((*multi_node_).is_master(root_comm_))
-      #endif
-        std::cout << "** Particle " << i << std::endl;
-
-      // construct param map
-      real_vec_t curr_particle;
-      for(int j = 0; j < num_params_; ++ j) curr_particle.push_back(particles_[i].param_values_[j]);
-
-      // tell hipgisaxs about the communicator to work with
-      (*obj_func_).update_sim_comm(particle_comm_);
+    for(int i = 0; i < num_particles_; ++ i) {
 
-      // compute the fitness
-      real_vec_t curr_fitness = (*obj_func_)(curr_particle);
+      const real_vec_t& curr_fitness = fitness[i];
 
       // update particle fitness
       // this is meaningful only at the particle masters
@@ -9,11 +9,111 @@
 
 #include <iostream>
 #include <map>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <analyzer/objective_func.hpp>
 
 namespace hig {
 
+  bool ObjectiveFunctionPool::init(ObjectiveFunction* obj_func, unsigned int num,
+                                   unsigned int sim_num_threads) {
+    if(obj_func == obj_func_ && num == size()) return true;
+    clear();
+    obj_func_ = obj_func;
+    if(num < 2) return true;
+    #ifndef _OPENMP
+      std::cerr << "warning: built without OpenMP. evaluating sequentially" << std::endl;
+      return true;
+    #else
+      for(unsigned int t = 1; t < num; ++ t) {
+        ObjectiveFunction* f = (*obj_func_).clone();
+        if(f == NULL) {
+          std::cerr << "warning: objective function can not be cloned. evaluating sequentially"
+                    << std::endl;
+          clear();
+          obj_func_ = obj_func;
+          return true;
+        } // if
+        clones_.push_back(f);
+      } // for
+      sim_num_threads_ = (sim_num_threads > 0) ? sim_num_threads :
+                          std::max(omp_get_max_threads() / (int) num, 1);
+      // the simulations run their own parallel regions inside the pool threads
+      omp_set_max_active_levels(2);
+      std::cout << "** Evaluating " << num << " parameter vectors concurrently, with "
+                << sim_num_threads_ << " threads each" << std::endl;
+      return true;
+    #endif
+  } // ObjectiveFunctionPool::init()
+
+
+  void ObjectiveFunctionPool::clear() {
+    for(unsigned int t = 0; t < clones_.size(); ++ t) delete clones_[t];
+    clones_.clear();
+    obj_func_ = NULL;
+    sim_num_threads_ = 0;
+  } // ObjectiveFunctionPool::clear()
+
+
+  bool ObjectiveFunctionPool::set_reference_data(int i) {
+    if(!(*obj_func_).set_reference_data(i)) return false;
+    for(unsigned int t = 0; t < clones_.size(); ++ t)
+      if(!(*clones_[t]).set_reference_data(i)) return false;
+    return true;
+  } // ObjectiveFunctionPool::set_reference_data()
+
+
+  bool ObjectiveFunctionPool::set_level(int l) {
+    if(!(*obj_func_).set_level(l)) return false;
+    for(unsigned int t = 0; t < clones_.size(); ++ t)
+      if(!(*clones_[t]).set_level(l)) return false;
+    return true;
+  } // ObjectiveFunctionPool::set_level()
+
+
+  bool ObjectiveFunctionPool::set_regularization(real_t r) {
+    (*obj_func_).set_regularization(r);
+    for(unsigned int t = 0; t < clones_.size(); ++ t) (*clones_[t]).set_regularization(r);
+    return true;
+  } // ObjectiveFunctionPool::set_regularization()
+
+
+  bool ObjectiveFunctionPool::evaluate(const std::vector <real_vec_t>& x,
+                                       std::vector <real_vec_t>& fx, bool contiguous) {
+    fx.clear();
+    fx.resize(x.size());
+    if(clones_.empty()) {
+      for(unsigned int i = 0; i < x.size(); ++ i) fx[i] = (*obj_func_)(x[i]);
+      return true;
+    } // if
+    #ifdef _OPENMP
+      const unsigned int num = size(), n = x.size();
+      #pragma omp parallel num_threads(num)
+      {
+        unsigned int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        omp_set_num_threads(sim_num_threads_);
+        ObjectiveFunction* f = (t == 0) ? obj_func_ : clones_[t - 1];
+        if(contiguous) {
+          for(unsigned int i = t * n / nt; i < (t + 1) * n / nt; ++ i) fx[i] = (*f)(x[i]);
+        } else {
+          #pragma omp for schedule(dynamic)
+          for(int i = 0; i < (int) n; ++ i) fx[i] = (*f)(x[i]);
+        } // if-else
+      }
+    #endif
+    for(unsigned int i = 0; i < fx.size(); ++ i) {
+      if(fx[i].empty()) {
+        std::cerr << "error: objective function evaluation " << i << " failed" << std::endl;
+        return false;
+      } // if
+    } // for
+    return true;
+  } // ObjectiveFunctionPool::evaluate()
+
+
   /* evaluate function used in pounders */
   //PetscErrorCode EvaluateFunction(TaoSolver tao, Vec X, Vec F, void *ptr) {
   PetscErrorCode EvaluateFunction(Tao tao, Vec X, Vec F, void* ptr) {
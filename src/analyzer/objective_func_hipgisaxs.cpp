@@ -9,15 +9,17 @@
 
 #include <iostream>
 #include <map>
+#include <algorithm>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 #include <analyzer/objective_func_hipgisaxs.hpp>
 #include <file/edf_reader.hpp>
+#include <file/raw_data.hpp>
 
 namespace hig {
 
   HipGISAXSObjectiveFunction::HipGISAXSObjectiveFunction(int narg, char** args, DistanceMeasure* d) :
-      hipgisaxs_(narg, args) {
+      hipgisaxs_(narg, args), narg_(narg), args_(args), config_(args[1]) {
     if(!hipgisaxs_.construct_input(args[1])) {
       std::cerr << "error: failed to construct HipGISAXS input containers" << std::endl;
       exit(1);
@@ -36,6 +38,8 @@ namespace hig {
     mask_data_.clear();
     mask_set_ = false;
     pdist_ = d;
+    ref_index_ = -1;
+    level_ = 0;
 
     reg_alpha_ = 0.0;
 
@@ -45,7 +49,7 @@ namespace hig {
 
 
   HipGISAXSObjectiveFunction::HipGISAXSObjectiveFunction(int narg, char** args, std::string config) :
-      hipgisaxs_(narg, args) {
+      hipgisaxs_(narg, args), narg_(narg), args_(args), config_(config) {
     if(!hipgisaxs_.construct_input(config.c_str())) {
       std::cerr << "error: failed to construct HipGISAXS input containers" << std::endl;
       exit(1);
@@ -64,6 +68,8 @@ namespace hig {
     mask_data_.clear();
     mask_set_ = false;
     pdist_ = NULL;
+    ref_index_ = -1;
+    level_ = 0;
 
     reg_alpha_ = 0.0;
 
@@ -78,6 +84,23 @@ namespace hig {
   } // HipGISAXSObjectiveFunction::~HipGISAXSObjectiveFunction()
 
 
+  /**
+   * a new objective function on the same input, with its own simulation. the distance
+   * measure is shared. the reference data is not set
+   */
+  ObjectiveFunction* HipGISAXSObjectiveFunction::clone() const {
+    #ifdef USE_MPI
+      // a second simulation object would initialize MPI again
+      return NULL;
+    #else
+      HipGISAXSObjectiveFunction* f = new HipGISAXSObjectiveFunction(narg_, args_, config_);
+      f->pdist_ = pdist_;
+      f->reg_alpha_ = reg_alpha_;
+      return f;
+    #endif
+  } // HipGISAXSObjectiveFunction::clone()
+
+
   bool HipGISAXSObjectiveFunction::set_distance_measure(DistanceMeasure* dist) {
     pdist_ = dist;
     return true;
@@ -107,6 +130,8 @@ namespace hig {
     if(ext.compare(std::string("DAT")) == 0) return reference_file_ascii;
     if(ext.compare(std::string("out")) == 0) return reference_file_ascii;
     if(ext.compare(std::string("OUT")) == 0) return reference_file_ascii;
+    if(ext.compare(std::string("hgr")) == 0) return reference_file_raw;
+    if(ext.compare(std::string("HGR")) == 0) return reference_file_raw;
     return reference_file_error;
   } // get_reference_file_type()
 
@@ -116,9 +141,10 @@ namespace hig {
       if(ref_data_ != NULL) delete ref_data_;
       std::string ref_filename = hipgisaxs_.reference_data_path(i);
       ReferenceFileType ref_type = get_reference_file_type(ref_filename);
-      real_t* temp_data = NULL;
+      const real_t* temp_data = NULL;
       unsigned int temp_n_par = 0, temp_n_ver = 0;
       EDFReader* edfreader = NULL;
+      RawDataFile rawfile;
       switch(ref_type) {
         case reference_file_ascii:
           ref_data_ = new ImageData(ref_filename);
@@ -132,6 +158,17 @@ namespace hig {
           delete edfreader;
           break;
 
+        case reference_file_raw:
+          // the mapped payload is copied once, in bulk, into the image data
+          if(!rawfile.open(ref_filename) || rawfile.ndims() != 2) {
+            std::cerr << "error: reference data file is not a raw 2D image" << std::endl;
+            return false;
+          } // if
+          ref_data_ = new ImageData();
+          if(!ref_data_->set_data(rawfile)) return false;
+          rawfile.close();
+          break;
+
         case reference_file_null:
         case reference_file_error:
         default:
@@ -164,15 +201,116 @@ namespace hig {
                   << std::endl;
         return false;
       } // if
+
+      // with line cuts, only the masked pixels on the cuts are compared
+      std::vector<unsigned int> rows, cols;
+      unsigned int width = 0;
+      if(hipgisaxs_.reference_data_linecuts(i, rows, cols, width)) {
+        mask_line_cuts(rows, cols, width);
+        mask_set_ = true;
+      } // if
+      // the other pixels do not need to be simulated
+      if(hipgisaxs_.reference_data_sparse(i) && !hipgisaxs_.select_pixels(mask_data_)) return false;
     } // if
     if(!mask_set_) {
       mask_data_.clear();
       mask_data_.resize(n_par_ * n_ver_, 1);
     } // if
+    levels_.clear();
+    ref_index_ = i; level_ = 0;
+    if(i >= 0 && hipgisaxs_.reference_data_levels(i) > 1)
+      return build_levels(hipgisaxs_.reference_data_levels(i));
     return true;
   } // HipGISAXSObjectiveFunction::set_reference_data()
 
 
+  /**
+   * build the coarse levels of the reference data and the mask. each level bins 2 x 2 pixels
+   * of the previous one into their masked mean, and masks the bins without masked pixels
+   */
+  bool HipGISAXSObjectiveFunction::build_levels(unsigned int num) {
+    const unsigned int MIN_LEVEL_SIZE = 16;
+    levels_.resize(1);
+    levels_[0].n_par_ = n_par_; levels_[0].n_ver_ = n_ver_;
+    levels_[0].data_.assign(ref_data_->data(), ref_data_->data() + n_par_ * n_ver_);
+    levels_[0].mask_ = mask_data_;
+    while(levels_.size() < num) {
+      const level_t& fine = levels_.back();
+      unsigned int np = fine.n_par_ / 2, nv = fine.n_ver_ / 2;
+      if(np < MIN_LEVEL_SIZE || nv < MIN_LEVEL_SIZE) {
+        std::cerr << "warning: reference data too small for " << num << " levels. using "
+                  << levels_.size() << std::endl;
+        break;
+      } // if
+      level_t coarse;
+      coarse.n_par_ = np; coarse.n_ver_ = nv;
+      coarse.data_.resize(np * nv);
+      coarse.mask_.resize(np * nv);
+      for(unsigned int y = 0; y < nv; ++ y) {
+        for(unsigned int x = 0; x < np; ++ x) {
+          real_t sum = 0.0, msum = 0.0;
+          unsigned int count = 0;
+          for(unsigned int j = 0; j < 2; ++ j) {
+            for(unsigned int k = 0; k < 2; ++ k) {
+              unsigned int f = (2 * y + j) * fine.n_par_ + 2 * x + k;
+              sum += fine.data_[f];
+              if(fine.mask_[f]) { msum += fine.data_[f]; ++ count; }
+            } // for
+          } // for
+          coarse.data_[y * np + x] = count ? msum / count : sum / 4;
+          coarse.mask_[y * np + x] = count ? 1 : 0;
+        } // for
+      } // for
+      levels_.push_back(coarse);
+    } // while
+    if(levels_.size() < 2) levels_.clear();
+    return true;
+  } // HipGISAXSObjectiveFunction::build_levels()
+
+
+  /* switch the reference data, the mask and the simulated q-grid to the given level */
+  bool HipGISAXSObjectiveFunction::set_level(int l) {
+    if(levels_.empty() || l == level_) return true;
+    if(l < 0 || (unsigned int) l >= levels_.size()) {
+      std::cerr << "error: invalid reference data level " << l << std::endl;
+      return false;
+    } // if
+    const level_t& level = levels_[l];
+    if(!hipgisaxs_.override_qregion(levels_[0].n_par_, levels_[0].n_ver_, ref_index_, 1 << l))
+      return false;
+    n_par_ = level.n_par_; n_ver_ = level.n_ver_;
+    ref_data_->set_data(&level.data_[0], n_par_, n_ver_);
+    mask_data_ = level.mask_;
+    if(hipgisaxs_.reference_data_sparse(ref_index_) && !hipgisaxs_.select_pixels(mask_data_))
+      return false;
+    level_ = l;
+    std::cout << "-- Reference data level " << l << ": " << n_par_ << " x " << n_ver_
+              << std::endl;
+    return true;
+  } // HipGISAXSObjectiveFunction::set_level()
+
+
+  /* clear the mask outside of the given rows and columns, widened by width on each side */
+  void HipGISAXSObjectiveFunction::mask_line_cuts(const std::vector<unsigned int>& rows,
+                                                  const std::vector<unsigned int>& cols,
+                                                  unsigned int width) {
+    std::vector<unsigned char> on_cut(n_par_ * n_ver_, 0);
+    for(unsigned int r = 0; r < rows.size(); ++ r) {
+      unsigned int lo = (rows[r] > width) ? rows[r] - width : 0;
+      unsigned int hi = std::min(n_ver_, rows[r] + width + 1);
+      for(unsigned int y = lo; y < hi; ++ y)
+        std::fill(on_cut.begin() + y * n_par_, on_cut.begin() + (y + 1) * n_par_, 1);
+    } // for
+    for(unsigned int c = 0; c < cols.size(); ++ c) {
+      unsigned int lo = (cols[c] > width) ? cols[c] - width : 0;
+      unsigned int hi = std::min(n_par_, cols[c] + width + 1);
+      for(unsigned int y = 0; y < n_ver_; ++ y)
+        for(unsigned int x = lo; x < hi; ++ x) on_cut[y * n_par_ + x] = 1;
+    } // for
+    for(unsigned int k = 0; k < mask_data_.size(); ++ k) if(!on_cut[k]) mask_data_[k] = 0;
+  } // HipGISAXSObjectiveFunction::mask_line_cuts()
+
+
   bool HipGISAXSObjectiveFunction::read_mask_data(string_t filename) {
     mask_data_.clear();
     if(filename.empty()) {
@@ -205,14 +343,14 @@ namespace hig {
     } // if
     //std::cout << "-- Reading mask data from " << filename << "..." << std::endl;
     EDFReader* edfreader = new EDFReader(filename.c_str());
-    real_t* temp_data = NULL;
+    const real_t* temp_data = NULL;
     unsigned int temp_n_par = 0, temp_n_ver = 0;
     edfreader->get_data(temp_data, temp_n_par, temp_n_ver);
     if(temp_data == NULL) {
       std::cerr << "error: failed to get edf mask data" << std::endl;
       return false;
     } // if
-    for(unsigned int i = 0; i < temp_n_par * temp_n_ver; ++ i) mask_data_.push_back(temp_data[i]);
+    mask_data_.assign(temp_data, temp_data + temp_n_par * temp_n_ver);
     mask_set_ = true;
     delete edfreader;
     return true;
@@ -321,11 +459,15 @@ namespace hig {
       std::stringstream cfilename;
       cfilename << "distance." << myrank << ".dat";
       std::string prefix(hipgisaxs_.path() + "/" + hipgisaxs_.runname());
-      std::ofstream out(prefix + "/" + cfilename.str(), std::ios::app);
-      out.precision(10);
-      for(real_vec_t::const_iterator i = curr_dist.begin(); i != curr_dist.end(); ++ i) out << *i << " ";
-      out << std::endl;
-      out.close();
+      // clones evaluated concurrently append to the same file
+      #pragma omp critical (distance_file)
+      {
+        std::ofstream out(prefix + "/" + cfilename.str(), std::ios::app);
+        out.precision(10);
+        for(real_vec_t::const_iterator i = curr_dist.begin(); i != curr_dist.end(); ++ i) out << *i << " ";
+        out << std::endl;
+        out.close();
+      }
     } // if
 
     return curr_dist;
@@ -289,6 +289,10 @@ namespace hig {
           case compute_outregion_token:  // nothing to do :-/
           case compute_token:  // nothing to do :-/
           case compute_structcorr_token:  // nothing to do :-/
+          case compute_trianglemethod_token:  // nothing to do :-/
+          case compute_triangletol_token:  // nothing to do :-/
+          case compute_densitypad_token:  // nothing to do :-/
+          case compute_outputformat_token:  // nothing to do :-/
           case compute_saveff_token:  // nothing to do :-/
           case compute_savesf_token:  // nothing to do :-/
           case hipgisaxs_token:  // nothing to do :-/
@@ -588,6 +592,14 @@ namespace hig {
             reference_data_[0].region_max(curr_vector_[0], curr_vector_[1]);
             break;
 
+          case fit_reference_data_rowcuts_token:
+            reference_data_[0].row_cuts(curr_vector_);
+            break;
+
+          case fit_reference_data_colcuts_token:
+            reference_data_[0].col_cuts(curr_vector_);
+            break;
+
           default:
             std::cerr << "error: found array value in place of non-array type" << std::endl;
             return false;
@@ -818,6 +830,10 @@ namespace hig {
       case compute_outregion_maxpoint_token:
       case compute_outregion_minpoint_token:
       case compute_structcorr_token:
+      case compute_trianglemethod_token:
+      case compute_triangletol_token:
+      case compute_densitypad_token:
+      case compute_outputformat_token:
       case compute_palette_token:
       case compute_saveff_token:
       case compute_savesf_token:
@@ -836,6 +852,7 @@ namespace hig {
       case instrument_scatter_coherence_token:
       case instrument_scatter_spotarea_token:
       case instrument_scatter_smearing_token:
+      case instrument_scatter_psf_token:
         break;
 
       case instrument_detector_token:
@@ -865,6 +882,11 @@ namespace hig {
       case fit_reference_data_npoints_token:
       case fit_reference_data_npoints_parallel_token:
       case fit_reference_data_npoints_perpendicular_token:
+      case fit_reference_data_rowcuts_token:
+      case fit_reference_data_colcuts_token:
+      case fit_reference_data_cutwidth_token:
+      case fit_reference_data_sparse_token:
+      case fit_reference_data_levels_token:
         break;
 
       case fit_algorithm_token:
@@ -1395,6 +1417,22 @@ namespace hig {
         compute_.nslices(num);
         break;
 
+      case compute_triangletol_token:
+        if(num <= 0) {
+          std::cerr << "error: triangle tolerance must be positive" << std::endl;
+          return false;
+        } // if
+        compute_.triangle_tolerance(num);
+        break;
+
+      case compute_densitypad_token:
+        if(num < 1) {
+          std::cerr << "error: density padding must be at least 1" << std::endl;
+          return false;
+        } // if
+        compute_.density_padding(num);
+        break;
+
 
       case instrument_scatter_photon_value_token:
         scattering_.photon_value(num);
@@ -1461,6 +1499,27 @@ namespace hig {
         reference_data_[0].npoints_perpendicular(num);
         break;
 
+      case fit_reference_data_rowcuts_token:
+      case fit_reference_data_colcuts_token:
+        if(num < 0) {
+          std::cerr << "error: line cut pixel index cannot be negative" << std::endl;
+          return false;
+        } // if
+        curr_vector_.push_back(num);
+        break;
+
+      case fit_reference_data_cutwidth_token:
+        reference_data_[0].cut_width(num);
+        break;
+
+      case fit_reference_data_levels_token:
+        if(num < 1) {
+          std::cerr << "error: number of reference data levels should be at least 1" << std::endl;
+          return false;
+        } // if
+        reference_data_[0].levels(num);
+        break;
+
       case fit_algorithm_order_token:
         curr_fit_algo_.order(num);
         break;
@@ -1720,6 +1779,10 @@ namespace hig {
         scattering_.polarization(str);
         break;
 
+      case instrument_scatter_psf_token:
+        scattering_.psf(str);
+        break;
+
       case instrument_detector_origin_token:
         detector_.origin(str);
         break;
@@ -1744,6 +1807,22 @@ namespace hig {
         compute_.palette(str);
         break;
 
+      case compute_trianglemethod_token:
+        compute_.triangle_method(TokenMapper::instance().get_triangle_method_type(str));
+        if(compute_.triangle_method() == triangle_method_error) {
+          std::cerr << "error: invalid triangle method '" << str << "'" << std::endl;
+          return false;
+        } // if
+        break;
+
+      case compute_outputformat_token:
+        compute_.output_format(TokenMapper::instance().get_output_format_type(str));
+        if(compute_.output_format() == output_format_error) {
+          std::cerr << "error: invalid output format '" << str << "'" << std::endl;
+          return false;
+        } // if
+        break;
+
       case compute_saveff_token:
         compute_.saveff(TokenMapper::instance().get_boolean(str));
         break;
@@ -1764,6 +1843,10 @@ namespace hig {
         reference_data_[0].mask(str);    // TODO ...
         break;
 
+      case fit_reference_data_sparse_token:
+        reference_data_[0].sparse(TokenMapper::instance().get_boolean(str));
+        break;
+
       case fit_algorithm_name_token:
         curr_fit_algo_.name(TokenMapper::instance().get_fit_algorithm_name(str));
         curr_fit_algo_.name_str(str);
@@ -2209,6 +2292,15 @@ namespace hig {
 
       case shape_custom:
         shape_filename = shape.filename();
+        if(shape_filetype(shape_filename.c_str()) == shape_file_density
+            #ifdef USE_PARALLEL_HDF5
+              || (shape_filetype(shape_filename.c_str()) == shape_file_hdf5 &&
+                  HiGFileReader::instance().hdf5_is_density(shape_filename.c_str()))
+            #endif
+            ) {
+          if(!compute_density_minmax(shape_filename.c_str(), min_dim, max_dim)) return false;
+          break;
+        } // if
         read_shape_definition(shape_filename.c_str());
         compute_shapedef_minmax(min_dim, max_dim);
         break;
@@ -2309,6 +2401,33 @@ namespace hig {
   } // HiGInput::compute_shapedef_minmax()
 
 
+  /**
+   * extent of a density grid shape, which is centered at the origin
+   */
+  bool HiGInput::compute_density_minmax(const char* filename, vector3_t& min_dim, vector3_t& max_dim) {
+    std::vector<real_t> density;
+    unsigned int dims[3] = { 0, 0, 0 };
+    real_t voxel[3] = { 0., 0., 0. };
+    unsigned int num_voxels = 0;
+    if(shape_filetype(filename) == shape_file_density) {
+      num_voxels = HiGFileReader::instance().raw_density_reader(filename, density, dims, voxel, true);
+    } else {
+      #ifdef USE_PARALLEL_HDF5
+        num_voxels = HiGFileReader::instance().hdf5_density_reader(filename, density, dims, voxel);
+      #endif
+    } // if-else
+    if(num_voxels < 1) {
+      std::cerr << "error: failed to read the density grid '" << filename << "'" << std::endl;
+      return false;
+    } // if
+    for(int i = 0; i < 3; ++ i) {
+      max_dim[i] = dims[i] * voxel[i] / 2.;
+      min_dim[i] = - max_dim[i];
+    } // for
+    return true;
+  } // HiGInput::compute_density_minmax()
+
+
   unsigned int HiGInput::read_shape_definition(const char* shape_file) {
     ShapeFileType file_type = shape_filetype(shape_file);
 
@@ -2354,6 +2473,9 @@ namespace hig {
     if(s.compare("obj") == 0) return shape_file_object;
     if(s.compare("Obj") == 0) return shape_file_object;
     if(s.compare("OBJ") == 0) return shape_file_object;
+    if(s.compare("vox") == 0) return shape_file_density;
+    if(s.compare("Vox") == 0) return shape_file_density;
+    if(s.compare("VOX") == 0) return shape_file_density;
     return shape_file_error;
   } // HiGInput::shape_filetype()
 
@@ -236,6 +236,7 @@ namespace hig {
     }
     if (!scattering["expt"]) scattering_.experiment(std::string("gisaxs"));
     else scattering_.experiment(scattering["expt"].as<std::string>());
+    if (scattering["psf"]) scattering_.psf(scattering["psf"].as<std::string>());
   }
 
   bool YAMLInput::decode_compute_params(){
@@ -254,6 +255,33 @@ namespace hig {
     }
     
     // compute_.method(node["method"].as<std::string>());
+    if (node["trianglemethod"]) {
+      std::string method = node["trianglemethod"].as<std::string>();
+      compute_.triangle_method(TokenMapper::instance().get_triangle_method_type(method));
+      if (compute_.triangle_method() == triangle_method_error) {
+        std::cerr << "error: invalid triangle method '" << method << "'" << std::endl;
+        return false;
+      }
+    }
+    if (node["triangletolerance"]) {
+      compute_.triangle_tolerance(node["triangletolerance"].as<real_t>());
+    }
+    if (node["densitypadding"]) {
+      real_t pad = node["densitypadding"].as<real_t>();
+      if (pad < 1) {
+        std::cerr << "error: density padding must be at least 1" << std::endl;
+        return false;
+      }
+      compute_.density_padding(pad);
+    }
+    if (node["outputformat"]) {
+      std::string format = node["outputformat"].as<std::string>();
+      compute_.output_format(TokenMapper::instance().get_output_format_type(format));
+      if (compute_.output_format() == output_format_error) {
+        std::cerr << "error: invalid output format '" << format << "'" << std::endl;
+        return false;
+      }
+    }
     if (node["output"]) {
       YAML::Node output = node["output"];
       compute_.output_region_type(TokenMapper::instance().get_output_region_type(output["type"].as<std::string>()));
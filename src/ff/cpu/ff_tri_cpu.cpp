@@ -17,6 +17,7 @@
 #include <iostream>
 #include <cmath>
 #include <cstring>
+#include <algorithm>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -43,162 +44,581 @@
   
 namespace hig {
   
-  complex_t FormFactorTriangle(real_t qx, real_t qy, complex_t qz,
-          RotMatrix_t & rot, triangle_t & tri) {
-    complex_t ff = CMPLX_ZERO_;
-    complex_t unitc = CMPLX_ONE_;
-    complex_t n_unitc = CMPLX_MINUS_ONE_;
-
-    // do the rotation
-    std::vector<complex_t> mq = rot.rotate (qx, qy, qz);
-
-    // calculate q^2
-    real_t q_sqr = 0.;
-    for(int i=0; i<3; i++)  q_sqr += std::norm(mq[i]);
-          
-    // form vertices
-    std::vector<vector3_t> vertex;
-    vertex.resize(3);
-    vertex[0] = vector3_t(tri.v1[0], tri.v1[1], tri.v1[2]);
-    vertex[1] = vector3_t(tri.v2[0], tri.v2[1], tri.v2[2]);
-    vertex[2] = vector3_t(tri.v3[0], tri.v3[1], tri.v3[2]);
-
-    // form edges
-    std::vector<vector3_t> edge;
-    edge.resize(3);
-    edge[0] = vertex[1] - vertex[0];
-    edge[1] = vertex[2] - vertex[1];
-    edge[2] = vertex[0] - vertex[2];
-
-
-    // calculate projection of n_t on q
-    vector3_t n_t = cross(edge[0], edge[1]);
-    real_t t_area = 0.5 * n_t.abs();
-    n_t = n_t / n_t.abs();
+  /**
+   * form factor of triangle t of the table for the rotated q-vector mq, with q_sqr = |mq|^2
+   */
+  static inline complex_t FormFactorTriangle(const complex_t* mq, real_t q_sqr,
+                                             const TriangleTable& table, unsigned int t) {
+    const real_t* v[3][3];
+    for(int i = 0; i < 3; ++ i)
+      for(int d = 0; d < 3; ++ d) v[i][d] = table.field(TriangleTable::vertex_ + 3 * i + d);
+    const real_t* n_t = table.field(TriangleTable::normal_);
+    const size_t stride = table.stride();
 
     // dot(q, n_t)
-    complex_t q_dot_nt = CMPLX_ZERO_;
-    for (int i=0; i<3; i++) q_dot_nt += mq[i] * n_t[i];
+    complex_t q_dot_nt = mq[0] * n_t[t] + mq[1] * n_t[t + stride] + mq[2] * n_t[t + 2 * stride];
 
     // proj_tq
     real_t proj_tq = q_sqr - std::norm(q_dot_nt);
 
     // CASE 1
-    if (std::abs(proj_tq) < TINY_){
-        complex_t q_dot_v = CMPLX_ZERO_;
-        for (int i=0; i<3; i++) q_dot_v += mq[i] * tri.v1[i];
-        // calculate form-factor (Case 1)
-        ff = unitc * q_dot_nt * t_area / q_sqr * std::exp(n_unitc * q_dot_v);
-    } else {
-        // iterate of each edge to compute form-factor
-      for (int e = 0; e < 3; e++) {
-
-        // edge-normal
-        vector3_t n_e = cross(edge[e], n_t);
-        n_e = n_e / n_e.abs();
-
-        // dot (q, n_e)
-        complex_t q_dot_ne = CMPLX_ZERO_;
-        for (int i=0; i<3; i++) q_dot_ne += mq[i] * n_e[i];
-
-        // proj_eq
-        real_t proj_eq = proj_tq - std::norm(q_dot_ne);
-        // CASE 2
-        if (std::abs(proj_eq) < TINY_){
-        // q_dot_v
-          complex_t q_dot_v = CMPLX_ZERO_;
-          for (int i=0; i<3; i++) q_dot_v += mq[i] * vertex[e][i];
-          real_t f0 = edge[e].abs() / (q_sqr * proj_tq);
-          complex_t c0 = - q_dot_nt * q_dot_ne;
-          complex_t c1 = std::exp(n_unitc * q_dot_v);
-          ff += f0 * c0 * c1;
-        } else {
-          // CASE 3 (General case)
-          // denominator
-          real_t   f0 = q_sqr * proj_tq * proj_eq;
-
-          // dot(q, v_a) vertex a
-          complex_t q_dot_v = CMPLX_ZERO_;
-          for (int i=0; i<3; i++) q_dot_v += mq[i] * vertex[e][i];
-
-          // vertrex-normal a
-          vector3_t n_v = edge[e] / edge[e].abs();
-
-          // dot(q, n_v)
-          complex_t q_dot_nv = CMPLX_ZERO_;
-          for (int i=0; i<3; i++) q_dot_nv += mq[i] * n_v[i];
-
-          // calculate contribution of vertex a
-          complex_t c0 = n_unitc * q_dot_nt * q_dot_ne * q_dot_nv;
-          complex_t c1 = std::exp(n_unitc * q_dot_v);
-          ff +=  c0 * c1 / f0;
-
-          // dot(q, v) the other vertex in the edge
-          q_dot_v = CMPLX_ZERO_;
-          int ep = (e+1)%3;
-          for (int i=0; i<3; i++) q_dot_v += mq[i] * vertex[ep][i];
-
-          // dot (q, n_v)
-          q_dot_nv = CMPLX_ZERO_;
-          for (int i=0; i<3; i++) q_dot_nv -= mq[i] * n_v[i];
-
-          // calculate contribution of the other vertex
-          c0 = n_unitc * q_dot_nt * q_dot_ne * q_dot_nv;
-          c1 = std::exp(n_unitc * q_dot_v);
-          ff += c0 * c1 / f0;
-        }
-      }
-    }
+    if(std::abs(proj_tq) < TINY_) {
+      complex_t q_dot_v = mq[0] * v[0][0][t] + mq[1] * v[0][1][t] + mq[2] * v[0][2][t];
+      real_t t_area = table.field(TriangleTable::area_)[t];
+      return CMPLX_ONE_ * q_dot_nt * t_area / q_sqr * std::exp(CMPLX_MINUS_ONE_ * q_dot_v);
+    } // if
+
+    complex_t ff = CMPLX_ZERO_;
+    // iterate of each edge to compute form-factor
+    for(int e = 0; e < 3; ++ e) {
+      const real_t* n_e = table.field(TriangleTable::edge_normal_ + 3 * e);
+      const real_t* n_v = table.field(TriangleTable::edge_dir_ + 3 * e);
+      int ep = (e + 1) % 3;
+
+      // dot(q, n_e)
+      complex_t q_dot_ne = mq[0] * n_e[t] + mq[1] * n_e[t + stride] + mq[2] * n_e[t + 2 * stride];
+
+      // proj_eq
+      real_t proj_eq = proj_tq - std::norm(q_dot_ne);
+
+      // dot(q, v_a) vertex a
+      complex_t q_dot_v = mq[0] * v[e][0][t] + mq[1] * v[e][1][t] + mq[2] * v[e][2][t];
+
+      // CASE 2
+      if(std::abs(proj_eq) < TINY_) {
+        real_t f0 = table.field(TriangleTable::edge_len_ + e)[t] / (q_sqr * proj_tq);
+        complex_t c0 = - q_dot_nt * q_dot_ne;
+        ff += f0 * c0 * std::exp(CMPLX_MINUS_ONE_ * q_dot_v);
+      } else {
+        // CASE 3 (General case)
+        real_t f0 = q_sqr * proj_tq * proj_eq;
+
+        // dot(q, n_v), n_v is the vertex-normal of a, and - n_v that of the other vertex b
+        complex_t q_dot_nv = mq[0] * n_v[t] + mq[1] * n_v[t + stride] + mq[2] * n_v[t + 2 * stride];
+        complex_t c0 = CMPLX_ONE_ * q_dot_nt * q_dot_ne * q_dot_nv;
+
+        // dot(q, v_b)
+        complex_t q_dot_vp = mq[0] * v[ep][0][t] + mq[1] * v[ep][1][t] + mq[2] * v[ep][2][t];
+
+        // contributions of vertices a and b
+        ff += c0 * (std::exp(CMPLX_MINUS_ONE_ * q_dot_v) - std::exp(CMPLX_MINUS_ONE_ * q_dot_vp)) / f0;
+      } // if-else
+    } // for
     return ff;
-  }
+  } // FormFactorTriangle()
+
+
+  /**
+   * per-thread work space of the detector based kernels: a tile of rotated q-points, split
+   * into real and imaginary parts, and the partial form factor sums of the tile
+   */
+  typedef struct {
+    real_t qr[3][CPU_TRI_TILE_Q_];
+    real_t qi[3][CPU_TRI_TILE_Q_];
+    real_t q2[CPU_TRI_TILE_Q_];
+    real_t ff_r[CPU_TRI_TILE_Q_];
+    real_t ff_i[CPU_TRI_TILE_Q_];
+    unsigned char special[CPU_TRI_TILE_Q_];
+    real_t err[CPU_TRI_TILE_Q_];      /* error bound of the approximated contributions */
+    // exp(-i q.v) = mag (cos(phase) - i sin(phase)) for the three vertices
+    real_t phase[3][CPU_TRI_TILE_Q_];
+    real_t mag[3][CPU_TRI_TILE_Q_];
+    real_t cos[3][CPU_TRI_TILE_Q_];
+    real_t sin[3][CPU_TRI_TILE_Q_];
+  } tri_tile_t;
+
+
+  static inline void load_tile(tri_tile_t& tile, unsigned int q0, unsigned int nq,
+                               int nqy, const real_t* qx, const real_t* qy, const complex_t* qz,
+                               const RotMatrix_t& rot) {
+    for(unsigned int l = 0; l < nq; ++ l) {
+      unsigned int i_z = q0 + l, i_y = i_z % nqy;
+      complex_t mq[3];
+      rot.rotate(qx[i_y], qy[i_y], qz[i_z], mq[0], mq[1], mq[2]);
+      for(int d = 0; d < 3; ++ d) { tile.qr[d][l] = mq[d].real(); tile.qi[d][l] = mq[d].imag(); }
+      tile.q2[l] = std::norm(mq[0]) + std::norm(mq[1]) + std::norm(mq[2]);
+      tile.ff_r[l] = 0.; tile.ff_i[l] = 0.; tile.err[l] = 0.;
+    } // for
+  } // load_tile()
+
+
+  /**
+   * cos and sin of the first n phases of a tile. these are kept in separate loops, since
+   * compilers merge them into a (scalar) sincos call otherwise, defeating vectorization
+   */
+  static inline void tile_sincos(tri_tile_t& tile, int n, unsigned int nq) {
+    for(int i = 0; i < n; ++ i) {
+      const real_t* phase = tile.phase[i];
+      real_t* c = tile.cos[i];
+      real_t* s = tile.sin[i];
+      #pragma omp simd
+      for(unsigned int l = 0; l < nq; ++ l) c[l] = std::cos(phase[l]);
+      #pragma omp simd
+      for(unsigned int l = 0; l < nq; ++ l) s[l] = std::sin(phase[l]);
+    } // for
+  } // tile_sincos()
+
+
+  /**
+   * add the form factor of triangle t to the partial sums of a tile. the general case is
+   * evaluated across the q-points of the tile in simd lanes, the rare q-points hitting the
+   * special cases (q normal to the face or to an edge) are redone with the scalar kernel
+   */
+  static inline void exact_triangle_tile(const TriangleTable& table, unsigned int t,
+                                         tri_tile_t& tile, unsigned int nq) {
+    real_t n_t[3], v[3][3], n_e[3][3], n_v[3][3];
+    for(int i = 0; i < 3; ++ i) {
+      n_t[i] = table.field(TriangleTable::normal_ + i)[t];
+      for(int d = 0; d < 3; ++ d) {
+        v[i][d] = table.field(TriangleTable::vertex_ + 3 * i + d)[t];
+        n_e[i][d] = table.field(TriangleTable::edge_normal_ + 3 * i + d)[t];
+        n_v[i][d] = table.field(TriangleTable::edge_dir_ + 3 * i + d)[t];
+      } // for
+    } // for
+
+    const real_t *qr0 = tile.qr[0], *qr1 = tile.qr[1], *qr2 = tile.qr[2];
+    const real_t *qi0 = tile.qi[0], *qi1 = tile.qi[1], *qi2 = tile.qi[2], *q2 = tile.q2;
+    real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+    unsigned char* special_l = tile.special;
+
+    // exp(-i q.v) at the three vertices, each is shared by two edges
+    for(int i = 0; i < 3; ++ i) {
+      real_t *phase = tile.phase[i], *mag = tile.mag[i];
+      #pragma omp simd
+      for(unsigned int l = 0; l < nq; ++ l) {
+        phase[l] = qr0[l] * v[i][0] + qr1[l] * v[i][1] + qr2[l] * v[i][2];
+        mag[l] = std::exp(qi0[l] * v[i][0] + qi1[l] * v[i][1] + qi2[l] * v[i][2]);
+      } // for
+    } // for
+    tile_sincos(tile, 3, nq);
+
+    unsigned int num_special = 0;
+    #pragma omp simd reduction(+:num_special)
+    for(unsigned int l = 0; l < nq; ++ l) {
+      real_t q0r = qr0[l], q1r = qr1[l], q2r = qr2[l];
+      real_t q0i = qi0[l], q1i = qi1[l], q2i = qi2[l];
+      real_t q_sqr = q2[l];
+
+      // dot(q, n_t), and proj_tq
+      real_t nt_r = q0r * n_t[0] + q1r * n_t[1] + q2r * n_t[2];
+      real_t nt_i = q0i * n_t[0] + q1i * n_t[1] + q2i * n_t[2];
+      real_t proj_tq = q_sqr - (nt_r * nt_r + nt_i * nt_i);
+      bool special = std::abs(proj_tq) < TINY_;
+
+      real_t ev_r[3], ev_i[3];
+      for(int i = 0; i < 3; ++ i) {
+        ev_r[i] = tile.mag[i][l] * tile.cos[i][l];
+        ev_i[i] = - tile.mag[i][l] * tile.sin[i][l];
+      } // for
+
+      real_t f_r = 0., f_i = 0.;
+      for(int e = 0; e < 3; ++ e) {
+        int ep = (e + 1) % 3;
+        // dot(q, n_e), and proj_eq
+        real_t ne_r = q0r * n_e[e][0] + q1r * n_e[e][1] + q2r * n_e[e][2];
+        real_t ne_i = q0i * n_e[e][0] + q1i * n_e[e][1] + q2i * n_e[e][2];
+        real_t proj_eq = proj_tq - (ne_r * ne_r + ne_i * ne_i);
+        special = special || (std::abs(proj_eq) < TINY_);
+        // dot(q, n_v)
+        real_t nv_r = q0r * n_v[e][0] + q1r * n_v[e][1] + q2r * n_v[e][2];
+        real_t nv_i = q0i * n_v[e][0] + q1i * n_v[e][1] + q2i * n_v[e][2];
+        // p = dot(q, n_t) * dot(q, n_e) * dot(q, n_v), c0 = i p
+        real_t p_r = nt_r * ne_r - nt_i * ne_i, p_i = nt_r * ne_i + nt_i * ne_r;
+        real_t pp_r = p_r * nv_r - p_i * nv_i, pp_i = p_r * nv_i + p_i * nv_r;
+        // c0 * (exp(-i q.v_a) - exp(-i q.v_b)) / (q^2 proj_tq proj_eq)
+        real_t d_r = ev_r[e] - ev_r[ep], d_i = ev_i[e] - ev_i[ep];
+        real_t inv_f0 = 1. / (q_sqr * proj_tq * proj_eq);
+        f_r -= (pp_i * d_r + pp_r * d_i) * inv_f0;
+        f_i -= (pp_i * d_i - pp_r * d_r) * inv_f0;
+      } // for
+
+      special_l[l] = special;
+      num_special += special;
+      ff_r[l] += special ? 0. : f_r;
+      ff_i[l] += special ? 0. : f_i;
+    } // for
+
+    if(num_special == 0) return;
+    for(unsigned int l = 0; l < nq; ++ l) {
+      if(!tile.special[l]) continue;
+      complex_t mq[3];
+      for(int d = 0; d < 3; ++ d) mq[d] = complex_t(tile.qr[d][l], tile.qi[d][l]);
+      complex_t f = FormFactorTriangle(mq, tile.q2[l], table, t);
+      tile.ff_r[l] += f.real();
+      tile.ff_i[l] += f.imag();
+    } // for
+  } // exact_triangle_tile()
+
+
+  /**
+   * add the centroid approximated form factor of a triangle to the partial sums of a tile
+   */
+  static inline void approx_triangle_tile(const real_t* tri, tri_tile_t& tile, unsigned int nq) {
+    real_t s  = tri[0];
+    real_t nx = tri[1], ny = tri[2], nz = tri[3];
+    real_t x  = tri[4], y  = tri[5], z  = tri[6];
+
+    const real_t *qr0 = tile.qr[0], *qr1 = tile.qr[1], *qr2 = tile.qr[2];
+    const real_t *qi0 = tile.qi[0], *qi1 = tile.qi[1], *qi2 = tile.qi[2], *q2 = tile.q2;
+    real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+    real_t *phase = tile.phase[0], *mag = tile.mag[0];
+
+    // s exp(i dot(q, r)) / q^2
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      phase[l] = qr0[l] * x + qr1[l] * y + qr2[l] * z;
+      mag[l] = s * std::exp(- (qi0[l] * x + qi1[l] * y + qi2[l] * z)) / q2[l];
+    } // for
+    tile_sincos(tile, 1, nq);
+
+    const real_t *c = tile.cos[0], *sn = tile.sin[0];
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      // dot(q, n)
+      real_t qn_r = qr0[l] * nx + qr1[l] * ny + qr2[l] * nz;
+      real_t qn_i = qi0[l] * nx + qi1[l] * ny + qi2[l] * nz;
+      // -i dot(q, n) s exp(i dot(q, r)) / q^2
+      real_t c_r = mag[l] * c[l], c_i = mag[l] * sn[l];
+      ff_r[l] += qn_i * c_r + qn_r * c_i;
+      ff_i[l] += qn_i * c_i - qn_r * c_r;
+    } // for
+  } // approx_triangle_tile()
+
+
+  /**
+   * add the centroid approximated form factor of triangle t of the table to the partial sums
+   * of a tile, i dot(q, n) A exp(-i dot(q, c)) / q^2, in the convention of the exact kernel.
+   * with r = |q| radius, the error of the approximated surface integral is bounded by the
+   * second order remainder A |exp(-i dot(q, c))| r^2 exp(r) / 2, which is added to the error
+   * bound of each q-point
+   */
+  static inline void centroid_triangle_tile(const TriangleTable& table, unsigned int t,
+                                            tri_tile_t& tile, unsigned int nq) {
+    real_t n_t[3], c[3];
+    for(int d = 0; d < 3; ++ d) {
+      n_t[d] = table.field(TriangleTable::normal_ + d)[t];
+      c[d] = table.field(TriangleTable::centroid_ + d)[t];
+    } // for
+    real_t area = table.field(TriangleTable::area_)[t];
+    real_t radius = table.field(TriangleTable::radius_)[t];
+
+    const real_t *qr0 = tile.qr[0], *qr1 = tile.qr[1], *qr2 = tile.qr[2];
+    const real_t *qi0 = tile.qi[0], *qi1 = tile.qi[1], *qi2 = tile.qi[2], *q2 = tile.q2;
+    real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i, *err = tile.err;
+    real_t *phase = tile.phase[0], *mag = tile.mag[0];
+
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      phase[l] = qr0[l] * c[0] + qr1[l] * c[1] + qr2[l] * c[2];
+      mag[l] = std::exp(qi0[l] * c[0] + qi1[l] * c[1] + qi2[l] * c[2]);
+    } // for
+    tile_sincos(tile, 1, nq);
+
+    const real_t *cs = tile.cos[0], *sn = tile.sin[0];
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      // dot(q, n_t)
+      real_t qn_r = qr0[l] * n_t[0] + qr1[l] * n_t[1] + qr2[l] * n_t[2];
+      real_t qn_i = qi0[l] * n_t[0] + qi1[l] * n_t[1] + qi2[l] * n_t[2];
+      // i dot(q, n_t) A / q^2 mag (cos - i sin)
+      real_t m = area * mag[l] / q2[l];
+      real_t c_r = m * cs[l], c_i = m * sn[l];
+      ff_r[l] += qn_r * c_i - qn_i * c_r;
+      ff_i[l] += qn_i * c_i + qn_r * c_r;
+      // error bound, |dot(q, n_t)| / q^2 times the bound on the surface integral
+      real_t r = std::sqrt(q2[l]) * radius;
+      err[l] += std::sqrt(qn_r * qn_r + qn_i * qn_i) * m * 0.5 * r * r * std::exp(r);
+    } // for
+  } // centroid_triangle_tile()
+
+
+  /**
+   * add the second order multipole expansion of a cluster of triangles (a node of the
+   * triangle tree) to the partial sums of a tile,
+   *    i / q^2 exp(-i dot(q, C)) [ q_a M0_a - i q_a q_b M1_ab - q_a q_b q_c M2_abc / 2 ],
+   * and with r = |q| R, its truncation error bound A |exp(-i dot(q, C))| r^3 exp(r) / (6 |q|)
+   * to the error bound of each q-point
+   */
+  static inline void cluster_tile(const TriangleTree::node_t& node, tri_tile_t& tile,
+                                  unsigned int nq) {
+    const real_t *c = node.center_, *m0 = node.m0_, *m1 = node.m1_, *m2 = node.m2_;
+    real_t area = node.area_, radius = node.radius_;
+
+    const real_t *qr0 = tile.qr[0], *qr1 = tile.qr[1], *qr2 = tile.qr[2];
+    const real_t *qi0 = tile.qi[0], *qi1 = tile.qi[1], *qi2 = tile.qi[2], *q2 = tile.q2;
+    real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i, *err = tile.err;
+    real_t *phase = tile.phase[0], *mag = tile.mag[0];
+
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      phase[l] = qr0[l] * c[0] + qr1[l] * c[1] + qr2[l] * c[2];
+      mag[l] = std::exp(qi0[l] * c[0] + qi1[l] * c[1] + qi2[l] * c[2]);
+    } // for
+    tile_sincos(tile, 1, nq);
+
+    const real_t *cs = tile.cos[0], *sn = tile.sin[0];
+    #pragma omp simd
+    for(unsigned int l = 0; l < nq; ++ l) {
+      real_t q_r[3] = { qr0[l], qr1[l], qr2[l] }, q_i[3] = { qi0[l], qi1[l], qi2[l] };
+      // s0 = q_a M0_a
+      real_t s0_r = 0., s0_i = 0.;
+      for(int a = 0; a < 3; ++ a) { s0_r += q_r[a] * m0[a]; s0_i += q_i[a] * m0[a]; }
+      // s1 = q_b (q_a M1_ab)
+      real_t s1_r = 0., s1_i = 0.;
+      for(int b = 0; b < 3; ++ b) {
+        real_t p_r = q_r[0] * m1[b] + q_r[1] * m1[3 + b] + q_r[2] * m1[6 + b];
+        real_t p_i = q_i[0] * m1[b] + q_i[1] * m1[3 + b] + q_i[2] * m1[6 + b];
+        s1_r += p_r * q_r[b] - p_i * q_i[b];
+        s1_i += p_r * q_i[b] + p_i * q_r[b];
+      } // for
+      // s2 = q_b q_c (q_a M2_abc), over the symmetric pairs bc
+      real_t s2_r = 0., s2_i = 0.;
+      for(int j = 0; j < 6; ++ j) {
+        const int b = (j < 3) ? 0 : ((j < 5) ? 1 : 2);
+        const int cc = (j < 3) ? j : ((j < 5) ? j - 2 : 2);
+        const real_t w = (b == cc) ? 1. : 2.;
+        real_t p_r = w * (q_r[0] * m2[j] + q_r[1] * m2[6 + j] + q_r[2] * m2[12 + j]);
+        real_t p_i = w * (q_i[0] * m2[j] + q_i[1] * m2[6 + j] + q_i[2] * m2[12 + j]);
+        real_t qq_r = q_r[b] * q_r[cc] - q_i[b] * q_i[cc];
+        real_t qq_i = q_r[b] * q_i[cc] + q_i[b] * q_r[cc];
+        s2_r += p_r * qq_r - p_i * qq_i;
+        s2_i += p_r * qq_i + p_i * qq_r;
+      } // for
+      // S = s0 - i s1 - s2 / 2
+      real_t sr = s0_r + s1_i - 0.5 * s2_r;
+      real_t si = s0_i - s1_r - 0.5 * s2_i;
+      // i S / q^2 mag (cos - i sin)
+      real_t m = mag[l] / q2[l];
+      real_t e_r = m * cs[l], e_i = - m * sn[l];
+      real_t t_r = sr * e_r - si * e_i, t_i = sr * e_i + si * e_r;
+      ff_r[l] -= t_i;
+      ff_i[l] += t_r;
+      real_t q_abs = std::sqrt(q2[l]), r = q_abs * radius;
+      err[l] += area * mag[l] * r * r * r * std::exp(r) / (6. * q_abs);
+    } // for
+  } // cluster_tile()
 
 
   /**
    * Exact integration
    */
   unsigned int NumericFormFactorC::compute_exact_triangle(
-          triangle_t * shape_def, int num_triangles,
+          const TriangleTable & table,
           complex_t* &ff,
           int nqy, real_t * qx, real_t * qy, int nqz, complex_t * qz,
           RotMatrix_t & rot, real_t & compute_time) {
 
+    unsigned int num_triangles = table.size();
     if(num_triangles < 1) return 0;
     unsigned long int total_qpoints = nqz;
   
     // allocate memory for the final FF 3D matrix
-    ff = new (std::nothrow) complex_t[total_qpoints];  // allocate and initialize to 0
-    memset(ff, 0, total_qpoints * sizeof(complex_t));
+    if(ff == NULL) ff = new (std::nothrow) complex_t[total_qpoints];
     if(ff == NULL) {
       std::cerr << "Memory allocation failed for ff. Size = "
             << total_qpoints * sizeof(complex_t) << " b" << std::endl;
       return 0;
     } // if
- 
-    #ifdef DEBUG
-    int n = 10;
-    for (int i_t=0; i_t < num_triangles; i_t++){
-        complex_t foo = FormFactorTriangle(qx[n], qy[n], qz[n], rot, shape_def[i_t]);
-        std::cout << foo << std::endl;
-    }
-    #endif // DEBUG
-   
-#pragma omp parallel for
-    for (int i_z = 0; i_z < nqz; i_z++) {
-        int i_y = i_z % nqy; 
-        complex_t ff_temp = CMPLX_ZERO_;
-        for (int i_t = 0; i_t < num_triangles; i_t++) {
-            ff_temp += FormFactorTriangle (qx[i_y], qy[i_y], qz[i_z], rot, shape_def[i_t]);
-        }
-        ff[i_z] = ff_temp;
-    }
+    const unsigned char* flags = table.flags();
+    int num_tiles = (nqz + CPU_TRI_TILE_Q_ - 1) / CPU_TRI_TILE_Q_;
+
+    woo::BoostChronoTimer timer;
+    timer.start();
+
+    // q-points are processed in tiles, each thread keeps the partial sums of its tile
+    // while streaming over all the (precomputed) triangle descriptors
+    #pragma omp parallel
+    {
+      tri_tile_t tile __attribute__((aligned(64)));
+      #pragma omp for schedule(dynamic)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_TRI_TILE_Q_;
+        unsigned int nq = std::min(CPU_TRI_TILE_Q_, (unsigned int) nqz - q0);
+        load_tile(tile, q0, nq, nqy, qx, qy, qz, rot);
+        for(unsigned int i_t = 0; i_t < num_triangles; ++ i_t) {
+          if(flags[i_t] == TriangleTable::tri_degenerate_) continue;
+          exact_triangle_tile(table, i_t, tile, nq);
+        } // for
+        for(unsigned int l = 0; l < nq; ++ l) ff[q0 + l] = complex_t(tile.ff_r[l], tile.ff_i[l]);
+      } // for
+    } // omp parallel
+
+    timer.stop();
+    compute_time = timer.elapsed_msec();
     return num_triangles;
-  }
+  } // NumericFormFactorC::compute_exact_triangle()
+
+
+  /**
+   * Automatic selection between exact and centroid approximated integration. For each
+   * tile of q-points and cluster of triangles, the approximation is used when
+   * max(|q|) * (cluster radius) is below the given tolerance. The largest estimated error
+   * bound, relative to the largest form factor magnitude, is returned in err_bound, and the
+   * fraction of approximated (tile, triangle) pairs in approx_fraction
+   */
+  unsigned int NumericFormFactorC::compute_auto_triangle(
+          const TriangleTable & table, real_t tol,
+          complex_t* &ff,
+          int nqy, real_t * qx, real_t * qy, int nqz, complex_t * qz,
+          RotMatrix_t & rot, real_t & compute_time, real_t & err_bound,
+          real_t & approx_fraction) {
+
+    unsigned int num_triangles = table.size();
+    if(num_triangles < 1) return 0;
+
+    if(ff == NULL) ff = new (std::nothrow) complex_t[nqz];
+    if(ff == NULL) {
+      std::cerr << "Memory allocation failed for ff. Size = "
+            << nqz * sizeof(complex_t) << " b" << std::endl;
+      return 0;
+    } // if
+    const unsigned char* flags = table.flags();
+    unsigned int num_clusters = table.num_clusters();
+    int num_tiles = (nqz + CPU_TRI_TILE_Q_ - 1) / CPU_TRI_TILE_Q_;
+    real_t max_err = 0., max_ff = 0.;
+    unsigned long int num_approx = 0;
+
+    woo::BoostChronoTimer timer;
+    timer.start();
+
+    #pragma omp parallel
+    {
+      tri_tile_t tile __attribute__((aligned(64)));
+      real_t thread_err = 0., thread_ff = 0.;
+      #pragma omp for schedule(dynamic) reduction(+:num_approx)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_TRI_TILE_Q_;
+        unsigned int nq = std::min(CPU_TRI_TILE_Q_, (unsigned int) nqz - q0);
+        load_tile(tile, q0, nq, nqy, qx, qy, qz, rot);
+        real_t q_max = 0.;
+        for(unsigned int l = 0; l < nq; ++ l) q_max = std::max(q_max, tile.q2[l]);
+        q_max = std::sqrt(q_max);
+
+        for(unsigned int c = 0; c < num_clusters; ++ c) {
+          unsigned int t_end = std::min((c + 1) * TriangleTable::cluster_size_, num_triangles);
+          bool approx = (q_max * table.cluster_radius(c) < tol);
+          if(approx) num_approx += t_end - c * TriangleTable::cluster_size_;
+          for(unsigned int i_t = c * TriangleTable::cluster_size_; i_t < t_end; ++ i_t) {
+            if(flags[i_t] == TriangleTable::tri_degenerate_) continue;
+            if(approx) centroid_triangle_tile(table, i_t, tile, nq);
+            else exact_triangle_tile(table, i_t, tile, nq);
+          } // for
+        } // for
+
+        for(unsigned int l = 0; l < nq; ++ l) {
+          ff[q0 + l] = complex_t(tile.ff_r[l], tile.ff_i[l]);
+          thread_ff = std::max(thread_ff, std::abs(ff[q0 + l]));
+          thread_err = std::max(thread_err, tile.err[l]);
+        } // for
+      } // for
+      #pragma omp critical (ff_tri_auto_err)
+      {
+        max_err = std::max(max_err, thread_err);
+        max_ff = std::max(max_ff, thread_ff);
+      } // omp critical
+    } // omp parallel
+
+    timer.stop();
+    compute_time = timer.elapsed_msec();
+    err_bound = (max_ff > 0.) ? max_err / max_ff : max_err;
+    approx_fraction = (real_t) num_approx / ((real_t) num_triangles * num_tiles);
+    return num_triangles;
+  } // NumericFormFactorC::compute_auto_triangle()
+
+
+  /**
+   * Hierarchical (treecode) integration. For each tile of q-points the triangle tree is
+   * descended from its root: a node is evaluated with its multipole expansion when
+   * max(|q|) * (node radius) is below the given tolerance, the triangles of leaves that are
+   * not are integrated exactly. The table must be built in the triangle order of the tree.
+   * err_bound and approx_fraction are as in compute_auto_triangle
+   */
+  unsigned int NumericFormFactorC::compute_tree_triangle(
+          const TriangleTree & tree, const TriangleTable & table, real_t tol,
+          complex_t* &ff,
+          int nqy, real_t * qx, real_t * qy, int nqz, complex_t * qz,
+          RotMatrix_t & rot, real_t & compute_time, real_t & err_bound,
+          real_t & approx_fraction) {
+
+    unsigned int num_triangles = table.size();
+    if(num_triangles < 1) return 0;
+    if(tree.empty() || tree.node(0).end_ != num_triangles) {
+      std::cerr << "error: triangle tree does not match the triangle table" << std::endl;
+      return 0;
+    } // if
+
+    if(ff == NULL) ff = new (std::nothrow) complex_t[nqz];
+    if(ff == NULL) {
+      std::cerr << "Memory allocation failed for ff. Size = "
+            << nqz * sizeof(complex_t) << " b" << std::endl;
+      return 0;
+    } // if
+    const unsigned char* flags = table.flags();
+    int num_tiles = (nqz + CPU_TRI_TILE_Q_ - 1) / CPU_TRI_TILE_Q_;
+    real_t max_err = 0., max_ff = 0.;
+    unsigned long int num_approx = 0;
+
+    woo::BoostChronoTimer timer;
+    timer.start();
+
+    #pragma omp parallel
+    {
+      tri_tile_t tile __attribute__((aligned(64)));
+      std::vector<int> stack;
+      stack.reserve(8 * tree.depth());
+      real_t thread_err = 0., thread_ff = 0.;
+      #pragma omp for schedule(dynamic) reduction(+:num_approx)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_TRI_TILE_Q_;
+        unsigned int nq = std::min(CPU_TRI_TILE_Q_, (unsigned int) nqz - q0);
+        load_tile(tile, q0, nq, nqy, qx, qy, qz, rot);
+        real_t q_max = 0.;
+        for(unsigned int l = 0; l < nq; ++ l) q_max = std::max(q_max, tile.q2[l]);
+        q_max = std::sqrt(q_max);
+
+        stack.push_back(0);
+        while(!stack.empty()) {
+          const TriangleTree::node_t& node = tree.node(stack.back());
+          stack.pop_back();
+          if(q_max * node.radius_ < tol) {
+            cluster_tile(node, tile, nq);
+            num_approx += node.end_ - node.begin_;
+          } else if(node.num_children_ == 0) {
+            for(unsigned int i_t = node.begin_; i_t < node.end_; ++ i_t) {
+              if(flags[i_t] == TriangleTable::tri_degenerate_) continue;
+              exact_triangle_tile(table, i_t, tile, nq);
+            } // for
+          } else {
+            for(int c = 0; c < node.num_children_; ++ c) stack.push_back(node.first_child_ + c);
+          } // if-else
+        } // while
+
+        for(unsigned int l = 0; l < nq; ++ l) {
+          ff[q0 + l] = complex_t(tile.ff_r[l], tile.ff_i[l]);
+          thread_ff = std::max(thread_ff, std::abs(ff[q0 + l]));
+          thread_err = std::max(thread_err, tile.err[l]);
+        } // for
+      } // for
+      #pragma omp critical (ff_tri_tree_err)
+      {
+        max_err = std::max(max_err, thread_err);
+        max_ff = std::max(max_ff, thread_ff);
+      } // omp critical
+    } // omp parallel
+
+    timer.stop();
+    compute_time = timer.elapsed_msec();
+    err_bound = (max_ff > 0.) ? max_err / max_ff : max_err;
+    approx_fraction = (real_t) num_approx / ((real_t) num_triangles * num_tiles);
+    return num_triangles;
+  } // NumericFormFactorC::compute_tree_triangle()
+
 
   /**
    * Approximated integration
    */
   unsigned int NumericFormFactorC::compute_approx_triangle(
-          real_vec_t &shape_def,
+          const real_vec_t &shape_def,
           complex_t *& ff,
           int nqy, real_t * qx, real_t * qy, 
           int nqz, complex_t * qz, RotMatrix_t & rot, real_t &comp_time){
@@ -211,35 +631,25 @@ namespace hig {
       std::cerr << "Memory allocation failed for ff. Requested size: " << nqz << std::endl;
       return 0;
     }
-    memset(ff, 0, nqz * sizeof(complex_t));
+    int num_tiles = (nqz + CPU_TRI_TILE_Q_ - 1) / CPU_TRI_TILE_Q_;
 
     woo::BoostChronoTimer timer;
     timer.start();
 
-#pragma omp parallel for
-    for (int i_z = 0; i_z < nqz; i_z++){
-      int i_y = i_z % nqy;
-      for (int i_t = 0; i_t < num_triangles; i_t++){
-        int offset = i_t * CPU_T_PROP_SIZE_;
-        real_t s  = shape_def[offset];
-        real_t nx = shape_def[offset + 1];
-        real_t ny = shape_def[offset + 2];
-        real_t nz = shape_def[offset + 3];
-        real_t x  = shape_def[offset + 4];
-        real_t y  = shape_def[offset + 5];
-        real_t z  = shape_def[offset + 6];
-
-        // rotate q-vector
-        std::vector<complex_t> mq = rot.rotate(qx[i_y], qy[i_y], qz[i_z]);
-
-        real_t q2 = std::norm(mq[0]) + std::norm(mq[1]) + std::norm(mq[2]);
-        complex_t qn = mq[0] * nx + mq[1] * ny + mq[2] * nz;
-        complex_t qt = mq[0] * x  + mq[1] * y  + mq[2] * z;
-        complex_t nj = CMPLX_MINUS_ONE_;
-        complex_t np = CMPLX_ONE_;
-        ff[i_z] += (nj * qn * s * std::exp(np * qt) / q2);
-      }
-    }
+    #pragma omp parallel
+    {
+      tri_tile_t tile __attribute__((aligned(64)));
+      #pragma omp for schedule(dynamic)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_TRI_TILE_Q_;
+        unsigned int nq = std::min(CPU_TRI_TILE_Q_, (unsigned int) nqz - q0);
+        load_tile(tile, q0, nq, nqy, qx, qy, qz, rot);
+        for(int i_t = 0; i_t < num_triangles; ++ i_t)
+          approx_triangle_tile(&shape_def[i_t * CPU_T_PROP_SIZE_], tile, nq);
+        for(unsigned int l = 0; l < nq; ++ l) ff[q0 + l] = complex_t(tile.ff_r[l], tile.ff_i[l]);
+      } // for
+    } // omp parallel
+
     timer.stop();
     comp_time = timer.elapsed_msec();
     return num_triangles;
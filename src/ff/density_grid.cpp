@@ -0,0 +1,131 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: density_grid.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include <ff/density_grid.hpp>
+#include <numerics/fft.hpp>
+#include <numerics/numeric_utils.hpp>
+#include <common/constants.hpp>
+
+namespace hig {
+
+  bool DensityGrid::build(const real_t* density, const unsigned int* n, const real_t* voxel,
+                          unsigned int pad) {
+    clear();
+    for(int d = 0; d < 3; ++ d) {
+      if(n[d] < 1 || !(voxel[d] > 0)) {
+        std::cerr << "error: invalid density grid size or voxel size" << std::endl;
+        return false;
+      } // if
+      n_[d] = n[d];
+      voxel_[d] = voxel[d];
+      m_[d] = fft_size(std::max(pad, 1u) * n[d]);
+      dq_[d] = 2. * PI_ / (m_[d] * voxel_[d]);
+    } // for
+
+    size_t num_samples = (size_t) m_[0] * m_[1] * m_[2];
+    samples_.assign(num_samples, CMPLX_ZERO_);
+    for(unsigned int z = 0; z < n_[2]; ++ z)
+      for(unsigned int y = 0; y < n_[1]; ++ y)
+        for(unsigned int x = 0; x < n_[0]; ++ x)
+          samples_[((size_t) z * m_[1] + y) * m_[0] + x] =
+            density[((size_t) z * n_[1] + y) * n_[0] + x];
+    if(!fft_3d(&samples_[0], m_[0], m_[1], m_[2], -1)) { clear(); return false; }
+
+    // shift the origin to the center of the grid, r_j = (j - (n - 1) / 2) d, and scale by
+    // the voxel volume: C(q) = V exp(i q (n - 1) d / 2) dft(q)
+    std::vector<complex_t> shift[3];
+    for(int d = 0; d < 3; ++ d) {
+      shift[d].resize(m_[d]);
+      for(unsigned int i = 0; i < m_[d]; ++ i) {
+        int k = (i < m_[d] / 2) ? (int) i : (int) i - (int) m_[d];
+        real_t theta = k * dq_[d] * (n_[d] - 1) * voxel_[d] / 2.;
+        shift[d][i] = complex_t(std::cos(theta), std::sin(theta));
+      } // for
+    } // for
+    real_t volume = voxel_[0] * voxel_[1] * voxel_[2];
+    #pragma omp parallel for schedule(static)
+    for(long int zy = 0; zy < (long int) m_[2] * m_[1]; ++ zy) {
+      unsigned int z = zy / m_[1], y = zy % m_[1];
+      complex_t s = volume * shift[2][z] * shift[1][y];
+      for(unsigned int x = 0; x < m_[0]; ++ x) samples_[zy * m_[0] + x] *= s * shift[0][x];
+    } // for
+    return true;
+  } // DensityGrid::build()
+
+
+  /**
+   * form factor at the rotated q-point mq. the real part of mq is interpolated with the
+   * cubic convolution kernel (a = -1/2) over 4 x 4 x 4 samples, and the imaginary part is
+   * added as the first order term i dot(imag(mq), grad C)
+   */
+  complex_t DensityGrid::form_factor(const complex_t* mq) const {
+    if(samples_.empty()) return CMPLX_ZERO_;
+    size_t idx[3][4];
+    real_t sgn[3][4], w[3][4], dw[3][4];
+    for(int d = 0; d < 3; ++ d) {
+      real_t u = mq[d].real() / dq_[d];
+      real_t k0 = std::floor(u);
+      real_t t = u - k0, t2 = t * t, t3 = t2 * t;
+      w[d][0] = -0.5 * t3 + t2 - 0.5 * t;
+      w[d][1] = 1.5 * t3 - 2.5 * t2 + 1.;
+      w[d][2] = -1.5 * t3 + 2. * t2 + 0.5 * t;
+      w[d][3] = 0.5 * t3 - 0.5 * t2;
+      dw[d][0] = (-1.5 * t2 + 2. * t - 0.5) / dq_[d];
+      dw[d][1] = (4.5 * t2 - 5. * t) / dq_[d];
+      dw[d][2] = (-4.5 * t2 + 4. * t + 0.5) / dq_[d];
+      dw[d][3] = (1.5 * t2 - t) / dq_[d];
+      long int m = m_[d], half = m / 2;
+      for(int a = 0; a < 4; ++ a) {
+        // fold k into [-m/2, m/2), C changes sign by (-1)^(n-1) with each period
+        long int k = (long int) k0 - 1 + a;
+        long int p = (k + half >= 0) ? (k + half) / m : - ((- (k + half) + m - 1) / m);
+        long int kf = k - p * m;
+        idx[d][a] = (kf < 0) ? kf + m : kf;
+        sgn[d][a] = ((n_[d] - 1) % 2 == 1 && (p % 2 != 0)) ? -1. : 1.;
+      } // for
+    } // for
+
+    complex_t val = CMPLX_ZERO_, grad[3] = { CMPLX_ZERO_, CMPLX_ZERO_, CMPLX_ZERO_ };
+    for(int c = 0; c < 4; ++ c) {
+      for(int b = 0; b < 4; ++ b) {
+        const complex_t* row = &samples_[(idx[2][c] * m_[1] + idx[1][b]) * m_[0]];
+        real_t s_cb = sgn[2][c] * sgn[1][b];
+        complex_t sx = CMPLX_ZERO_, dsx = CMPLX_ZERO_;
+        for(int a = 0; a < 4; ++ a) {
+          complex_t s = sgn[0][a] * row[idx[0][a]];
+          sx += w[0][a] * s;
+          dsx += dw[0][a] * s;
+        } // for
+        sx *= s_cb; dsx *= s_cb;
+        val += w[2][c] * w[1][b] * sx;
+        grad[0] += w[2][c] * w[1][b] * dsx;
+        grad[1] += w[2][c] * dw[1][b] * sx;
+        grad[2] += dw[2][c] * w[1][b] * sx;
+      } // for
+    } // for
+    complex_t f = val + CMPLX_ONE_ * (mq[0].imag() * grad[0] + mq[1].imag() * grad[1] +
+                                      mq[2].imag() * grad[2]);
+
+    // form factor of a voxel, relative to its volume
+    for(int d = 0; d < 3; ++ d) f *= sinc(mq[d] * voxel_[d] / (real_t) 2.);
+    return f;
+  } // DensityGrid::form_factor()
+
+} // namespace hig
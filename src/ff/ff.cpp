@@ -18,6 +18,7 @@
 #include <fstream>
 
 #include <ff/ff.hpp>
+#include <file/raw_data.hpp>
 
 namespace hig {
 
@@ -32,7 +33,7 @@ namespace hig {
   bool FormFactor::compute_form_factor(ShapeName shape, std::string shape_filename,
                     shape_param_list_t& params, real_t single_thickness,
                     vector3_t& transvec, real_t shp_tau, real_t shp_eta,
-                    RotMatrix_t & rot
+                    RotMatrix_t & rot, const QGridView& qgrid
                     #ifdef USE_MPI
                       , woo::MultiNode& multi_node, std::string comm_key
                     #endif
@@ -40,7 +41,7 @@ namespace hig {
     if(shape == shape_custom) {
       /* compute numerically */
       is_analytic_ = false;
-      numeric_ff_.init(rot, ff_);
+      numeric_ff_.init(rot, ff_, qgrid);
       numeric_ff_.compute(shape_filename.c_str(), ff_, rot
                 #ifdef USE_MPI
                   , multi_node, comm_key
@@ -49,7 +50,7 @@ namespace hig {
     } else {
       /* compute analytically */
       is_analytic_ = true;
-      analytic_ff_.init(rot, ff_);
+      analytic_ff_.init(rot, ff_, qgrid);
       analytic_ff_.compute(shape, shp_tau, shp_eta, transvec,
                   ff_, params, single_thickness, rot
                   #ifdef USE_MPI
@@ -107,7 +108,13 @@ namespace hig {
     out.close();
   }
 
-  void FormFactor::save_ff(unsigned int nqz, const char* filename) {
+  void FormFactor::save_ff(unsigned int nqz, const char* filename, OutputFormatType format) {
+    if(format != output_format_text) {
+      std::vector<real_t> mag(nqz);
+      for(unsigned int z = 0; z < nqz; ++ z) mag[z] = std::abs(ff_[z]);
+      write_raw_data(filename, &mag[0], 1, &nqz, format == output_format_binary32, "quantity=|ff|\n");
+      return;
+    } // if
     std::ofstream f(filename);
     for(unsigned int z = 0; z < nqz; ++ z) {
       f << std::abs(ff_[z]) << std::endl;
@@ -31,10 +31,12 @@ namespace hig {
   // TODO: decompose into two init functions:
   //   one for overall (sets qgrid in gff_),
   //   other for each run/invocation (sets rotation matrices)
-  bool AnalyticFormFactor::init(RotMatrix_t & rot, std::vector<complex_t> &ff) {
-    nqx_ = QGrid::instance().nqx();
-    nqy_ = QGrid::instance().nqy();
-    nqz_ = QGrid::instance().nqz_extended();
+  bool AnalyticFormFactor::init(RotMatrix_t & rot, std::vector<complex_t> &ff,
+                                 const QGridView& qgrid) {
+    qgrid_ = qgrid;
+    nqx_ = qgrid_.nqx();
+    nqy_ = qgrid_.nqy();
+    nqz_ = qgrid_.nqz_extended();
 
     // first make sure there is no residue from any previous computations
     ff.clear();
@@ -52,6 +54,7 @@ namespace hig {
 
   void AnalyticFormFactor::clear() {
     nqx_ = nqy_ = nqz_ = 0;
+    qgrid_ = QGridView();
     #ifdef FF_ANA_GPU
       gff_.clear();
     #endif // FF_ANA_GPU
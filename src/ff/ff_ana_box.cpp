@@ -19,6 +19,7 @@
 #include <woo/timer/woo_boostchronotimers.hpp>
 
 #include <ff/ff_ana.hpp>
+#include <ff/cpu/ff_ana_tile.hpp>
 #include <common/enums.hpp>
 #include <common/constants.hpp>
 #include <model/shape.hpp>
@@ -32,15 +33,6 @@ namespace hig {
    * box
    */
 
-  inline complex_t FormFactorBox(complex_t qx, complex_t qy, complex_t qz, 
-          real_t length, real_t width, real_t height) {
-      real_t vol = length * width * height;
-      complex_t exp_val = std::exp(CMPLX_ONE_ * 0.5 * qz * height);
-      complex_t sinc_val = sinc(0.5 * qx * length) * sinc(0.5 * qy * width) 
-          * sinc(0.5 * qz * height);
-      return (vol * exp_val * sinc_val);
-  }
-
   bool AnalyticFormFactor::compute_box(unsigned int nqx, unsigned int nqy, unsigned int nqz,
                     std::vector<complex_t>& ff,
                     ShapeName shape, shape_param_list_t& params,
@@ -105,36 +97,35 @@ namespace hig {
       // initialize ff
       ff.clear();  ff.resize(nqz, CMPLX_ZERO_);
 
-      #pragma omp parallel for 
-      for(unsigned int i = 0; i < nqz; ++ i) {
-        unsigned int j = i % nqy;
-        std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(j), 
-                QGrid::instance().qy(j), QGrid::instance().qz_extended(i));
-        complex_t temp_ff(0.0, 0.0);
-        for(unsigned int i_z = 0; i_z < z.size(); ++ i_z) {
-          for(unsigned int i_y = 0; i_y < y.size(); ++ i_y) {
-            for(unsigned int i_x = 0; i_x < x.size(); ++ i_x) {
-              real_t wght = distr_x[i_x] * distr_y[i_y] * distr_z[i_z];
-              temp_ff += FormFactorBox(mq[0], mq[1], mq[2], x[i_x], y[i_y], z[i_z]) * wght;
-            } // for i_x
-          } // for i_y
-        } // for i_z
-        complex_t temp7 = (mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2]);
-        /*if(!(boost::math::isfinite(temp7.real()) && boost::math::isfinite(temp7.imag()))) {
-          std::cerr << "---------------- here it is ------ " << j_x << ", "
-                << j_y << ", " << j_z << std::endl;
-          exit(1);
-       } // if*/
-       ff[i] = temp_ff * exp(complex_t(-temp7.imag(), temp7.real()));
-       /*
-       if(!(boost::math::isfinite(ff[curr_index].real()) &&
-          boost::math::isfinite(ff[curr_index].imag()))) {
-        std::cerr << "******************* here it is ********* " << j_x << ", "
-              << j_y << ", " << j_z << std::endl;
-        exit(1);
-       } //if 
-            */
-      } // for i
+      // the form factor of a box, vol exp(i qz h / 2) sinc(qx l / 2) sinc(qy w / 2)
+      // sinc(qz h / 2), and the weights of its sizes are separable along x, y and z: the
+      // weighted sum over all sizes is the product of the weighted sums along each axis
+      int num_tiles = (nqz + CPU_ANA_TILE_Q_ - 1) / CPU_ANA_TILE_Q_;
+      #pragma omp parallel
+      {
+        ana_tile_t tile __attribute__((aligned(64)));
+        real_t *fx_r = tile.acc[0], *fx_i = tile.acc[1];
+        real_t *fy_r = tile.acc[2], *fy_i = tile.acc[3];
+        real_t *fz_r = tile.acc[4], *fz_i = tile.acc[5];
+        real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+        #pragma omp for schedule(dynamic)
+        for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+          unsigned int q0 = i_tile * CPU_ANA_TILE_Q_;
+          unsigned int nq = std::min(CPU_ANA_TILE_Q_, nqz - q0);
+          load_ana_tile(tile, q0, nq, nqy, qgrid_, rot_);
+          ana_sinc_sum(tile, 0, x, distr_x, false, fx_r, fx_i, nq);
+          ana_sinc_sum(tile, 1, y, distr_y, false, fy_r, fy_i, nq);
+          ana_sinc_sum(tile, 2, z, distr_z, true, fz_r, fz_i, nq);
+          #pragma omp simd
+          for(unsigned int l = 0; l < nq; ++ l) {
+            real_t xy_r = fx_r[l] * fy_r[l] - fx_i[l] * fy_i[l];
+            real_t xy_i = fx_r[l] * fy_i[l] + fx_i[l] * fy_r[l];
+            ff_r[l] = xy_r * fz_r[l] - xy_i * fz_i[l];
+            ff_i[l] = xy_r * fz_i[l] + xy_i * fz_r[l];
+          } // for
+          store_ana_tile(tile, transvec, q0, nq, ff);
+        } // for
+      } // omp parallel
     #endif // FF_ANA_GPU
     #ifdef TIME_DETAIL_2
       maintimer.stop();
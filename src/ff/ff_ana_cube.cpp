@@ -19,6 +19,7 @@
 #include <woo/timer/woo_boostchronotimers.hpp>
 
 #include <ff/ff_ana.hpp>
+#include <ff/cpu/ff_ana_tile.hpp>
 #include <common/enums.hpp>
 #include <common/constants.hpp>
 #include <model/shape.hpp>
@@ -32,15 +33,6 @@ namespace hig {
    * cube
    */
 
-  inline complex_t FormFactorCube(complex_t qx, complex_t qy, complex_t qz, 
-          real_t length) {
-      real_t vol = length * length * length;
-      complex_t exp_val = std::exp(CMPLX_ONE_ * 0.5 * qz * length);
-      complex_t sinc_val = sinc(0.5 * qx * length) * sinc(0.5 * qy * length) 
-          * sinc(0.5 * qz * length);
-      return (vol * exp_val * sinc_val);
-  }
-
   bool AnalyticFormFactor::compute_cube(unsigned int nqx, unsigned int nqy, unsigned int nqz,
                     std::vector<complex_t>& ff, shape_param_list_t& params,
                     real_t tau, real_t eta, vector3_t &transvec){
@@ -93,32 +85,37 @@ namespace hig {
       // initialize ff
       ff.clear();  ff.resize(nqz, CMPLX_ZERO_);
 
-      #pragma omp parallel for 
-      for(unsigned int i = 0; i < nqz; ++ i) {
-        unsigned int j = i % nqy;
-        std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(j), 
-                QGrid::instance().qy(j), QGrid::instance().qz_extended(i));
-        complex_t temp_ff(0.0, 0.0);
-        for(unsigned int i_x = 0; i_x < x.size(); ++ i_x) {
-          real_t wght = distr_x[i_x];
-          temp_ff += FormFactorCube(mq[0], mq[1], mq[2], x[i_x]) * wght;
-        } // for i_x
-        complex_t temp7 = (mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2]);
-        /*if(!(boost::math::isfinite(temp7.real()) && boost::math::isfinite(temp7.imag()))) {
-          std::cerr << "---------------- here it is ------ " << j_x << ", "
-                << j_y << ", " << j_z << std::endl;
-          exit(1);
-       } // if*/
-       ff[i] = temp_ff * exp(complex_t(-temp7.imag(), temp7.real()));
-       /*
-       if(!(boost::math::isfinite(ff[curr_index].real()) &&
-          boost::math::isfinite(ff[curr_index].imag()))) {
-        std::cerr << "******************* here it is ********* " << j_x << ", "
-              << j_y << ", " << j_z << std::endl;
-        exit(1);
-       } //if 
-            */
-      } // for i
+      // the form factor of a cube of edge a, a^3 exp(i qz a / 2) sinc(qx a / 2) sinc(qy a / 2)
+      // sinc(qz a / 2), summed over the edges with their weights
+      int num_tiles = (nqz + CPU_ANA_TILE_Q_ - 1) / CPU_ANA_TILE_Q_;
+      #pragma omp parallel
+      {
+        ana_tile_t tile __attribute__((aligned(64)));
+        real_t *fx_r = tile.acc[0], *fx_i = tile.acc[1];
+        real_t *fy_r = tile.acc[2], *fy_i = tile.acc[3];
+        real_t *fz_r = tile.acc[4], *fz_i = tile.acc[5];
+        real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+        #pragma omp for schedule(dynamic)
+        for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+          unsigned int q0 = i_tile * CPU_ANA_TILE_Q_;
+          unsigned int nq = std::min(CPU_ANA_TILE_Q_, nqz - q0);
+          load_ana_tile(tile, q0, nq, nqy, qgrid_, rot_);
+          for(unsigned int i_x = 0; i_x < x.size(); ++ i_x) {
+            real_t a = x[i_x], wght = distr_x[i_x] * a * a * a;
+            ana_arg(tile, 0, 0.5 * a, nq); ana_trig(tile, nq); ana_sinc(tile, fx_r, fx_i, nq);
+            ana_arg(tile, 1, 0.5 * a, nq); ana_trig(tile, nq); ana_sinc(tile, fy_r, fy_i, nq);
+            ana_arg(tile, 2, 0.5 * a, nq); ana_trig(tile, nq); ana_expi_sinc(tile, fz_r, fz_i, nq);
+            #pragma omp simd
+            for(unsigned int l = 0; l < nq; ++ l) {
+              real_t xy_r = fx_r[l] * fy_r[l] - fx_i[l] * fy_i[l];
+              real_t xy_i = fx_r[l] * fy_i[l] + fx_i[l] * fy_r[l];
+              ff_r[l] += wght * (xy_r * fz_r[l] - xy_i * fz_i[l]);
+              ff_i[l] += wght * (xy_r * fz_i[l] + xy_i * fz_r[l]);
+            } // for
+          } // for i_x
+          store_ana_tile(tile, transvec, q0, nq, ff);
+        } // for
+      } // omp parallel
     #endif // FF_ANA_GPU
     #ifdef TIME_DETAIL_2
       maintimer.stop();
@@ -100,8 +100,10 @@ namespace hig {
     #pragma omp parallel for 
     for(unsigned z = 0; z < nqz_; ++ z) {
       unsigned y = z % nqy_; 
-      std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(y), QGrid::instance().qy(y), 
-              QGrid::instance().qz_extended(z));
+      complex_t mq[3];
+      rot_.rotate(qgrid_.qx(y), qgrid_.qy(y), 
+              qgrid_.qz_extended(z),
+              mq[0], mq[1], mq[2]);
       complex_t qpar = sqrt(mq[0] * mq[0] + mq[1] * mq[1]);
       complex_t temp_ff(0.0, 0.0);
       for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
@@ -109,9 +111,7 @@ namespace hig {
           temp_ff += FormFactorCylinder(qpar, mq[2], r[i_r], h[i_h]);
         } // for h
       } // for r
-      complex_t temp1 = mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2];
-      complex_t temp2 = exp(complex_t(-temp1.imag(), temp1.real()));
-      ff[z] = temp_ff * temp2;
+      ff[z] = temp_ff * translation_phase(mq, transvec);
       if((!(boost::math::isfinite)(ff[z].real())) || (!(boost::math::isfinite)(ff[z].imag()))) {
         std::cerr << "not finite: " << z << std::endl;
       } // if
@@ -94,8 +94,8 @@ namespace hig {
       for(unsigned int y = 0; y < nqy_; ++ y) {
         for(unsigned int x = 0; x < nqx_; ++ x) {
           complex_t mqx, mqy, mqz;
-          compute_meshpoints(QGrid::instance().qx(x), QGrid::instance().qy(y),
-                    QGrid::instance().qz_extended(z), rot_, mqx, mqy, mqz);
+          compute_meshpoints(qgrid_.qx(x), qgrid_.qy(y),
+                    qgrid_.qz_extended(z), rot_, mqx, mqy, mqz);
           complex_t qpar = sqrt(mqz * mqz + mqy * mqy);
           complex_t temp_ff(0.0, 0.0);
           for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
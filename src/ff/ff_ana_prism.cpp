@@ -19,6 +19,7 @@
 #include <woo/timer/woo_boostchronotimers.hpp>
 
 #include <ff/ff_ana.hpp>
+#include <ff/cpu/ff_ana_tile.hpp>
 #include <common/enums.hpp>
 #include <common/constants.hpp>
 #include <model/shape.hpp>
@@ -81,37 +82,93 @@ namespace hig {
     // on cpu
     std::cout << "-- Computing prism3 FF on CPU ..." << std::endl;
 
+    // the form factor of the prism is separable in its edges and heights,
+    //   sum_l 2 sqrt3 exp(-i l qy / sqrt3) (qx exp(i sqrt3 l qy) - qx cos(l qx) - i sqrt3 qy sin(l qx))
+    //   * sum_h h exp(i a) sinc a / (qx (qx^2 - 3 qy^2)),  with a = h (qz + tan tau (qx sin eta + qy cos eta)) / 2
     real_t sqrt3 = sqrt(3.0);
-    complex_t unitc(0, 1.0);
+    real_t tan_tau = tan(tau), sin_eta = sin(eta), cos_eta = cos(eta);
     ff.clear(); ff.resize(nqz_, CMPLX_ZERO_);
 
-    #pragma omp parallel for 
-    for(unsigned int z = 0; z < nqz_; ++ z) {
-      unsigned int y = z % nqy_;
-      std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(y), 
-              QGrid::instance().qy(y), QGrid::instance().qz_extended(z));
-      complex_t mqx = mq[0];
-      complex_t mqy = mq[1];
-      complex_t mqz = mq[2];
-
-      complex_t temp1 = mqx * (mqx * mqx - 3.0 * mqy * mqy);
-      complex_t temp2 = mqz + tan(tau) * (mqx * sin(eta) + mqy * cos(eta));
-      complex_t temp_ff(0.0, 0.0);
-      for(unsigned int i_l = 0; i_l < l.size(); ++ i_l) {
+    int num_tiles = (nqz_ + CPU_ANA_TILE_Q_ - 1) / CPU_ANA_TILE_Q_;
+    #pragma omp parallel
+    {
+      ana_tile_t tile __attribute__((aligned(64)));
+      real_t *d_r = tile.acc[0], *d_i = tile.acc[1], *a_r = tile.acc[2], *a_i = tile.acc[3];
+      real_t *h_r = tile.acc[4], *h_i = tile.acc[5], *f_r = tile.acc[6], *f_i = tile.acc[7];
+      real_t *ar = tile.ar, *ai = tile.ai, *c = tile.c, *s = tile.s, *e = tile.e;
+      real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+      #pragma omp for schedule(dynamic)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_ANA_TILE_Q_;
+        unsigned int nq = std::min(CPU_ANA_TILE_Q_, nqz_ - q0);
+        load_ana_tile(tile, q0, nq, nqy_, qgrid_, rot_);
+        const real_t *x_r = tile.qr[0], *x_i = tile.qi[0], *y_r = tile.qr[1], *y_i = tile.qi[1];
+        const real_t *z_r = tile.qr[2], *z_i = tile.qi[2];
+        // the denominator qx (qx^2 - 3 qy^2), and the argument a / h in a_r, a_i
+        #pragma omp simd
+        for(unsigned int k = 0; k < nq; ++ k) {
+          real_t t_r = x_r[k] * x_r[k] - x_i[k] * x_i[k] - 3. * (y_r[k] * y_r[k] - y_i[k] * y_i[k]);
+          real_t t_i = 2. * x_r[k] * x_i[k] - 6. * y_r[k] * y_i[k];
+          d_r[k] = x_r[k] * t_r - x_i[k] * t_i;
+          d_i[k] = x_r[k] * t_i + x_i[k] * t_r;
+          a_r[k] = 0.5 * (z_r[k] + tan_tau * (x_r[k] * sin_eta + y_r[k] * cos_eta));
+          a_i[k] = 0.5 * (z_i[k] + tan_tau * (x_i[k] * sin_eta + y_i[k] * cos_eta));
+          h_r[k] = 0.; h_i[k] = 0.;
+        } // for
         for(unsigned int i_h = 0; i_h < h.size(); ++ i_h) {
-          complex_t temp4 = mqx * exp(unitc * mqy * l[i_l] * sqrt3);
-          complex_t temp5 = mqx * cos(mqx * l[i_l]);
-          complex_t temp6 = unitc * sqrt3 * mqy * sin(mqx * l[i_l]);
-          complex_t temp7 = fq_inv(temp2, h[i_h]);
-          complex_t temp8 = (temp4 - temp5 - temp6) * temp7;
-          complex_t temp3 = mqy * l[i_l] / sqrt3;
-          complex_t temp9 = 2.0 * sqrt3 * exp(complex_t(temp3.imag(), -temp3.real()));
-          temp_ff += (temp9 / temp1) * temp8;
+          real_t hh = h[i_h];
+          #pragma omp simd
+          for(unsigned int k = 0; k < nq; ++ k) { ar[k] = hh * a_r[k]; ai[k] = hh * a_i[k]; }
+          ana_trig(tile, nq);
+          ana_expi_sinc(tile, f_r, f_i, nq);
+          #pragma omp simd
+          for(unsigned int k = 0; k < nq; ++ k) { h_r[k] += hh * f_r[k]; h_i[k] += hh * f_i[k]; }
         } // for h
-      } // for r
-      complex_t temp10 = mqx * transvec[0] + mqy * transvec[1] + mqz * transvec[2];
-      ff[z] = temp_ff * exp(complex_t(-temp10.imag(), temp10.real()));
-    } // for z
+        for(unsigned int i_l = 0; i_l < l.size(); ++ i_l) {
+          real_t ll = l[i_l];
+          // qx exp(i sqrt3 l qy)
+          ana_arg(tile, 1, sqrt3 * ll, nq);
+          ana_trig(tile, nq);
+          #pragma omp simd
+          for(unsigned int k = 0; k < nq; ++ k) {
+            real_t p_r = c[k] / e[k], p_i = s[k] / e[k];
+            a_r[k] = x_r[k] * p_r - x_i[k] * p_i;
+            a_i[k] = x_r[k] * p_i + x_i[k] * p_r;
+          } // for
+          // - qx cos(l qx) - i sqrt3 qy sin(l qx)
+          ana_arg(tile, 0, ll, nq);
+          ana_trig(tile, nq);
+          #pragma omp simd
+          for(unsigned int k = 0; k < nq; ++ k) {
+            real_t em = 1. / e[k], ch = 0.5 * (e[k] + em), sh = 0.5 * (e[k] - em);
+            real_t cs_r = c[k] * ch, cs_i = - s[k] * sh, sn_r = s[k] * ch, sn_i = c[k] * sh;
+            a_r[k] -= x_r[k] * cs_r - x_i[k] * cs_i;
+            a_i[k] -= x_r[k] * cs_i + x_i[k] * cs_r;
+            // i sqrt3 qy sin = sqrt3 (- im + i re) of qy sin
+            a_r[k] += sqrt3 * (y_r[k] * sn_i + y_i[k] * sn_r);
+            a_i[k] -= sqrt3 * (y_r[k] * sn_r - y_i[k] * sn_i);
+          } // for
+          // times 2 sqrt3 exp(-i l qy / sqrt3) = 2 sqrt3 e (c - i s)
+          ana_arg(tile, 1, ll / sqrt3, nq);
+          ana_trig(tile, nq);
+          #pragma omp simd
+          for(unsigned int k = 0; k < nq; ++ k) {
+            real_t p_r = 2. * sqrt3 * e[k] * c[k], p_i = - 2. * sqrt3 * e[k] * s[k];
+            ff_r[k] += a_r[k] * p_r - a_i[k] * p_i;
+            ff_i[k] += a_r[k] * p_i + a_i[k] * p_r;
+          } // for
+        } // for l
+        #pragma omp simd
+        for(unsigned int k = 0; k < nq; ++ k) {
+          real_t p_r = ff_r[k] * h_r[k] - ff_i[k] * h_i[k];
+          real_t p_i = ff_r[k] * h_i[k] + ff_i[k] * h_r[k];
+          real_t dd = 1. / (d_r[k] * d_r[k] + d_i[k] * d_i[k]);
+          ff_r[k] = (p_r * d_r[k] + p_i * d_i[k]) * dd;
+          ff_i[k] = (p_i * d_r[k] - p_r * d_i[k]) * dd;
+        } // for
+        store_ana_tile(tile, transvec, q0, nq, ff);
+      } // for
+    } // omp parallel
 #endif // FF_ANA_GPU
 #ifdef TIME_DETAIL_2
     maintimer.stop();
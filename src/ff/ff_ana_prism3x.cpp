@@ -70,10 +70,11 @@ namespace hig {
     #pragma omp parallel for
     for(unsigned int j_z = 0; j_z < nqz_; ++ j_z) {
       unsigned int j_y = j_z % nqy_;
-      real_t temp_qx = QGrid::instance().qx(j_y);
-      real_t temp_qy = QGrid::instance().qy(j_y);
-      complex_t temp_qz = QGrid::instance().qz_extended(j_z);
-      std::vector<complex_t> mq = rot_.rotate(temp_qx, temp_qy, temp_qz);
+      real_t temp_qx = qgrid_.qx(j_y);
+      real_t temp_qy = qgrid_.qy(j_y);
+      complex_t temp_qz = qgrid_.qz_extended(j_z);
+      complex_t mq[3];
+      rot_.rotate(temp_qx, temp_qy, temp_qz, mq[0], mq[1], mq[2]);
       real_t sg = sin(gamma);
       real_t cg = cos(gamma);
       real_t qx_rot = temp_qx * cg + temp_qy * sg;
@@ -113,8 +114,7 @@ namespace hig {
           } // for i_x
         } // for i_y
       } // for i_h
-      complex_t temp7 = (mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2]);
-      ff[j_z] = temp_ff * exp(complex_t(-temp7.imag(), temp7.real()));
+      ff[j_z] = temp_ff * translation_phase(mq, transvec);
     } // for z
 
     return true;
@@ -80,8 +80,10 @@ namespace hig {
     #pragma omp parallel for 
     for(unsigned int z = 0; z < nqz_; ++ z) {
       unsigned int y = z % nqy_;
-      std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(y), 
-              QGrid::instance().qy(y), QGrid::instance().qz_extended(z));
+      complex_t mq[3];
+      rot_.rotate(qgrid_.qx(y), 
+              qgrid_.qy(y), qgrid_.qz_extended(z),
+              mq[0], mq[1], mq[2]);
       complex_t qm = tan(tau) * (mq[0] * sin(eta) + mq[1] * cos(eta));
       complex_t temp1 = ((real_t) 4.0 * sqrt3) / (3.0 * mq[1] * mq[1] - mq[0] * mq[0]);
       complex_t temp_ff(0.0, 0.0);
@@ -97,8 +99,7 @@ namespace hig {
           temp_ff += temp5 * temp6;
         } // for l
       } // for h
-      complex_t temp7 = (mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2]);
-      ff[z] = temp_ff * exp(complex_t(-temp7.imag(), temp7.real()));
+      ff[z] = temp_ff * translation_phase(mq, transvec);
     } // for z
 #endif // FF_ANA_GPU
 #ifdef TIME_DETAIL_2
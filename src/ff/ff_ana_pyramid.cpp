@@ -126,8 +126,10 @@ namespace hig {
       #pragma omp parallel for 
       for(int i = 0; i < nqz_; i++) {
         int j = i % nqy_;
-        std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(j), 
-                QGrid::instance().qy(j), QGrid::instance().qz_extended(i));
+        complex_t mq[3];
+        rot_.rotate(qgrid_.qx(j), 
+                qgrid_.qy(j), qgrid_.qz_extended(i),
+                mq[0], mq[1], mq[2]);
         
         complex_t temp_ff(0.0, 0.0);
         for(int i_x = 0; i_x < x.size(); ++ i_x) {
@@ -141,8 +143,7 @@ namespace hig {
             } // for h
           } // for y
         } // for x
-        complex_t temp1 = mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2];
-        ff[i] = temp_ff * exp(complex_t(0, 1) * temp1);
+        ff[i] = temp_ff * translation_phase(mq, transvec);
       } // for z
     #endif // FF_ANA_GPU
 
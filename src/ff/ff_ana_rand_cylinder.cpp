@@ -92,7 +92,7 @@ namespace hig {
 
       #pragma omp parallel for
       for(unsigned int z = 0; z < nqz_; ++ z) {
-        complex_t qz = QGrid::instance().qz_extended(z);
+        complex_t qz = qgrid_.qz_extended(z);
         complex_t temp_ff(0.0, 0.0);
         for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
           for(unsigned int i_h = 0; i_h < h.size(); ++ i_h) {
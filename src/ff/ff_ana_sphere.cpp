@@ -19,6 +19,7 @@
 #include <woo/timer/woo_boostchronotimers.hpp>
 
 #include <ff/ff_ana.hpp>
+#include <ff/cpu/ff_ana_tile.hpp>
 #include <common/constants.hpp>
 #include <common/enums.hpp>
 #include <model/shape.hpp>
@@ -30,20 +31,6 @@ namespace hig {
   /**
    * sphere
    */
-  complex_t FormFactorSphere(complex_t qx, complex_t qy, complex_t qz, real_t radius){
-      complex_t qval = std::sqrt(qx * qx + qy * qy + qz * qz);
-      if (std::abs(qval) < TINY_){
-        return CMPLX_ZERO_;
-      }
-      complex_t qR   = qval * radius;
-      complex_t qR3   = qR * qR * qR;
-      complex_t t1   = std::conj(qR3) / std::norm(qR3);
-      complex_t c0   = (std::sin(qR) - qR * std::cos(qR)) * t1;
-      complex_t c1   = std::exp(CMPLX_ONE_ * qz * radius);
-      real_t   f0   = 4 * PI_ * radius * radius * radius;
-      return (f0 * c0 * c1);            
-  }
-
   bool AnalyticFormFactor::compute_sphere(shape_param_list_t& params, std::vector<complex_t> &ff,
                       vector3_t transvec) {
     std::vector<real_t> r, distr_r;
@@ -88,23 +75,79 @@ namespace hig {
     gff_.compute_sphere(r, distr_r, rot_, transvec_v, ff);
 #else
     // on cpu
-    std::cerr << "-- Computing sphere FF on CPU ..." << std::endl;
+    #ifdef FF_VERBOSE
+      std::cerr << "-- Computing sphere FF on CPU ..." << std::endl;
+    #endif
 
     ff.clear(); ff.resize(nqz_, CMPLX_ZERO_);
 
-    #pragma omp parallel for 
-    for(unsigned int z = 0; z < nqz_; ++ z) {
-      unsigned int y = z % nqy_;
-      std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(y), QGrid::instance().qy(y),
-              QGrid::instance().qz_extended(z));
-      complex_t temp_ff = CMPLX_ZERO_;
-      for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
-          temp_ff += distr_r[i_r] * FormFactorSphere(mq[0], mq[1], mq[2], r[i_r]);
-      } // for r
-      complex_t temp1 = mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2];
-      complex_t temp2 = std::exp(complex_t(-temp1.imag(), temp1.real()));
-      ff[z] = temp_ff * temp2;
-    } // for z
+    // the form factor of a sphere of radius r, with a = q r,
+    //   4 pi r^3 (sin a - a cos a) / a^3 exp(i qz r),
+    // summed over the radii with their weights. it is zero at q = 0
+    int num_tiles = (nqz_ + CPU_ANA_TILE_Q_ - 1) / CPU_ANA_TILE_Q_;
+    #pragma omp parallel
+    {
+      ana_tile_t tile __attribute__((aligned(64)));
+      real_t *q_r = tile.acc[0], *q_i = tile.acc[1], *f_r = tile.acc[2], *f_i = tile.acc[3];
+      real_t *ar = tile.ar, *ai = tile.ai, *c = tile.c, *s = tile.s, *e = tile.e;
+      real_t *ff_r = tile.ff_r, *ff_i = tile.ff_i;
+      #pragma omp for schedule(dynamic)
+      for(int i_tile = 0; i_tile < num_tiles; ++ i_tile) {
+        unsigned int q0 = i_tile * CPU_ANA_TILE_Q_;
+        unsigned int nq = std::min(CPU_ANA_TILE_Q_, nqz_ - q0);
+        load_ana_tile(tile, q0, nq, nqy_, qgrid_, rot_);
+        // q = sqrt(q.q), the principal root
+        #pragma omp simd
+        for(unsigned int l = 0; l < nq; ++ l) {
+          real_t w_r = 0., w_i = 0.;
+          for(int d = 0; d < 3; ++ d) {
+            w_r += tile.qr[d][l] * tile.qr[d][l] - tile.qi[d][l] * tile.qi[d][l];
+            w_i += 2. * tile.qr[d][l] * tile.qi[d][l];
+          } // for
+          real_t t = std::sqrt(0.5 * (std::sqrt(w_r * w_r + w_i * w_i) + std::abs(w_r)));
+          real_t u = (t > 0.) ? 0.5 * w_i / t : 0.;
+          q_r[l] = (w_r >= 0.) ? t : std::abs(u);
+          q_i[l] = (w_r >= 0.) ? u : std::copysign(t, w_i);
+        } // for
+        for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
+          real_t rad = r[i_r], wght = distr_r[i_r] * 4 * PI_ * rad * rad * rad;
+          #pragma omp simd
+          for(unsigned int l = 0; l < nq; ++ l) { ar[l] = rad * q_r[l]; ai[l] = rad * q_i[l]; }
+          ana_trig(tile, nq);
+          // (sin a - a cos a) / a^3, by its series 1/3 - a^2/30 + a^4/840 - a^6/45360 near 0
+          #pragma omp simd
+          for(unsigned int l = 0; l < nq; ++ l) {
+            real_t em = 1. / e[l], ch = 0.5 * (e[l] + em), sh = 0.5 * (e[l] - em);
+            real_t sin_r = s[l] * ch, sin_i = c[l] * sh, cos_r = c[l] * ch, cos_i = - s[l] * sh;
+            real_t n_r = sin_r - (ar[l] * cos_r - ai[l] * cos_i);
+            real_t n_i = sin_i - (ar[l] * cos_i + ai[l] * cos_r);
+            real_t a2_r = ar[l] * ar[l] - ai[l] * ai[l], a2_i = 2. * ar[l] * ai[l];
+            real_t a3_r = a2_r * ar[l] - a2_i * ai[l], a3_i = a2_r * ai[l] + a2_i * ar[l];
+            real_t a3 = a3_r * a3_r + a3_i * a3_i;
+            bool zero = (q_r[l] == 0. && q_i[l] == 0.);
+            bool series = (ar[l] * ar[l] + ai[l] * ai[l]) < 1e-2;
+            real_t d = series ? 1. : 1. / a3;
+            real_t x_r = (n_r * a3_r + n_i * a3_i) * d, x_i = (n_i * a3_r - n_r * a3_i) * d;
+            real_t a4_r = a2_r * a2_r - a2_i * a2_i, a4_i = 2. * a2_r * a2_i;
+            real_t a6_r = a4_r * a2_r - a4_i * a2_i, a6_i = a4_r * a2_i + a4_i * a2_r;
+            real_t p_r = 1. / 3. - a2_r / 30. + a4_r / 840. - a6_r / 45360.;
+            real_t p_i = - a2_i / 30. + a4_i / 840. - a6_i / 45360.;
+            f_r[l] = zero ? 0. : (series ? p_r : x_r);
+            f_i[l] = zero ? 0. : (series ? p_i : x_i);
+          } // for
+          ana_arg(tile, 2, rad, nq);
+          ana_trig(tile, nq);
+          #pragma omp simd
+          for(unsigned int l = 0; l < nq; ++ l) {
+            // times exp(i qz r) = (c + i s) / e
+            real_t x_r = c[l] / e[l], x_i = s[l] / e[l];
+            ff_r[l] += wght * (f_r[l] * x_r - f_i[l] * x_i);
+            ff_i[l] += wght * (f_r[l] * x_i + f_i[l] * x_r);
+          } // for
+        } // for r
+        store_ana_tile(tile, transvec, q0, nq, ff);
+      } // for
+    } // omp parallel
 #endif // FF_ANA_GPU
 #ifdef TIME_DETAIL_2
     maintimer.stop();
@@ -91,22 +91,31 @@ namespace hig {
     ff.resize(nqz_, CMPLX_ZERO_);
 
     unsigned int nz = 40;  // FIXME: hard-coded ... what is this???
+    // no exit from a parallel region: a bad value is flagged, and the remaining points skipped
+    bool failed = false;
+    #pragma omp parallel for
     for(unsigned z = 0; z < nqz_; ++ z) {
+      bool done;
+      #pragma omp atomic read
+      done = failed;
+      if(done) continue;
       unsigned y = z % nqy_;
-      std::vector<complex_t> mq = rot_.rotate(QGrid::instance().qx(y), QGrid::instance().qy(y),
-                QGrid::instance().qz_extended(z));
+      complex_t mq[3];
+      rot_.rotate(qgrid_.qx(y), qgrid_.qy(y),
+                qgrid_.qz_extended(z),
+              mq[0], mq[1], mq[2]);
 
       complex_t qpar = sqrt(mq[0] * mq[0] + mq[1] * mq[1]);
       complex_t temp_ff(0.0, 0.0);
 
-      for(unsigned int i_a = 0; i_a < a.size(); ++ i_a) {
+      for(unsigned int i_a = 0; i_a < a.size() && !done; ++ i_a) {
         real_t temp1 = tan(a[i_a]);
-        for(unsigned int i_h = 0; i_h < h.size(); ++ i_h) {
+        for(unsigned int i_h = 0; i_h < h.size() && !done; ++ i_h) {
           real_t dz = h[i_h] / (real_t)(nz - 1);
-          for(unsigned int i_r = 0; i_r < r.size(); ++ i_r) {
+          for(unsigned int i_r = 0; i_r < r.size() && !done; ++ i_r) {
             real_t z_val = 0.0;
             complex_t temp_ffz(0.0, 0.0);
-            for(unsigned int i_z = 0; i_z < nz; ++ i_z, z_val += dz) {
+            for(unsigned int i_z = 0; i_z < nz && !done; ++ i_z, z_val += dz) {
               real_t rz = r[i_r] - z_val / temp1;
               complex_t temp2 = exp(complex_t(-(mq[2] * rz).imag(), (mq[2] * rz).real()));
               complex_t temp3 = cbessj(qpar * rz, 1) / (qpar * rz);
@@ -116,21 +125,23 @@ namespace hig {
                   boost::math::fpclassify(temp_ffz.imag()) == FP_ZERO) ||
                   !boost::math::isfinite(temp_ffz.real()) ||
                   !boost::math::isfinite(temp_ffz.imag())) {
-                  std::cout << "--------------------here it is: " << a[i_a] << ", "
+                  #pragma omp critical (trunc_cone_error)
+                  std::cerr << "error: invalid truncated cone form factor at: " << a[i_a] << ", "
                         << r[i_r] << ", " << h[i_h] << ", " << y
                         << ", " << z << ", " << i_z << std::endl;
-                  exit(1);
+                  #pragma omp atomic write
+                  failed = true;
+                  done = true;
               } // if
             } // for
             temp_ff += 2 * PI_ * distr_r[i_r] * distr_h[i_h] * distr_a[i_a] * temp_ffz;
           } // for r
         } // for h
       } // for a
-      complex_t temp1 = mq[0] * transvec[0] + mq[1] * transvec[1] + mq[2] * transvec[2];
-      complex_t temp2 = exp(complex_t(-temp1.imag(), temp1.real()));
-      ff[z] = temp_ff * temp2;
+      ff[z] = temp_ff * translation_phase(mq, transvec);
     } // for z
 
+    return !failed;
   } // AnalyticFormFactor::compute_truncated_cone()
 
 } // namespace hig
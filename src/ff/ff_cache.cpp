@@ -0,0 +1,106 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: ff_cache.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+#include <ff/ff_cache.hpp>
+#include <model/qgrid.hpp>
+
+namespace hig {
+
+  std::string FormFactorCache::key(const std::string& shape_key, ShapeName shape_name,
+                                   const std::string& shape_file,
+                                   const shape_param_list_t& params, const RotMatrix_t& rot) {
+    // params is an unordered map, so sort the entries to make the key deterministic
+    std::vector<std::string> pkeys;
+    for(shape_param_list_t::const_iterator i = params.begin(); i != params.end(); ++ i)
+      pkeys.push_back((*i).first);
+    std::sort(pkeys.begin(), pkeys.end());
+
+    std::ostringstream k;
+    k << std::hexfloat;   // exact representation of all the real values
+    k << shape_key << "|" << shape_name << "|" << shape_file << "|";
+    for(std::vector<std::string>::const_iterator i = pkeys.begin(); i != pkeys.end(); ++ i) {
+      const ShapeParam& p = params.at(*i);
+      k << *i << ":" << p.type() << "," << p.stat() << "," << p.min() << "," << p.max()
+        << "," << p.mean() << "," << p.deviation() << "," << p.nvalues() << ","
+        << p.isvalid() << ";";
+    } // for
+    k << "|";
+    for(int i = 0; i < 3; ++ i)
+      for(int j = 0; j < 3; ++ j) k << rot(i, j) << ",";
+    return k.str();
+  } // FormFactorCache::key()
+
+
+  const FormFactorCache::ff_vec_t* FormFactorCache::find(const std::string& key) {
+    cache_t::const_iterator i = cache_.find(key);
+    if(i == cache_.end()) { ++ misses_; return NULL; }
+    ++ hits_;
+    return &(*i).second;
+  } // FormFactorCache::find()
+
+
+  const FormFactorCache::ff_vec_t* FormFactorCache::insert(const std::string& key, ff_vec_t& ff) {
+    // when full, simply start over: entries are only reused within a structure
+    if(max_entries_ > 0 && cache_.size() >= max_entries_) cache_.clear();
+    ff_vec_t& entry = cache_[key];
+    entry.swap(ff);
+    ff.clear();
+    return &entry;
+  } // FormFactorCache::insert()
+
+
+  bool FormFactorCache::accumulate(const ff_vec_t& ff0, complex_t dn2, const vector3_t& transvec,
+                                   const RotMatrix_t& rot, bool translate, unsigned int sz,
+                                   const QGridView& qgrid, std::vector<complex_t>& ff) {
+    unsigned int n = std::min((unsigned int) ff0.size(), sz);
+    if(ff.size() < n) {
+      std::cerr << "error: form factor buffer is smaller than the cached form factor" << std::endl;
+      return false;
+    } // if
+    if(!translate) {
+      #pragma omp parallel for
+      for(unsigned int i = 0; i < n; ++ i) ff[i] += dn2 * ff0[i];
+      return true;
+    } // if
+
+    // (rot q) . t = q . (rot^T t), so rotate the translation once instead of every q
+    real_t t0 = rot(0, 0) * transvec[0] + rot(1, 0) * transvec[1] + rot(2, 0) * transvec[2];
+    real_t t1 = rot(0, 1) * transvec[0] + rot(1, 1) * transvec[1] + rot(2, 1) * transvec[2];
+    real_t t2 = rot(0, 2) * transvec[0] + rot(1, 2) * transvec[1] + rot(2, 2) * transvec[2];
+
+    const real_t* qx = qgrid.qx();
+    const real_t* qy = qgrid.qy();
+    const complex_t* qz = qgrid.qz_extended();
+    unsigned int nqy = qgrid.nqy();
+
+    #pragma omp parallel for
+    for(unsigned int i = 0; i < n; ++ i) {
+      unsigned int j = i % nqy;
+      // exp(i (qx t0 + qy t1 + qz t2)) with complex qz
+      real_t arg = qx[j] * t0 + qy[j] * t1 + qz[i].real() * t2;
+      real_t mag = std::exp(- qz[i].imag() * t2);
+      complex_t phase(mag * std::cos(arg), mag * std::sin(arg));
+      ff[i] += dn2 * ff0[i] * phase;
+    } // for
+    return true;
+  } // FormFactorCache::accumulate()
+
+} // namespace hig
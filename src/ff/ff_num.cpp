@@ -33,12 +33,15 @@
 #include <utils/utilities.hpp>
 #include <file/objectshape_reader.hpp>
 #include <file/rawshape_reader.hpp>
+#include <file/hig_file_reader.hpp>
 
 namespace hig {
 
-  bool NumericFormFactor::init(RotMatrix_t & rot, std::vector<complex_t>& ff) {
-    nqy_ = QGrid::instance().nqy();
-    nqz_ = QGrid::instance().nqz_extended();
+  bool NumericFormFactor::init(RotMatrix_t & rot, std::vector<complex_t>& ff,
+                                const QGridView& qgrid) {
+    qgrid_ = qgrid;
+    nqy_ = qgrid_.nqy();
+    nqz_ = qgrid_.nqz_extended();
     ff.clear();
     rot_ = rot;
     return true;
@@ -52,46 +55,7 @@ namespace hig {
           ) {
 
     // initialize 
-    init (rot, ff);
-
-    // read file
-    std::vector<vertex_t> vertices;
-    std::vector<std::vector<int>> faces;
-    std::vector<std::vector<int>> dummy;
-    ObjectShapeReader shape_reader;
-    if (!shape_reader.load_object (filename, vertices, faces, dummy)) {
-        std::cerr << "Error: shape reader failed to load triangles" << std::endl;
-        return false;
-    }
-
-    // create triangles
-    int num_triangles = faces.size();
-    triangle_t * triangles = new (std::nothrow) triangle_t [num_triangles];
-    for (int i = 0; i < num_triangles; i++) {
-      triangles[i].v1[0] = vertices[faces[i][0]-1].x;
-      triangles[i].v1[1] = vertices[faces[i][0]-1].y;
-      triangles[i].v1[2] = vertices[faces[i][0]-1].z;
-
-      triangles[i].v2[0] = vertices[faces[i][1]-1].x;
-      triangles[i].v2[1] = vertices[faces[i][1]-1].y;
-      triangles[i].v2[2] = vertices[faces[i][1]-1].z;
-
-      triangles[i].v3[0] = vertices[faces[i][2]-1].x;
-      triangles[i].v3[1] = vertices[faces[i][2]-1].y;
-      triangles[i].v3[2] = vertices[faces[i][2]-1].z;
-    }
-
-
-//#ifndef __SSE3__
-    real_vec_t shape_def;
-//#else
-//#ifdef USE_GPU
-//    real_vec_t shape_def;
-//#else
-//    real_t * shape_def = NULL;
-//#endif
-//#endif
-    //unsigned int num_triangles = read_shapes_file(filename, shape_def);
+    init (rot, ff, qgrid_);
 
 #ifdef USE_MPI
       int num_procs = world_comm.size(comm_key);
@@ -99,8 +63,19 @@ namespace hig {
       bool master = world_comm.is_master(comm_key);
 #else
       bool master = true;
+#endif
 
+    // get the triangles, the file is parsed only once
+    const ShapeMeshStore::triangles_entry_t* mesh = load_triangles(filename
+#ifdef USE_MPI
+                                                      , world_comm, comm_key
 #endif
+                                                      );
+    if (mesh == NULL || mesh->triangles_.empty()) {
+        std::cerr << "Error: shape reader failed to load triangles" << std::endl;
+        return false;
+    }
+    int num_triangles = mesh->triangles_.size();
 
     if(master) {
       std::cout << "-- Numerical form factor computation ..." << std::endl
@@ -119,14 +94,14 @@ namespace hig {
         std::cerr << "Error: failure in allocation memeroy." << std::endl;
         return false;
     }
-    for (int i = 0; i < nqy_; i++ ) qx[i] = QGrid::instance().qx(i);
+    for (int i = 0; i < nqy_; i++ ) qx[i] = qgrid_.qx(i);
 
     real_t * qy = new (std::nothrow) real_t [nqy_];
     if (qy == NULL) {
         std::cerr << "Error: failure in allocation memeroy." << std::endl;
         return false;
     }
-    for (int i = 0; i < nqy_; i++) qy[i] = QGrid::instance().qy(i);
+    for (int i = 0; i < nqy_; i++) qy[i] = qgrid_.qy(i);
 
 #ifdef FF_NUM_GPU
     cucomplex_t * qz = new (std::nothrow) cucomplex_t [nqz_];
@@ -135,8 +110,8 @@ namespace hig {
       return 0;
     }
     for (int i = 0; i < nqz_; i++) {
-      qz[i].x = QGrid::instance().qz_extended(i).real();
-      qz[i].y = QGrid::instance().qz_extended(i).imag();
+      qz[i].x = qgrid_.qz_extended(i).real();
+      qz[i].y = qgrid_.qz_extended(i).imag();
     }
 #else
     complex_t * qz = new (std::nothrow) complex_t [nqz_];
@@ -144,11 +119,12 @@ namespace hig {
         std::cerr << "Error: failure in memeroy allocation." << std::endl;
         return 0;
     }
-    for (int i = 0; i < nqz_; i++) qz[i] = QGrid::instance().qz_extended(i);
+    for (int i = 0; i < nqz_; i++) qz[i] = qgrid_.qz_extended(i);
 #endif
 
     real_t compute_time = 0.;
 #ifdef FF_NUM_GPU
+    const triangle_t * triangles = &mesh->triangles_[0];
     cucomplex_t * p_ff = NULL;
     // call kernel
     if (num_triangles != gff_.compute_exact_triangle(triangles, num_triangles,
@@ -166,7 +142,29 @@ namespace hig {
           << nqz_ * sizeof(complex_t) << std::endl;
       return false;
     }
-    if (num_triangles != cff_.compute_exact_triangle(triangles, num_triangles, 
+    if (method_ == triangle_method_auto) {
+      real_t err_bound = 0., approx_fraction = 0.;
+      if (num_triangles != cff_.compute_auto_triangle(mesh->table_, tol_,
+                  p_ff, nqy_, qx, qy,
+                  nqz_, qz, rot_, compute_time, err_bound, approx_fraction)) {
+          std::cerr << "Calculation of numerical form-factor failed" << std::endl;
+          return false;
+      }
+      if(master)
+        std::cout << "**   Approximated triangle tiles: " << approx_fraction * 100 << "%" << std::endl
+                  << "**  Relative FF error bound (est): " << err_bound << std::endl;
+    } else if (method_ == triangle_method_tree) {
+      real_t err_bound = 0., approx_fraction = 0.;
+      if (num_triangles != cff_.compute_tree_triangle(mesh->tree_, mesh->table_, tol_,
+                  p_ff, nqy_, qx, qy,
+                  nqz_, qz, rot_, compute_time, err_bound, approx_fraction)) {
+          std::cerr << "Calculation of numerical form-factor failed" << std::endl;
+          return false;
+      }
+      if(master)
+        std::cout << "**   Clustered triangle tiles: " << approx_fraction * 100 << "%" << std::endl
+                  << "**  Relative FF error bound (est): " << err_bound << std::endl;
+    } else if (num_triangles != cff_.compute_exact_triangle(mesh->table_,
                 p_ff, nqy_, qx, qy, 
                 nqz_, qz, rot_, compute_time)) {
         std::cerr << "Calculation of numerical form-factor failed" << std::endl;
@@ -178,41 +176,92 @@ namespace hig {
     delete [] qx;
     delete [] qy;
     delete [] qz;
-    delete [] triangles;
     if (p_ff != NULL) delete [] p_ff;
     return true;
   }
 
 
+  /**
+   * Form factor of a density grid shape. The grid is transformed only once (per file and
+   * padding), and the form factor at each rotated q-point is interpolated from it.
+   */
+  bool NumericFormFactor::compute_density(const char * filename, complex_vec_t & ff,
+          RotMatrix_t & rot
+#ifdef USE_MPI
+          , woo::MultiNode & world_comm, std::string comm_key
+#endif
+          ) {
+    init(rot, ff, qgrid_);
+#ifdef USE_MPI
+    bool master = world_comm.is_master(comm_key);
+#else
+    bool master = true;
+#endif
+
+    woo::BoostChronoTimer timer;
+    timer.start();
+    const ShapeMeshStore::density_entry_t* entry = load_density(filename
+#ifdef USE_MPI
+                                                      , world_comm, comm_key
+#endif
+                                                      );
+    if(entry == NULL) {
+      std::cerr << "error: failed to load the density grid " << filename << std::endl;
+      return false;
+    } // if
+    const DensityGrid& grid = entry->grid_;
+    if(master) {
+      std::cout << "-- Density grid form factor computation ..." << std::endl
+            << "**        Using input shape file: " << filename << std::endl
+            << "**             Density grid size: " << grid.size(0) << " x " << grid.size(1)
+            << " x " << grid.size(2) << std::endl
+            << "**           Padded (fft) size: " << grid.padded_size(0) << " x "
+            << grid.padded_size(1) << " x " << grid.padded_size(2) << std::endl
+            << std::flush;
+    } // if
+
+    ff.resize(nqz_);
+    #pragma omp parallel for schedule(static)
+    for(int i_z = 0; i_z < (int) nqz_; ++ i_z) {
+      int i_y = i_z % nqy_;
+      complex_t mq[3];
+      rot_.rotate(qgrid_.qx(i_y), qgrid_.qy(i_y), qgrid_.qz_extended(i_z), mq[0], mq[1], mq[2]);
+      ff[i_z] = grid.form_factor(mq);
+    } // for
+
+    timer.stop();
+    if(master)
+      std::cout << "**     Density FF compute time: " << timer.elapsed_msec() << " ms." << std::endl;
+    return true;
+  } // NumericFormFactor::compute_density()
+
+
   bool NumericFormFactor::compute(const char * filename, complex_vec_t & ff,
           RotMatrix_t & rot
 #ifdef USE_MPI
           , woo::MultiNode &world_comm, std::string comm_key
 #endif
           ){
+    // density grid shapes are transformed once, and interpolated
+    if(is_density_file(filename)) return compute_density(filename, ff, rot
+                                    #ifdef USE_MPI
+                                      , world_comm, comm_key
+                                    #endif
+                                    );
+    // exact (and automatically selected) integration is done by compute2
+    if(method_ != triangle_method_approx) return compute2(filename, ff, rot
+                                                  #ifdef USE_MPI
+                                                    , world_comm, comm_key
+                                                  #endif
+                                                  );
     real_t comp_time = 0.0;
 
     // initialize 
-    init (rot, ff);
+    init (rot, ff, qgrid_);
 
-    unsigned int nqy = QGrid::instance().nqy();
-    unsigned int nqz = QGrid::instance().nqz_extended();
+    unsigned int nqy = qgrid_.nqy();
+    unsigned int nqz = qgrid_.nqz_extended();
 
-    // warning: all procs read the shape file!!!!
-    // TODO: improve to parallel IO, or one proc reading and sending to all ...
-//    #ifndef __SSE3__
-      real_vec_t shape_def;
-//    #else
-//      #ifdef USE_GPU
-//        real_vec_t shape_def;
-//      #else
-//        real_t* shape_def = NULL;
-//      #endif
-//    #endif
-    // use the new file reader instead ...
-    unsigned int num_triangles = read_shapes_file(filename, shape_def);
-            // TODO ... <--- sadly all procs read this! IMPROVE!!!
-  
     #ifdef USE_MPI
     int num_procs = world_comm.size(comm_key);
     int rank = world_comm.rank(comm_key);
@@ -221,6 +270,14 @@ namespace hig {
     bool master = true;
     #endif
 
+    // the shape file is parsed once (by the master) and kept in the mesh store
+    const ShapeMeshStore::shape_def_entry_t* mesh = load_shape_def(filename
+                                                      #ifdef USE_MPI
+                                                        , world_comm, comm_key
+                                                      #endif
+                                                      );
+    unsigned int num_triangles = (mesh == NULL) ? 0 : mesh->num_triangles_;
+
     if(master) {
       std::cout << "-- Numerical form factor computation ..." << std::endl
             << "**        Using input shape file: " << filename << std::endl
@@ -246,14 +303,14 @@ namespace hig {
     #endif
    
     // create qy_and qz using qgrid instance
-    for(unsigned int i = 0; i < nqy; ++ i) qx[i] = QGrid::instance().qx(i);
-    for(unsigned int i = 0; i < nqy; ++ i) qy[i] = QGrid::instance().qy(i);
+    for(unsigned int i = 0; i < nqy; ++ i) qx[i] = qgrid_.qx(i);
+    for(unsigned int i = 0; i < nqy; ++ i) qy[i] = qgrid_.qy(i);
     for(unsigned int i = 0; i < nqz; ++ i) {
     #ifdef FF_NUM_GPU
-      qz[i].x = QGrid::instance().qz_extended(i).real();
-      qz[i].y = QGrid::instance().qz_extended(i).imag();
+      qz[i].x = qgrid_.qz_extended(i).real();
+      qz[i].y = qgrid_.qz_extended(i).imag();
     #else
-      qz[i] = QGrid::instance().qz_extended(i);
+      qz[i] = qgrid_.qz_extended(i);
     #endif
     } // for
       
@@ -266,12 +323,12 @@ namespace hig {
     real_t kernel_time = 0.;
     unsigned int ret_numtriangles = 0;
     #ifdef FF_NUM_GPU  // use GPU
-    ret_numtriangles = gff_.compute_approx_triangle(shape_def, 
+    ret_numtriangles = gff_.compute_approx_triangle(mesh->shape_def_, 
             p_ff, nqy, qx, qy, nqz, qz, rot_, kernel_time);
     for (int i = 0; i < nqz; i++) ff.push_back(complex_t(p_ff[i].x, p_ff[i].y));
     std::cout << "**        FF GPU compute time: " << kernel_time << " ms." << std::endl;
     #else  // use only CPU
-    ret_numtriangles = cff_.compute_approx_triangle(shape_def, 
+    ret_numtriangles = cff_.compute_approx_triangle(mesh->shape_def_, 
             p_ff, nqy, qx, qy, nqz, qz, rot_, kernel_time);
     for (int i = 0; i < nqz; i++) ff.push_back(p_ff[i]);
     std::cout << "**        FF CPU compute time: " << kernel_time << " ms." << std::endl;
@@ -281,6 +338,7 @@ namespace hig {
       delete[] qz;
       delete[] qy;
       delete[] qx;
+      return true;
   }
 
 #ifdef OLD_Q_GRID
@@ -301,9 +359,9 @@ namespace hig {
     woo::BoostChronoTimer maintimer, computetimer;
     woo::BoostChronoTimer commtimer, memtimer;
 
-    unsigned int nqx = QGrid::instance().nqx();
-    unsigned int nqy = QGrid::instance().nqy();
-    unsigned int nqz = QGrid::instance().nqz_extended();
+    unsigned int nqx = qgrid_.nqx();
+    unsigned int nqy = qgrid_.nqy();
+    unsigned int nqz = qgrid_.nqz_extended();
 
     #ifdef USE_MPI
       bool master = world_comm.is_master(comm_key);
@@ -454,17 +512,17 @@ namespace hig {
       #endif
       // create qy_and qz using qgrid instance
       for(unsigned int i = 0; i < nqx; ++ i) {
-        qx[i] = QGrid::instance().qx(i);
+        qx[i] = qgrid_.qx(i);
       } // for
       for(unsigned int i = 0; i < nqy; ++ i) {
-        qy[i] = QGrid::instance().qy(i);
+        qy[i] = qgrid_.qy(i);
       } // for
       for(unsigned int i = 0; i < nqz; ++ i) {
         #ifdef FF_NUM_GPU
-          qz[i].x = QGrid::instance().qz_extended(i).real();
-          qz[i].y = QGrid::instance().qz_extended(i).imag();
+          qz[i].x = qgrid_.qz_extended(i).real();
+          qz[i].y = qgrid_.qz_extended(i).imag();
         #else
-          qz[i] = QGrid::instance().qz_extended(i);
+          qz[i] = qgrid_.qz_extended(i);
         #endif
       } // for
       
@@ -962,6 +1020,9 @@ namespace hig {
     if(s.compare("obj") == 0) return shape_file_object;
     if(s.compare("Obj") == 0) return shape_file_object;
     if(s.compare("OBJ") == 0) return shape_file_object;
+    if(s.compare("vox") == 0) return shape_file_density;
+    if(s.compare("Vox") == 0) return shape_file_density;
+    if(s.compare("VOX") == 0) return shape_file_density;
     return shape_file_error;
   } // NumericFormFactor::get_shape_file_format()
   
@@ -1093,4 +1154,237 @@ namespace hig {
 
     return num_triangles;
   } // NumericFormFactor::read_shapes_file()
+
+
+  /**
+   * Read the triangle vertices from an object file.
+   */
+  bool NumericFormFactor::read_triangles(const char* filename, std::vector<triangle_t>& triangles) {
+    std::vector<vertex_t> vertices;
+    std::vector<std::vector<int>> faces;
+    std::vector<std::vector<int>> dummy;
+    ObjectShapeReader shape_reader;
+    if(!shape_reader.load_object(filename, vertices, faces, dummy)) return false;
+
+    triangles.resize(faces.size());
+    for(unsigned int i = 0; i < faces.size(); ++ i) {
+      const vertex_t& a = vertices[faces[i][0] - 1];
+      const vertex_t& b = vertices[faces[i][1] - 1];
+      const vertex_t& c = vertices[faces[i][2] - 1];
+      triangles[i].v1[0] = a.x; triangles[i].v1[1] = a.y; triangles[i].v1[2] = a.z;
+      triangles[i].v2[0] = b.x; triangles[i].v2[1] = b.y; triangles[i].v2[2] = b.z;
+      triangles[i].v3[0] = c.x; triangles[i].v3[1] = c.y; triangles[i].v3[2] = c.z;
+    } // for
+    return true;
+  } // NumericFormFactor::read_triangles()
+
+
+  /**
+   * Return the parsed shape definition from the mesh store. When it is not loaded yet, only
+   * the master reads the file and sends the data to the other procs.
+   */
+  const ShapeMeshStore::shape_def_entry_t* NumericFormFactor::load_shape_def(const char* filename
+                          #ifdef USE_MPI
+                            , woo::MultiNode& world_comm, std::string comm_key
+                          #endif
+                          ) {
+    ShapeMeshStore& store = ShapeMeshStore::instance();
+    std::time_t mtime = 0;
+    #ifdef USE_MPI
+      bool master = world_comm.is_master(comm_key);
+      if(master) ShapeMeshStore::mtime(filename, mtime);
+      double temp_mtime = (double) mtime;
+      world_comm.broadcast(comm_key, temp_mtime);
+      mtime = (std::time_t) temp_mtime;
+    #else
+      ShapeMeshStore::mtime(filename, mtime);
+    #endif
+    const ShapeMeshStore::shape_def_entry_t* entry = NULL;
+
+    #ifdef USE_MPI
+      entry = store.find_shape_def(filename, mtime);
+      // nothing to do if all procs already have it
+      double have = (entry == NULL) ? 0.0 : 1.0, all_have = 0.0;
+      int min_rank = 0;
+      world_comm.allreduce(comm_key, have, all_have, min_rank, woo::comm::minloc);
+      if(all_have > 0.5) return entry;
+
+      real_vec_t shape_def;
+      unsigned int sizes[2] = { 0, 0 };   // number of triangles, size of shape_def
+      if(master) {
+        if(entry != NULL) {
+          shape_def = entry->shape_def_;
+          sizes[0] = entry->num_triangles_;
+        } else {
+          sizes[0] = read_shapes_file(filename, shape_def);
+        } // if-else
+        sizes[1] = shape_def.size();
+      } // if
+      world_comm.broadcast(comm_key, sizes, 2);
+      if(sizes[0] < 1 || sizes[1] < 1) return NULL;
+      if(!master) shape_def.resize(sizes[1]);
+      world_comm.broadcast(comm_key, &shape_def[0], sizes[1]);
+      if(entry != NULL) return entry;
+      return store.insert_shape_def(filename, mtime, sizes[0], shape_def);
+    #else
+      // grains may be processed by concurrent threads: one of them reads a file while
+      // the others wait for its store entry
+      #pragma omp critical (shape_file_load)
+      {
+        entry = store.find_shape_def(filename, mtime);
+        if(entry == NULL) {
+          real_vec_t shape_def;
+          unsigned int num_triangles = read_shapes_file(filename, shape_def);
+          if(num_triangles > 0)
+            entry = store.insert_shape_def(filename, mtime, num_triangles, shape_def);
+        } // if
+      } // omp critical
+      return entry;
+    #endif
+  } // NumericFormFactor::load_shape_def()
+
+
+  /**
+   * Return the triangles of an object file from the mesh store. When not loaded yet, only
+   * the master reads the file and sends the data to the other procs.
+   */
+  const ShapeMeshStore::triangles_entry_t* NumericFormFactor::load_triangles(const char* filename
+                          #ifdef USE_MPI
+                            , woo::MultiNode& world_comm, std::string comm_key
+                          #endif
+                          ) {
+    ShapeMeshStore& store = ShapeMeshStore::instance();
+    std::time_t mtime = 0;
+    #ifdef USE_MPI
+      bool master = world_comm.is_master(comm_key);
+      if(master) ShapeMeshStore::mtime(filename, mtime);
+      double temp_mtime = (double) mtime;
+      world_comm.broadcast(comm_key, temp_mtime);
+      mtime = (std::time_t) temp_mtime;
+    #else
+      ShapeMeshStore::mtime(filename, mtime);
+    #endif
+    const ShapeMeshStore::triangles_entry_t* entry = NULL;
+
+    #ifdef USE_MPI
+      entry = store.find_triangles(filename, mtime);
+      double have = (entry == NULL) ? 0.0 : 1.0, all_have = 0.0;
+      int min_rank = 0;
+      world_comm.allreduce(comm_key, have, all_have, min_rank, woo::comm::minloc);
+      if(all_have > 0.5) return entry;
+
+      std::vector<triangle_t> triangles;
+      unsigned int num_triangles = 0;
+      if(master) {
+        if(entry != NULL) triangles = entry->triangles_;
+        else read_triangles(filename, triangles);
+        num_triangles = triangles.size();
+      } // if
+      world_comm.broadcast(comm_key, &num_triangles, 1);
+      if(num_triangles < 1) return NULL;
+      if(!master) triangles.resize(num_triangles);
+      // triangle_t is a plain struct of 9 reals
+      world_comm.broadcast(comm_key, (real_t*) &triangles[0], 9 * num_triangles);
+      if(entry != NULL) return entry;
+      return store.insert_triangles(filename, mtime, triangles);
+    #else
+      #pragma omp critical (shape_file_load)
+      {
+        entry = store.find_triangles(filename, mtime);
+        if(entry == NULL) {
+          std::vector<triangle_t> triangles;
+          if(read_triangles(filename, triangles) && !triangles.empty())
+            entry = store.insert_triangles(filename, mtime, triangles);
+        } // if
+      } // omp critical
+      return entry;
+    #endif
+  } // NumericFormFactor::load_triangles()
+
+
+  bool NumericFormFactor::is_density_file(const char* filename) {
+    ShapeFileType type = get_shapes_file_format(filename);
+    if(type == shape_file_density) return true;
+    #ifdef USE_PARALLEL_HDF5
+      if(type == shape_file_hdf5) return HiGFileReader::instance().hdf5_is_density(filename);
+    #endif
+    return false;
+  } // NumericFormFactor::is_density_file()
+
+
+  /**
+   * Read a density grid, its size and voxel size.
+   */
+  bool NumericFormFactor::read_density(const char* filename, std::vector<real_t>& density,
+                                       unsigned int* dims, real_t* voxel) {
+    unsigned int num_voxels = 0;
+    if(get_shapes_file_format(filename) == shape_file_density) {
+      num_voxels = HiGFileReader::instance().raw_density_reader(filename, density, dims, voxel);
+    } else {
+      #ifdef USE_PARALLEL_HDF5
+        num_voxels = HiGFileReader::instance().hdf5_density_reader(filename, density, dims, voxel);
+      #else
+        std::cerr << "error: use of parallel hdf5 format has not been enabled in your installation. "
+                  << "Please reinstall with the support enabled." << std::endl;
+      #endif
+    } // if-else
+    return num_voxels > 0;
+  } // NumericFormFactor::read_density()
+
+
+  /**
+   * Return the transformed density grid from the mesh store. When not loaded yet, only the
+   * master reads the file and sends the data to the other procs, each of which transforms it.
+   */
+  const ShapeMeshStore::density_entry_t* NumericFormFactor::load_density(const char* filename
+                          #ifdef USE_MPI
+                            , woo::MultiNode& world_comm, std::string comm_key
+                          #endif
+                          ) {
+    ShapeMeshStore& store = ShapeMeshStore::instance();
+    std::time_t mtime = 0;
+    #ifdef USE_MPI
+      bool master = world_comm.is_master(comm_key);
+      if(master) ShapeMeshStore::mtime(filename, mtime);
+      double temp_mtime = (double) mtime;
+      world_comm.broadcast(comm_key, temp_mtime);
+      mtime = (std::time_t) temp_mtime;
+    #else
+      ShapeMeshStore::mtime(filename, mtime);
+    #endif
+    const ShapeMeshStore::density_entry_t* entry = NULL;
+
+    #ifdef USE_MPI
+      entry = store.find_density(filename, mtime, density_pad_);
+      double have = (entry == NULL) ? 0.0 : 1.0, all_have = 0.0;
+      int min_rank = 0;
+      world_comm.allreduce(comm_key, have, all_have, min_rank, woo::comm::minloc);
+      if(all_have > 0.5) return entry;
+
+      std::vector<real_t> density;
+      unsigned int dims[3] = { 0, 0, 0 };
+      real_t voxel[3] = { 0., 0., 0. };
+      if(master && !read_density(filename, density, dims, voxel)) dims[0] = 0;
+      world_comm.broadcast(comm_key, dims, 3);
+      if(dims[0] < 1) return NULL;
+      world_comm.broadcast(comm_key, voxel, 3);
+      if(!master) density.resize((size_t) dims[0] * dims[1] * dims[2]);
+      world_comm.broadcast(comm_key, &density[0], density.size());
+      if(entry != NULL) return entry;
+      return store.insert_density(filename, mtime, density, dims, voxel, density_pad_);
+    #else
+      #pragma omp critical (shape_file_load)
+      {
+        entry = store.find_density(filename, mtime, density_pad_);
+        if(entry == NULL) {
+          std::vector<real_t> density;
+          unsigned int dims[3];
+          real_t voxel[3];
+          if(read_density(filename, density, dims, voxel))
+            entry = store.insert_density(filename, mtime, density, dims, voxel, density_pad_);
+        } // if
+      } // omp critical
+      return entry;
+    #endif
+  } // NumericFormFactor::load_density()
 } // namespace hig
@@ -120,7 +120,7 @@ namespace hig {
           cucomplex_t q_dot_nv = cuC_dot(mq, n_v);
 
           // calculate contribution of vertex a
-          cucomplex_t c0 = jn * q_dot_nt * q_dot_ne * q_dot_nv;
+          cucomplex_t c0 = jp * q_dot_nt * q_dot_ne * q_dot_nv;
           cucomplex_t c1 = cuCexp(jn * q_dot_v);
           ff = ff + c0 * c1 / f0;
 
@@ -132,7 +132,7 @@ namespace hig {
           q_dot_nv = cuC_dot(mq, n_v * REAL_MINUS_ONE_);
 
           // calculate contribution of the other vertex
-          c0 = jn * q_dot_nt * q_dot_ne * q_dot_nv;
+          c0 = jp * q_dot_nt * q_dot_ne * q_dot_nv;
           c1 = cuCexp(jn * q_dot_v);
           ff = ff + c0 * c1 / f0;
         }
@@ -208,7 +208,7 @@ namespace hig {
    * The main host function called from outside, as part of the API for a single node.
    */
   unsigned int NumericFormFactorG::compute_exact_triangle(
-            triangle_t * triangles, int num_triangles,
+            const triangle_t * triangles, int num_triangles,
             cucomplex_t *& ff,
             int nqy, real_t * qx_h, real_t * qy_h, 
             int nqz, cucomplex_t * qz_h,
@@ -393,7 +393,7 @@ namespace hig {
    * The main host function called from outside, as part of the API for a single node.
    */
   unsigned int NumericFormFactorG::compute_approx_triangle(
-            std::vector<real_t> & shape_def, 
+            const std::vector<real_t> & shape_def, 
             cucomplex_t * & ff,
             int nqy, real_t * qx_h, real_t * qy_h,
             int nqz, cucomplex_t * qz_h,
@@ -466,7 +466,7 @@ namespace hig {
 
     // copy triangles
     real_t * shape_def_d;
-    real_t * shape_def_h = &shape_def[0];
+    const real_t * shape_def_h = &shape_def[0];
     err = cudaMalloc((void **) &shape_def_d, T_PROP_SIZE_ * num_triangles * sizeof(real_t));
     if(err != cudaSuccess) {
       std::cerr << "Device memory allocation failed for triangles. "
@@ -0,0 +1,157 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: shape_mesh_store.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+
+#include <ff/shape_mesh_store.hpp>
+
+namespace hig {
+
+  bool ShapeMeshStore::mtime(const std::string& filename, std::time_t& t) {
+    boost::system::error_code ec;
+    t = boost::filesystem::last_write_time(filename, ec);
+    if(ec) {
+      std::cerr << "error: could not access shape file " << filename << std::endl;
+      t = 0;
+      return false;
+    } // if
+    return true;
+  } // ShapeMeshStore::mtime()
+
+
+  /* the maps are only accessed in the critical section shape_mesh_store, since the store
+   * is shared by all the threads and simulations of the process. entries are read-only */
+
+  const ShapeMeshStore::shape_def_entry_t* ShapeMeshStore::find_shape_def(
+      const std::string& filename, std::time_t t) const {
+    const shape_def_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      std::map<version_t, shape_def_entry_t>::const_iterator i =
+        shape_defs_.find(version_t(filename, t));
+      if(i != shape_defs_.end()) entry = &(*i).second;
+    } // omp critical
+    return entry;
+  } // ShapeMeshStore::find_shape_def()
+
+
+  const ShapeMeshStore::triangles_entry_t* ShapeMeshStore::find_triangles(
+      const std::string& filename, std::time_t t) const {
+    const triangles_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      std::map<version_t, triangles_entry_t>::const_iterator i =
+        triangles_.find(version_t(filename, t));
+      if(i != triangles_.end()) entry = &(*i).second;
+    } // omp critical
+    return entry;
+  } // ShapeMeshStore::find_triangles()
+
+
+  const ShapeMeshStore::density_entry_t* ShapeMeshStore::find_density(
+      const std::string& filename, std::time_t t, unsigned int padding) const {
+    const density_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      std::map<density_key_t, density_entry_t>::const_iterator i =
+        densities_.find(density_key_t(version_t(filename, t), padding));
+      if(i != densities_.end()) entry = &(*i).second;
+    } // omp critical
+    return entry;
+  } // ShapeMeshStore::find_density()
+
+
+  const ShapeMeshStore::shape_def_entry_t* ShapeMeshStore::insert_shape_def(
+      const std::string& filename, std::time_t t, unsigned int num_triangles,
+      real_vec_t& shape_def) {
+    shape_def_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      std::pair<std::map<version_t, shape_def_entry_t>::iterator, bool> ins =
+        shape_defs_.insert(std::make_pair(version_t(filename, t), shape_def_entry_t()));
+      entry = &(*ins.first).second;
+      if(ins.second) {    // otherwise already present, possibly in use
+        entry->mtime_ = t;
+        entry->num_triangles_ = num_triangles;
+        entry->shape_def_.swap(shape_def);
+      } // if
+    } // omp critical
+    shape_def.clear();
+    return entry;
+  } // ShapeMeshStore::insert_shape_def()
+
+
+  const ShapeMeshStore::triangles_entry_t* ShapeMeshStore::insert_triangles(
+      const std::string& filename, std::time_t t, std::vector<triangle_t>& triangles) {
+    triangles_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      std::pair<std::map<version_t, triangles_entry_t>::iterator, bool> ins =
+        triangles_.insert(std::make_pair(version_t(filename, t), triangles_entry_t()));
+      entry = &(*ins.first).second;
+      if(ins.second) {    // otherwise already present, possibly in use
+        entry->mtime_ = t;
+        entry->triangles_.swap(triangles);
+        // the q-independent triangle geometry is computed once per mesh. the tree reorders
+        // the triangles, so it is built first, and the table follows the same order
+        if(!entry->triangles_.empty()) {
+          entry->tree_.build(entry->triangles_);
+          entry->table_.build(&entry->triangles_[0], entry->triangles_.size());
+        } // if
+      } // if
+    } // omp critical
+    triangles.clear();
+    return entry;
+  } // ShapeMeshStore::insert_triangles()
+
+
+  const ShapeMeshStore::density_entry_t* ShapeMeshStore::insert_density(
+      const std::string& filename, std::time_t t, const std::vector<real_t>& density,
+      const unsigned int* dims, const real_t* voxel, unsigned int padding) {
+    density_entry_t* entry = NULL;
+    #pragma omp critical (shape_mesh_store)
+    {
+      density_key_t key(version_t(filename, t), padding);
+      std::pair<std::map<density_key_t, density_entry_t>::iterator, bool> ins =
+        densities_.insert(std::make_pair(key, density_entry_t()));
+      entry = &(*ins.first).second;
+      if(ins.second) {    // otherwise already present, possibly in use
+        entry->mtime_ = t;
+        entry->padding_ = padding;
+        // the transform is done once per grid, and serves all grains and orientations
+        if(density.empty() || !entry->grid_.build(&density[0], dims, voxel, padding)) {
+          densities_.erase(ins.first);    // new, not handed out yet
+          entry = NULL;
+        } // if
+      } // if
+    } // omp critical
+    return entry;
+  } // ShapeMeshStore::insert_density()
+
+
+  void ShapeMeshStore::clear() {
+    #pragma omp critical (shape_mesh_store)
+    {
+      shape_defs_.clear();
+      triangles_.clear();
+      densities_.clear();
+    } // omp critical
+  } // ShapeMeshStore::clear()
+
+} // namespace hig
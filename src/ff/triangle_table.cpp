@@ -0,0 +1,120 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: triangle_table.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <ff/triangle_table.hpp>
+#include <numerics/numeric_utils.hpp>
+
+namespace hig {
+
+  TriangleTable::TriangleTable(const TriangleTable& other):
+      num_triangles_(0), stride_(0), data_(NULL) {
+    *this = other;
+  } // TriangleTable::TriangleTable()
+
+
+  TriangleTable& TriangleTable::operator=(const TriangleTable& other) {
+    if(this == &other) return *this;
+    release();
+    if(other.num_triangles_ > 0 && allocate(other.num_triangles_)) {
+      memcpy(data_, other.data_, (size_t) num_fields_ * stride_ * sizeof(real_t));
+      flags_ = other.flags_;
+      cluster_radius_ = other.cluster_radius_;
+    } // if
+    return *this;
+  } // TriangleTable::operator=()
+
+
+  bool TriangleTable::allocate(unsigned int num_triangles) {
+    unsigned int stride = (num_triangles + 7) & ~7u;
+    void* mem = NULL;
+    if(posix_memalign(&mem, 64, (size_t) num_fields_ * stride * sizeof(real_t)) != 0) {
+      std::cerr << "error: failed to allocate the triangle table for "
+                << num_triangles << " triangles" << std::endl;
+      return false;
+    } // if
+    data_ = (real_t*) mem;
+    // padding entries stay zero, and are flagged degenerate
+    memset(data_, 0, (size_t) num_fields_ * stride * sizeof(real_t));
+    num_triangles_ = num_triangles;
+    stride_ = stride;
+    flags_.assign(stride, tri_degenerate_);
+    return true;
+  } // TriangleTable::allocate()
+
+
+  void TriangleTable::release() {
+    free(data_);
+    data_ = NULL;
+    num_triangles_ = 0;
+    stride_ = 0;
+    flags_.clear();
+    cluster_radius_.clear();
+  } // TriangleTable::release()
+
+
+  bool TriangleTable::build(const triangle_t* triangles, unsigned int num_triangles) {
+    release();
+    if(num_triangles < 1) return true;
+    if(!allocate(num_triangles)) return false;
+
+    for(unsigned int t = 0; t < num_triangles; ++ t) {
+      const triangle_t& tri = triangles[t];
+      vector3_t vertex[3] = { vector3_t(tri.v1[0], tri.v1[1], tri.v1[2]),
+                              vector3_t(tri.v2[0], tri.v2[1], tri.v2[2]),
+                              vector3_t(tri.v3[0], tri.v3[1], tri.v3[2]) };
+      vector3_t edge[3] = { vertex[1] - vertex[0], vertex[2] - vertex[1], vertex[0] - vertex[2] };
+      for(int i = 0; i < 3; ++ i)
+        for(int d = 0; d < 3; ++ d) data_[(vertex_ + 3 * i + d) * stride_ + t] = vertex[i][d];
+      vector3_t centroid = (vertex[0] + vertex[1] + vertex[2]) / 3.;
+      real_t radius = 0.;
+      for(int i = 0; i < 3; ++ i) radius = std::max(radius, (vertex[i] - centroid).abs());
+      for(int d = 0; d < 3; ++ d) data_[(centroid_ + d) * stride_ + t] = centroid[d];
+      data_[radius_ * stride_ + t] = radius;
+
+      vector3_t n_t = cross(edge[0], edge[1]);
+      real_t n_abs = n_t.abs();
+      if(!(n_abs > 0)) continue;    // degenerate, leave the rest zero
+      n_t = n_t / n_abs;
+      for(int d = 0; d < 3; ++ d) data_[(normal_ + d) * stride_ + t] = n_t[d];
+      data_[area_ * stride_ + t] = 0.5 * n_abs;
+
+      for(int e = 0; e < 3; ++ e) {
+        vector3_t n_e = cross(edge[e], n_t);
+        n_e = n_e / n_e.abs();
+        real_t len = edge[e].abs();
+        vector3_t n_v = edge[e] / len;
+        for(int d = 0; d < 3; ++ d) {
+          data_[(edge_normal_ + 3 * e + d) * stride_ + t] = n_e[d];
+          data_[(edge_dir_ + 3 * e + d) * stride_ + t] = n_v[d];
+        } // for
+        data_[(edge_len_ + e) * stride_ + t] = len;
+      } // for
+      flags_[t] = tri_regular_;
+    } // for
+
+    cluster_radius_.assign((num_triangles + cluster_size_ - 1) / cluster_size_, 0.);
+    for(unsigned int t = 0; t < num_triangles; ++ t)
+      cluster_radius_[t / cluster_size_] = std::max(cluster_radius_[t / cluster_size_],
+                                                    data_[radius_ * stride_ + t]);
+    return true;
+  } // TriangleTable::build()
+
+} // namespace hig
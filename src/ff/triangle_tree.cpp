@@ -0,0 +1,193 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: triangle_tree.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <ff/triangle_tree.hpp>
+#include <numerics/numeric_utils.hpp>
+
+namespace hig {
+
+  // bound on the tree depth, nodes this deep are kept as leaves
+  static const unsigned int MAX_TREE_DEPTH_ = 32;
+
+
+  bool TriangleTree::build(std::vector<triangle_t>& triangles, unsigned int leaf_size) {
+    clear();
+    if(triangles.empty()) return true;
+    if(leaf_size < 1) {
+      std::cerr << "error: invalid leaf size for the triangle tree" << std::endl;
+      return false;
+    } // if
+
+    std::vector<real_t> centroids(3 * triangles.size());
+    for(unsigned int t = 0; t < triangles.size(); ++ t)
+      for(int d = 0; d < 3; ++ d)
+        centroids[3 * t + d] = (triangles[t].v1[d] + triangles[t].v2[d] + triangles[t].v3[d]) / 3.;
+
+    node_t root;
+    memset(&root, 0, sizeof(node_t));
+    root.begin_ = 0; root.end_ = triangles.size();
+    nodes_.push_back(root);
+    depth_ = 1;
+    split(0, triangles, centroids, leaf_size, 1);
+    for(unsigned int i = 0; i < nodes_.size(); ++ i) moments(nodes_[i], triangles);
+    return true;
+  } // TriangleTree::build()
+
+
+  /**
+   * split a node into octants of the bounding box of its centroids, and recurse.
+   * the triangles and their centroids are reordered by octant.
+   */
+  void TriangleTree::split(unsigned int n, std::vector<triangle_t>& triangles,
+                           std::vector<real_t>& centroids, unsigned int leaf_size,
+                           unsigned int depth) {
+    nodes_[n].first_child_ = -1;
+    nodes_[n].num_children_ = 0;
+    unsigned int begin = nodes_[n].begin_, end = nodes_[n].end_;
+    if(end - begin <= leaf_size || depth >= MAX_TREE_DEPTH_) return;
+
+    real_t lo[3], hi[3];
+    for(int d = 0; d < 3; ++ d) lo[d] = hi[d] = centroids[3 * begin + d];
+    for(unsigned int t = begin + 1; t < end; ++ t)
+      for(int d = 0; d < 3; ++ d) {
+        lo[d] = std::min(lo[d], centroids[3 * t + d]);
+        hi[d] = std::max(hi[d], centroids[3 * t + d]);
+      } // for
+    real_t mid[3];
+    bool flat = true;
+    for(int d = 0; d < 3; ++ d) {
+      mid[d] = 0.5 * (lo[d] + hi[d]);
+      if(hi[d] > lo[d]) flat = false;
+    } // for
+    if(flat) return;      // coincident centroids, keep as a leaf
+
+    // counting sort of the range by octant
+    std::vector<unsigned char> octant(end - begin);
+    unsigned int count[8] = { 0 };
+    for(unsigned int t = begin; t < end; ++ t) {
+      unsigned char o = 0;
+      for(int d = 0; d < 3; ++ d) if(centroids[3 * t + d] > mid[d]) o |= (1 << d);
+      octant[t - begin] = o;
+      ++ count[o];
+    } // for
+    unsigned int offset[8];
+    offset[0] = 0;
+    for(int o = 1; o < 8; ++ o) offset[o] = offset[o - 1] + count[o - 1];
+    std::vector<triangle_t> tri_buf(end - begin);
+    std::vector<real_t> cen_buf(3 * (end - begin));
+    unsigned int pos[8];
+    std::copy(offset, offset + 8, pos);
+    for(unsigned int t = begin; t < end; ++ t) {
+      unsigned int p = pos[octant[t - begin]] ++;
+      tri_buf[p] = triangles[t];
+      for(int d = 0; d < 3; ++ d) cen_buf[3 * p + d] = centroids[3 * t + d];
+    } // for
+    std::copy(tri_buf.begin(), tri_buf.end(), triangles.begin() + begin);
+    std::copy(cen_buf.begin(), cen_buf.end(), centroids.begin() + 3 * begin);
+    std::vector<triangle_t>().swap(tri_buf);
+    std::vector<real_t>().swap(cen_buf);
+
+    // children are appended consecutively, before recursing into any of them
+    int first = nodes_.size(), num = 0;
+    for(int o = 0; o < 8; ++ o) {
+      if(count[o] == 0) continue;
+      node_t child;
+      memset(&child, 0, sizeof(node_t));
+      child.begin_ = begin + offset[o];
+      child.end_ = begin + offset[o] + count[o];
+      nodes_.push_back(child);
+      ++ num;
+    } // for
+    nodes_[n].first_child_ = first;
+    nodes_[n].num_children_ = num;
+    depth_ = std::max(depth_, depth + 1);
+    for(int c = 0; c < num; ++ c) split(first + c, triangles, centroids, leaf_size, depth + 1);
+  } // TriangleTree::split()
+
+
+  /**
+   * compute the center, radius and surface moments of a node
+   */
+  void TriangleTree::moments(node_t& node, const std::vector<triangle_t>& triangles) const {
+    // center: area weighted mean of the centroids
+    real_t area = 0., center[3] = { 0., 0., 0. }, mean[3] = { 0., 0., 0. };
+    for(unsigned int t = node.begin_; t < node.end_; ++ t) {
+      const triangle_t& tri = triangles[t];
+      vector3_t e1(tri.v2[0] - tri.v1[0], tri.v2[1] - tri.v1[1], tri.v2[2] - tri.v1[2]);
+      vector3_t e2(tri.v3[0] - tri.v2[0], tri.v3[1] - tri.v2[1], tri.v3[2] - tri.v2[2]);
+      real_t a = 0.5 * cross(e1, e2).abs();
+      for(int d = 0; d < 3; ++ d) {
+        real_t c = (tri.v1[d] + tri.v2[d] + tri.v3[d]) / 3.;
+        center[d] += a * c;
+        mean[d] += c;
+      } // for
+      area += a;
+    } // for
+    for(int d = 0; d < 3; ++ d)
+      node.center_[d] = (area > 0) ? center[d] / area : mean[d] / (node.end_ - node.begin_);
+    node.area_ = area;
+
+    real_t radius = 0.;
+    for(int i = 0; i < 3; ++ i) node.m0_[i] = 0.;
+    for(int i = 0; i < 9; ++ i) node.m1_[i] = 0.;
+    for(int i = 0; i < 18; ++ i) node.m2_[i] = 0.;
+    // index pairs of the symmetric second moments
+    static const int bc[6][2] = { { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 1 }, { 1, 2 }, { 2, 2 } };
+    for(unsigned int t = node.begin_; t < node.end_; ++ t) {
+      const triangle_t& tri = triangles[t];
+      const real_t* v[3] = { tri.v1, tri.v2, tri.v3 };
+      real_t w[3][3], d[3];
+      for(int i = 0; i < 3; ++ i) {
+        real_t r2 = 0.;
+        for(int k = 0; k < 3; ++ k) {
+          real_t x = v[i][k] - node.center_[k];
+          r2 += x * x;
+        } // for
+        radius = std::max(radius, (real_t) std::sqrt(r2));
+      } // for
+      for(int k = 0; k < 3; ++ k) d[k] = (v[0][k] + v[1][k] + v[2][k]) / 3. - node.center_[k];
+      for(int i = 0; i < 3; ++ i)
+        for(int k = 0; k < 3; ++ k) w[i][k] = v[i][k] - node.center_[k] - d[k];
+
+      vector3_t e1(v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2]);
+      vector3_t e2(v[2][0] - v[1][0], v[2][1] - v[1][1], v[2][2] - v[1][2]);
+      vector3_t n = cross(e1, e2);
+      real_t n_abs = n.abs();
+      if(!(n_abs > 0)) continue;    // degenerate
+      real_t a = 0.5 * n_abs;
+      n = n / n_abs;
+
+      // int_t d_b d_c = A (d_b d_c + sum_i w_ib w_ic / 12), w_i = v_i - centroid
+      real_t s[6];
+      for(int j = 0; j < 6; ++ j) {
+        int b = bc[j][0], c = bc[j][1];
+        s[j] = a * (d[b] * d[c] + (w[0][b] * w[0][c] + w[1][b] * w[1][c] + w[2][b] * w[2][c]) / 12.);
+      } // for
+      for(int i = 0; i < 3; ++ i) {
+        node.m0_[i] += n[i] * a;
+        for(int k = 0; k < 3; ++ k) node.m1_[3 * i + k] += n[i] * a * d[k];
+        for(int j = 0; j < 6; ++ j) node.m2_[6 * i + j] += n[i] * s[j];
+      } // for
+    } // for
+    node.radius_ = radius;
+  } // TriangleTree::moments()
+
+} // namespace hig
@@ -15,195 +15,282 @@
  */
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
 #include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <file/edf_reader.hpp>
 
 namespace hig {
 
-  EDFReader::EDFReader(const char* filename) {
-    std::ifstream infile(filename, std::ios::in | std::ios::binary);
-    if(!infile.is_open()) {
-      std::cerr << "error: could not open the EDF file " << filename << std::endl;
-      exit(1);
-    } // if
-    char* dataseg = new (std::nothrow) char[EDF_CHUNK_SIZE];  // 512 byte blocks
-    // read block of header
-    if(!extract_header(infile, dataseg, EDF_CHUNK_SIZE)) exit(1);
-    if(!extract_data(infile, dataseg, EDF_CHUNK_SIZE)) exit(1);
-    infile.close();
-    delete[] dataseg;
-    //print_header();
-    //print_data();
+  static bool edf_host_little_endian() {
+    const uint16_t one = 1;
+    return *(const unsigned char*) &one == 1;
+  } // edf_host_little_endian()
+
+  static std::string edf_trim(const char* begin, const char* end) {
+    while(begin < end && std::isspace((unsigned char) *begin)) ++ begin;
+    while(end > begin && std::isspace((unsigned char) *(end - 1))) -- end;
+    return std::string(begin, end);
+  } // edf_trim()
+
+  static EDFDataType edf_data_type(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if(name == "floatvalue" || name == "float" || name == "floatieee32") return edf_type_float32;
+    if(name == "doublevalue" || name == "double" || name == "doubleieee64") return edf_type_float64;
+    if(name == "signedbyte") return edf_type_int8;
+    if(name == "unsignedbyte" || name == "unsignedchar") return edf_type_uint8;
+    if(name == "signedshort" || name == "signedshortinteger") return edf_type_int16;
+    if(name == "unsignedshort" || name == "unsignedshortinteger") return edf_type_uint16;
+    if(name == "signedinteger" || name == "signedlong" || name == "signedlonginteger")
+      return edf_type_int32;
+    if(name == "unsignedinteger" || name == "unsignedlong" || name == "unsignedlonginteger")
+      return edf_type_uint32;
+    return edf_type_error;
+  } // edf_data_type()
+
+
+  EDFReader::EDFReader(const char* filename): map_(NULL), map_size_(0) {
+    if(!parse(filename)) exit(1);
+    //print_header(0);
   } // EDFReader::EDFReader()
 
 
-  bool EDFReader::is_white_space(char c) {
-    if(c == ' '
-      || c == '\n'
-      || c == '\t'
-      || c == '\r') return true;
-    return false;
-  } // EDFReader::is_white_space()
-
-
-  bool EDFReader::get_next_item(char* chunk, int& counter, const int max_size,
-                  char* key, int& i_k, bool& end_k,
-                  char* value, int& i_v, bool& end_v) {
-    if(!end_k) {
-      // read key
-      while(1) {
-        char curr = chunk[counter ++];
-        //std::cout << counter << " ==> " << curr << std::endl;
-        if(curr == '=') { key[i_k] = '\0'; end_k = true; break; }    // end of keyword
-        if(!is_white_space(curr)) // skip white spaces
-          key[i_k ++] = curr;
-        if(counter == max_size) break;
-        if(curr == '}') { -- counter; return false; }
-      } // while
+  EDFReader::~EDFReader() {
+    if(map_ != NULL) munmap((void*) map_, map_size_);
+  } // EDFReader::~EDFReader()
+
+
+  size_t EDFReader::type_size(EDFDataType t) {
+    switch(t) {
+      case edf_type_int8: case edf_type_uint8: return 1;
+      case edf_type_int16: case edf_type_uint16: return 2;
+      case edf_type_int32: case edf_type_uint32: case edf_type_float32: return 4;
+      case edf_type_float64: return 8;
+      default: return 0;
+    } // switch
+  } // EDFReader::type_size()
+
+
+  /* map the file and parse the headers of all frames */
+  bool EDFReader::parse(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+      std::cerr << "error: could not open the EDF file " << filename << std::endl;
+      return false;
     } // if
-    if(counter == max_size) return false;
-    if(!end_v) {
-      // read value
-      while(1) {
-        char curr = chunk[counter ++];
-        //std::cout << curr << std::endl;
-        if(curr == ';') { value[i_v] = '\0'; end_v = true; break; }    // end of keyword
-        if(!is_white_space(curr))  // skip white spaces
-          value[i_v ++] = curr;
-        if(counter == max_size) break;
-      } // while
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+      std::cerr << "error: could not read the EDF file " << filename << std::endl;
+      close(fd);
+      return false;
     } // if
-    if(!end_v) return false;
-    return true;
-  } // EDFReader::get_next_item()
-
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED) {
+      std::cerr << "error: could not map the EDF file " << filename << std::endl;
+      return false;
+    } // if
+    map_ = (const char*) map;
+    map_size_ = st.st_size;
 
-  inline bool EDFReader::header_done(char* chunk, const int counter, const int max_size) {
-    int mycount = counter;
+    size_t pos = 0;
     while(1) {
-      char curr = chunk[mycount ++];
-      if(curr == '}') return true;
-      if(mycount == max_size) break;    // reached the end of the chunk
-      if(is_white_space(curr)) continue;
-      break;  // curr is some other character => more stuff
+      while(pos < map_size_ && std::isspace((unsigned char) map_[pos])) ++ pos;
+      if(pos >= map_size_) break;
+      Frame frame;
+      if(!parse_header(pos, frame)) return false;
+      frames_.push_back(frame);
     } // while
-    return false;
-  } // EDFReader::header_done()
+    if(frames_.empty()) {
+      std::cerr << "error: no frames in the EDF file " << filename << std::endl;
+      return false;
+    } // if
+    return true;
+  } // EDFReader::parse()
 
 
-  bool EDFReader::extract_header(std::ifstream& infile, char* chunk, size_t size) {
-    char key[size], value[size];
-    int counter = 0, i_k = 0, i_v = 0;
-    bool end_k = false, end_v = false;
-    infile.read(chunk, size);
-    while(1) {
-      if(!get_next_item(chunk, counter, size, key, i_k, end_k, value, i_v, end_v)) {
-        if(header_done(chunk, counter, size)) break;
-        counter = 0;
-        infile.read(chunk, size);
-        continue;
-      } // if
-      // we have a new key value pair
-      header_[std::string(key)] = std::string(value);
-      //std::cout << "****** [" << counter << "] " << key << " -> " << value << std::endl;
-      i_k = 0; i_v = 0;
-      end_k = false; end_v = false;
-      if(header_done(chunk, counter, size)) break;
-    } // while
+  /* parse the header at pos, and move pos past the frame payload */
+  bool EDFReader::parse_header(size_t& pos, Frame& frame) {
+    const char* begin = map_ + pos;
+    const char* end = map_ + map_size_;
+    if(*begin != '{') {
+      std::cerr << "error: missing EDF header at byte " << pos << std::endl;
+      return false;
+    } // if
+    const char* close = (const char*) std::memchr(begin, '}', end - begin);
+    if(close == NULL) {
+      std::cerr << "error: unterminated EDF header" << std::endl;
+      return false;
+    } // if
+    // "key = value ;" items
+    for(const char* item = begin + 1; item < close; ) {
+      const char* semi = std::find(item, close, ';');
+      const char* eq = std::find(item, semi, '=');
+      if(eq < semi) frame.header_[edf_trim(item, eq)] = edf_trim(eq + 1, semi);
+      item = semi + 1;
+    } // for
+    const char* data = close + 1;
+    if(data < end && *data == '\r') ++ data;
+    if(data < end && *data == '\n') ++ data;
+    std::map <std::string, std::string>& h = frame.header_;
+    if(h.count("EDF_HeaderSize") > 0) data = begin + atol(h["EDF_HeaderSize"].c_str());
+
+    frame.cols_ = atoi(h["Dim_1"].c_str());
+    frame.rows_ = (h.count("Dim_2") > 0) ? atoi(h["Dim_2"].c_str()) : 1;
+    frame.type_ = edf_data_type(h["DataType"]);
+    if(h.count("DataType") == 0) frame.type_ = edf_type_float32;
+    if(frame.type_ == edf_type_error) {
+      std::cerr << "error: unsupported EDF data type '" << h["DataType"] << "'" << std::endl;
+      return false;
+    } // if
+    bool big = (h["ByteOrder"] == "HighByteFirst");
+    frame.native_ = (big != edf_host_little_endian()) || type_size(frame.type_) == 1;
+    size_t size = (size_t) frame.rows_ * frame.cols_ * type_size(frame.type_);
+    if(h.count("EDF_BinarySize") > 0) size = atol(h["EDF_BinarySize"].c_str());
+    else if(h.count("Size") > 0) size = atol(h["Size"].c_str());
+    frame.offset_ = data - map_;
+    if(size != (size_t) frame.rows_ * frame.cols_ * type_size(frame.type_) ||
+       frame.offset_ + size > map_size_) {
+      std::cerr << "error: mismatch in EDF data size" << std::endl;
+      std::cerr << "error: cols = " << frame.cols_ << ", rows = " << frame.rows_ << std::endl;
+      std::cerr << "error: size = " << size << std::endl;
+      return false;
+    } // if
+    pos = frame.offset_ + size;
+    return true;
+  } // EDFReader::parse_header()
 
-    cols_ = convert_to_unsigned(std::string("Dim_1"));
-    rows_ = convert_to_unsigned(std::string("Dim_2"));
 
-    //std::cout << "*** Header reading done. " << std::endl;
+  bool EDFReader::header(unsigned int i, const std::string& key, std::string& value) const {
+    if(i >= frames_.size()) return false;
+    std::map <std::string, std::string>::const_iterator k = frames_[i].header_.find(key);
+    if(k == frames_[i].header_.end()) return false;
+    value = (*k).second;
+    return true;
+  } // EDFReader::header()
 
-    return true;  /* to signal that header was complete */
-  } // EDFReader::extract_header()
 
+  /* convert n values of type T, byte swapped if needed */
+  template <typename T>
+  static void edf_convert(const char* src, size_t n, bool swap, real_t* dst) {
+    for(size_t i = 0; i < n; ++ i) {
+      T v;
+      std::memcpy(&v, src + i * sizeof(T), sizeof(T));
+      if(swap) {
+        char* b = reinterpret_cast<char*>(&v);
+        std::reverse(b, b + sizeof(T));
+      } // if
+      dst[i] = (real_t) v;
+    } // for
+  } // edf_convert()
 
-  inline unsigned int EDFReader::convert_to_unsigned(const std::string& key) {
-    return atoi(header_[key].c_str());
-  } // EDFReader::convert_to_unsigned()
 
+  bool EDFReader::frame(unsigned int i, const real_t*& data, unsigned int& ny, unsigned int& nz) {
+    if(i >= frames_.size()) return false;
+    const Frame& f = frames_[i];
+    ny = f.cols_;
+    nz = f.rows_;
+    data = view<real_t>(i);
+    if(data != NULL) return true;
 
-  bool EDFReader::extract_data(std::ifstream& infile, char* chunk, size_t size) {
-    unsigned long int num_bytes = atol(header_[std::string("EDF_BinarySize")].c_str());
-    typedef float real_t;
-    real_t* data;
-    unsigned long int count = 0;
-    data_.clear();
-    while(count != num_bytes) {
-      infile.read(chunk, size);
-      data = reinterpret_cast<real_t*>(chunk);
-      int len = std::min(size, (num_bytes - count));
-      for(int i = 0; i < len / sizeof(real_t); ++ i) data_.push_back((real_t) data[i]);
-      count += len;
-      //std::cout << "****** " << count << std::endl;
-    } // while
-    if(data_.size() != cols_ * rows_) {
-      std::cerr << "error: mismatch in reference data size" << std::endl;
-      std::cerr << "error: cols_ = " << cols_ << ", rows_ = " << rows_ << std::endl;
-      std::cerr << "error: data_.size() = " << data_.size() << std::endl;
-      return false;
-    } // if
-    //std::cout << "*** Data reading done." << std::endl;
+    size_t n = (size_t) f.rows_ * f.cols_;
+    data_.resize(n);
+    const char* src = map_ + f.offset_;
+    bool swap = !f.native_;
+    switch(f.type_) {
+      case edf_type_int8: edf_convert<int8_t>(src, n, swap, &data_[0]); break;
+      case edf_type_uint8: edf_convert<uint8_t>(src, n, swap, &data_[0]); break;
+      case edf_type_int16: edf_convert<int16_t>(src, n, swap, &data_[0]); break;
+      case edf_type_uint16: edf_convert<uint16_t>(src, n, swap, &data_[0]); break;
+      case edf_type_int32: edf_convert<int32_t>(src, n, swap, &data_[0]); break;
+      case edf_type_uint32: edf_convert<uint32_t>(src, n, swap, &data_[0]); break;
+      case edf_type_float32: edf_convert<float>(src, n, swap, &data_[0]); break;
+      case edf_type_float64: edf_convert<double>(src, n, swap, &data_[0]); break;
+      default: return false;
+    } // switch
+    data = &data_[0];
     return true;
-  } // EDFReader::extract_data()
+  } // EDFReader::frame()
 
 
-  bool EDFReader::get_data(real_t*& data, unsigned int& ny, unsigned int& nz) {
-    if(data_.size() < 1) return false;
-    data = &(data_[0]);
-    ny = cols_;
-    nz = rows_;
-    return true;
+  bool EDFReader::get_data(const real_t*& data, unsigned int& ny, unsigned int& nz) {
+    return frame(0, data, ny, nz);
   } // EDFReader::get_data()
-  
 
-  void EDFReader::print_header(void) {
-    for(std::map <std::string, std::string> ::iterator i = header_.begin(); i != header_.end(); ++ i)
-      std::cout << "-- " << (*i).first << " --> " << (*i).second << std::endl;
-  } // EDFReader::print_header()
 
-  void EDFReader::print_data(void) {
-    for(unsigned int i = 0; i < rows_; ++ i) {
-      for(unsigned int j = 0; j < cols_; ++ j) {
-        unsigned int idx = i * cols_ + j;
-        std::cout << data_[idx] << " ";
-      } // for
-      std::cout << std::endl;
-    } // for
-  } // EDFReader::preint_data()
+  void EDFReader::print_header(unsigned int i) {
+    for(std::map <std::string, std::string> ::iterator k = frames_[i].header_.begin();
+        k != frames_[i].header_.end(); ++ k)
+      std::cout << "-- " << (*k).first << " --> " << (*k).second << std::endl;
+  } // EDFReader::print_header()
 
 
   /******* EDF Writer ********/
-  void EDFWriter::Write(real_t * data){
-    std::fstream edf(filename_, std::ios::out | std::ios::binary);
+
+  /* header of frame i of n, padded to a multiple of EDF_CHUNK_SIZE */
+  std::string EDFWriter::header(unsigned int i, unsigned int n) const {
+    std::ostringstream h;
+    h << "{\n"
+      << "HeaderID = EH:" << std::setw(6) << std::setfill('0') << i + 1 << ":000000:000000 ;\n"
+      << std::setfill(' ')
+      << "Image = " << i + 1 << " ;\n"
+      << "ByteOrder = " << (edf_host_little_endian() ? "LowByteFirst" : "HighByteFirst") << " ;\n"
+      << "DataType = FloatValue ;\n"
+      << "Dim_1 = " << ncol_ << " ;\n"
+      << "Dim_2 = " << nrow_ << " ;\n"
+      << "Size = " << (size_t) nrow_ * ncol_ * sizeof(float) << " ;\n"
+      << "Pixel Size = " << pixel_ << " ;\n"
+      << "Center X = " << center_x_ << " ;\n"
+      << "Center Y = " << center_y_ << " ;\n"
+      << "Detector Distance = " << sdd_ << " ;\n"
+      << "Energy = " << energy_ << " ;\n";
+    if(n > 1) h << "Frames = " << n << " ;\n";
+    std::string s = h.str();
+    size_t size = (s.size() + 2 + EDF_CHUNK_SIZE - 1) / EDF_CHUNK_SIZE * EDF_CHUNK_SIZE;
+    s.append(size - s.size() - 2, ' ');
+    s.append("}\n");
+    return s;
+  } // EDFWriter::header()
+
+
+  bool EDFWriter::Write(const real_t * data, unsigned int nframes) {
+    std::ofstream edf(filename_, std::ios::out | std::ios::binary);
     if (!edf.is_open()){
       std::cerr << "Error: failed to open EDF file for writing" << std::endl;
-      return;
-    }
-
-    std::string type("float");
-    int size = nrow_ * ncol_;
-    /* filename */
-    edf << "Pixel Size        = " << pixel_    << std::endl;
-    edf << "Center X          = " << center_x_ << std::endl;
-    edf << "Center Y          = " << center_y_ << std::endl;
-    edf << "Detector Distance = " << sdd_      << std::endl;
-    edf << "Energy            = " << energy_   << std::endl;
-    edf << "Dim_1             = " << nrow_     << std::endl;
-    edf << "Dim_2             = " << ncol_     << std::endl;
-    edf << "Size              = " << size * sizeof(float)  << std::endl;
-    edf << "DataType          = " << type      << std::endl;
-    
-    // First 1024 bytes are reserved for header
-    edf.seekp(1024);
-    for (int i = 0; i < size; i++ ){
-      float d = (float) data[i];
-      edf.write(reinterpret_cast<char *>(&d), sizeof(float));
+      return false;
     }
+    size_t size = (size_t) nrow_ * ncol_;
+    std::vector<char> buffer;
+    for(unsigned int i = 0; i < nframes; ++ i) {
+      // the header and the payload of a frame in one write
+      std::string h = header(i, nframes);
+      buffer.resize(h.size() + size * sizeof(float));
+      std::memcpy(&buffer[0], h.data(), h.size());
+      float* out = reinterpret_cast<float*>(&buffer[h.size()]);
+      const real_t* in = data + i * size;
+      for(size_t j = 0; j < size; ++ j) out[j] = (float) in[j];
+      edf.write(&buffer[0], buffer.size());
+    } // for
     edf.close();
+    if(!edf) {
+      std::cerr << "Error: failed to write EDF file" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  void EDFWriter::Write(real_t * data){
+    Write(data, 1);
   }
 
   void EDFWriter::sdd(real_t alpha){
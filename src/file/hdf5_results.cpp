@@ -0,0 +1,251 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: hdf5_results.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#ifdef USE_PARALLEL_HDF5
+
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+#include <file/hdf5_results.hpp>
+
+namespace hig {
+
+  /* deflate level of the datasets */
+  static const unsigned int H5_RESULTS_DEFLATE_ = 4;
+
+  static hid_t native_real() {
+    return (sizeof(real_t) == sizeof(float)) ? H5T_NATIVE_FLOAT : H5T_NATIVE_DOUBLE;
+  } // native_real()
+
+
+  HDF5ResultWriter::HDF5ResultWriter(): file_(-1), dxpl_(-1) {
+    for(int q = 0; q < num_quantities; ++ q) { dset_[q] = -1; rank_[q] = 0; }
+  } // HDF5ResultWriter::HDF5ResultWriter()
+
+
+  bool HDF5ResultWriter::open(const std::string& filename, const std::vector<real_t>& alphai,
+                              const std::vector<real_t>& phi, const std::vector<real_t>& tilt,
+                              unsigned int nrow, unsigned int ncol, bool average,
+                              unsigned int nstruct, unsigned int nq, bool save_ff, bool save_sf
+                              #ifdef USE_MPI
+                                , MPI_Comm comm
+                              #endif
+                              ) {
+    close();
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    dxpl_ = H5Pcreate(H5P_DATASET_XFER);
+    #ifdef USE_MPI
+      comm_ = comm;
+      H5Pset_fapl_mpio(fapl, comm, MPI_INFO_NULL);
+      // filtered datasets can only be written collectively
+      H5Pset_dxpl_mpio(dxpl_, H5FD_MPIO_COLLECTIVE);
+    #endif
+    file_ = H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5Pclose(fapl);
+    if(file_ < 0) {
+      std::cerr << "error: could not create the result container " << filename << std::endl;
+      close();
+      return false;
+    } // if
+
+    if(!write_coordinates("alphai", alphai) || !write_coordinates("phi", phi) ||
+       !write_coordinates("tilt", tilt)) {
+      close();
+      return false;
+    } // if
+
+    hid_t ftype = (sizeof(real_t) == sizeof(float)) ? H5T_IEEE_F32LE : H5T_IEEE_F64LE;
+    hsize_t d[5] = { alphai.size(), phi.size(), tilt.size(), nrow, ncol };
+    if(!create(intensity, "intensity", 5, d, ftype)) { close(); return false; }
+    if(average) {
+      hsize_t a[3] = { alphai.size(), nrow, ncol };
+      if(!create(averaged, "averaged", 3, a, ftype)) { close(); return false; }
+    } // if
+    hsize_t f[5] = { alphai.size(), phi.size(), tilt.size(), nstruct, nq };
+    if((save_ff && !create(ff, "ff", 5, f, ftype)) || (save_sf && !create(sf, "sf", 5, f, ftype))) {
+      close();
+      return false;
+    } // if
+    return true;
+  } // HDF5ResultWriter::open()
+
+
+  /* create a dataset chunked by its last two dimensions (last for the factors) */
+  bool HDF5ResultWriter::create(Quantity q, const char* name, unsigned int rank,
+                                const hsize_t* dims, hid_t ftype) {
+    hsize_t chunk[5];
+    unsigned int inner = (q == ff || q == sf) ? 1 : 2;
+    for(unsigned int i = 0; i < rank; ++ i) chunk[i] = (i < rank - inner) ? 1 : dims[i];
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, rank, chunk);
+    H5Pset_fill_time(dcpl, H5D_FILL_TIME_NEVER);
+    if(H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+      H5Pset_shuffle(dcpl);
+      H5Pset_deflate(dcpl, H5_RESULTS_DEFLATE_);
+    } // if
+    hid_t space = H5Screate_simple(rank, dims, NULL);
+    dset_[q] = H5Dcreate2(file_, name, ftype, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Sclose(space);
+    H5Pclose(dcpl);
+    if(dset_[q] < 0) {
+      std::cerr << "error: could not create the dataset '" << name << "'" << std::endl;
+      return false;
+    } // if
+    rank_[q] = rank;
+    for(unsigned int i = 0; i < rank; ++ i) dims_[q][i] = dims[i];
+    return true;
+  } // HDF5ResultWriter::create()
+
+
+  /* all processes write the same values */
+  bool HDF5ResultWriter::write_coordinates(const char* name, const std::vector<real_t>& values) {
+    hsize_t n = values.size();
+    hid_t space = H5Screate_simple(1, &n, NULL);
+    hid_t dset = H5Dcreate2(file_, name, H5T_IEEE_F64LE, space, H5P_DEFAULT, H5P_DEFAULT,
+                            H5P_DEFAULT);
+    herr_t err = (dset < 0) ? -1 : H5Dwrite(dset, native_real(), H5S_ALL, H5S_ALL, dxpl_, &values[0]);
+    if(dset >= 0) {
+      const char units[] = "degrees";
+      hid_t stype = H5Tcopy(H5T_C_S1);
+      H5Tset_size(stype, sizeof(units));
+      hid_t aspace = H5Screate(H5S_SCALAR);
+      hid_t attr = H5Acreate2(dset, "units", stype, aspace, H5P_DEFAULT, H5P_DEFAULT);
+      H5Awrite(attr, stype, units);
+      H5Aclose(attr); H5Sclose(aspace); H5Tclose(stype);
+      H5Dclose(dset);
+    } // if
+    H5Sclose(space);
+    if(err < 0) {
+      std::cerr << "error: could not write the coordinates '" << name << "'" << std::endl;
+      return false;
+    } // if
+    return true;
+  } // HDF5ResultWriter::write_coordinates()
+
+
+  void HDF5ResultWriter::stage(Quantity q, const hsize_t* index, const real_t* data, size_t n) {
+    if(dset_[q] < 0) return;
+    unsigned int lead = rank_[q] - ((q == ff || q == sf) ? 1 : 2);
+    for(unsigned int i = 0; i < lead; ++ i) {
+      if(index[i] >= dims_[q][i]) {
+        std::cerr << "warning: result outside of the sweep. not saving it" << std::endl;
+        return;
+      } // if
+    } // for
+    staged_.push_back(Block());
+    Block& b = staged_.back();
+    b.quantity_ = q;
+    std::memcpy(b.index_, index, lead * sizeof(hsize_t));
+    b.data_.assign(data, data + n);
+  } // HDF5ResultWriter::stage()
+
+
+  void HDF5ResultWriter::stage_intensity(int ia, int ip, int it, const real_t* data) {
+    if(ia < 0 || ip < 0 || it < 0 || data == NULL) return;
+    hsize_t index[3] = { (hsize_t) ia, (hsize_t) ip, (hsize_t) it };
+    stage(intensity, index, data, dims_[intensity][3] * dims_[intensity][4]);
+  } // HDF5ResultWriter::stage_intensity()
+
+
+  void HDF5ResultWriter::stage_averaged(int ia, const real_t* data) {
+    if(ia < 0 || data == NULL) return;
+    hsize_t index = ia;
+    stage(averaged, &index, data, dims_[averaged][1] * dims_[averaged][2]);
+  } // HDF5ResultWriter::stage_averaged()
+
+
+  void HDF5ResultWriter::stage_factor(Quantity q, int ia, int ip, int it, int is,
+                                      const complex_t* data) {
+    if((q != ff && q != sf) || dset_[q] < 0) return;
+    if(ia < 0 || ip < 0 || it < 0 || is < 0 || data == NULL) return;
+    hsize_t index[4] = { (hsize_t) ia, (hsize_t) ip, (hsize_t) it, (hsize_t) is };
+    std::vector<real_t> mag(dims_[q][4]);
+    for(size_t i = 0; i < mag.size(); ++ i) mag[i] = std::abs(data[i]);
+    stage(q, index, &mag[0], mag.size());
+  } // HDF5ResultWriter::stage_factor()
+
+
+  /* write one block, or take part in a collective write with nothing if b is NULL */
+  bool HDF5ResultWriter::write(Quantity q, const Block* b) {
+    hid_t fspace = H5Dget_space(dset_[q]);
+    unsigned int rank = rank_[q];
+    unsigned int lead = rank - ((q == ff || q == sf) ? 1 : 2);
+    hsize_t start[5] = { 0, 0, 0, 0, 0 }, count[5];
+    for(unsigned int i = 0; i < rank; ++ i) {
+      count[i] = (i < lead) ? 1 : dims_[q][i];
+      if(b != NULL && i < lead) start[i] = b->index_[i];
+    } // for
+    hid_t mspace = H5Screate_simple(rank, count, NULL);
+    real_t dummy = 0.;
+    const real_t* data = &dummy;
+    if(b != NULL) {
+      H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, NULL, count, NULL);
+      data = &b->data_[0];
+    } else {
+      H5Sselect_none(fspace);
+      H5Sselect_none(mspace);
+    } // if-else
+    herr_t err = H5Dwrite(dset_[q], native_real(), mspace, fspace, dxpl_, data);
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+    if(err < 0) {
+      std::cerr << "error: failed to write to the result container" << std::endl;
+      return false;
+    } // if
+    return true;
+  } // HDF5ResultWriter::write()
+
+
+  bool HDF5ResultWriter::flush() {
+    if(file_ < 0) return true;
+    bool success = true;
+    for(int q = 0; q < num_quantities; ++ q) {
+      if(dset_[q] < 0) continue;
+      std::vector<const Block*> blocks;
+      for(size_t i = 0; i < staged_.size(); ++ i)
+        if(staged_[i].quantity_ == q) blocks.push_back(&staged_[i]);
+      int count = blocks.size(), rounds = count;
+      #ifdef USE_MPI
+        // every process takes part in as many writes as the one with the most blocks
+        MPI_Allreduce(&count, &rounds, 1, MPI_INT, MPI_MAX, comm_);
+      #endif
+      for(int r = 0; r < rounds; ++ r)
+        success = write((Quantity) q, (r < count) ? blocks[r] : NULL) && success;
+    } // for
+    staged_.clear();
+    if(success) H5Fflush(file_, H5F_SCOPE_LOCAL);
+    return success;
+  } // HDF5ResultWriter::flush()
+
+
+  bool HDF5ResultWriter::close() {
+    bool success = true;
+    if(file_ >= 0) success = flush();
+    for(int q = 0; q < num_quantities; ++ q) {
+      if(dset_[q] >= 0) H5Dclose(dset_[q]);
+      dset_[q] = -1; rank_[q] = 0;
+    } // for
+    if(dxpl_ >= 0) H5Pclose(dxpl_);
+    if(file_ >= 0) H5Fclose(file_);
+    dxpl_ = -1; file_ = -1;
+    staged_.clear();
+    return success;
+  } // HDF5ResultWriter::close()
+
+} // namespace hig
+
+#endif // USE_PARALLEL_HDF5
@@ -64,3 +64,71 @@ void h5_shape_reader(const char* hdf5_filename, double** shape_def, unsigned int
 	H5Dclose(dataset);
 	H5Fclose(file_id);
 } // h5_shape_reader()
+
+
+/**
+ * checks if a hdf5 file holds a density grid, a 3-d dataset "density"
+ */
+int h5_has_density(const char* hdf5_filename) {
+	hid_t file_id = H5Fopen(hdf5_filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+	if(file_id < 0) return 0;
+	int found = (H5Lexists(file_id, "density", H5P_DEFAULT) > 0);
+	H5Fclose(file_id);
+	return found;
+} // h5_has_density()
+
+
+/**
+ * reads a density grid from a hdf5 file: the 3-d dataset "density", of size nz x ny x nx
+ * (x varying fastest), with the voxel size (x, y, z) in its attribute "voxelsize".
+ * returns the number of voxels, 0 on failure
+ */
+int h5_density_reader(const char* hdf5_filename, double** density, unsigned int* dims, double* voxel) {
+	hid_t file_id, dataset, dataspace, attr;
+	hsize_t h5dims[3];
+	herr_t status;
+	size_t num_voxels;
+
+	*density = NULL;
+	file_id = H5Fopen(hdf5_filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+	if(file_id < 0) {
+		fprintf(stderr, "error: cannot open density grid file %s\n", hdf5_filename);
+		return 0;
+	} // if
+	dataset = H5Dopen(file_id, "density", H5P_DEFAULT);
+	dataspace = H5Dget_space(dataset);
+	if(H5Sget_simple_extent_ndims(dataspace) != 3) {
+		fprintf(stderr, "error: density grid must be 3-dimensional\n");
+		H5Sclose(dataspace); H5Dclose(dataset); H5Fclose(file_id);
+		return 0;
+	} // if
+	H5Sget_simple_extent_dims(dataspace, h5dims, NULL);
+	dims[0] = h5dims[2]; dims[1] = h5dims[1]; dims[2] = h5dims[0];
+	num_voxels = (size_t) h5dims[0] * h5dims[1] * h5dims[2];
+
+	voxel[0] = voxel[1] = voxel[2] = 1.0;
+	if(H5Aexists(dataset, "voxelsize") > 0) {
+		attr = H5Aopen(dataset, "voxelsize", H5P_DEFAULT);
+		H5Aread(attr, H5T_NATIVE_DOUBLE, voxel);
+		H5Aclose(attr);
+	} // if
+
+	(*density) = (double*) malloc(num_voxels * sizeof(double));
+	if((*density) == NULL) {
+		fprintf(stderr, "error: cannot allocate memory to read density grid\n");
+		num_voxels = 0;
+	} else {
+		status = H5Dread(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, *density);
+		if(status < 0) {
+			fprintf(stderr, "error: density grid reading failed\n");
+			free(*density);
+			*density = NULL;
+			num_voxels = 0;
+		} // if
+	} // if-else
+
+	H5Sclose(dataspace);
+	H5Dclose(dataset);
+	H5Fclose(file_id);
+	return (int) num_voxels;
+} // h5_density_reader()
@@ -0,0 +1,281 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: raw_data.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <file/raw_data.hpp>
+
+namespace hig {
+
+  static const char RAW_DATA_MAGIC[6] = { 'H', 'I', 'G', 'R', 'A', 'W' };
+
+  static bool host_little_endian() {
+    const uint16_t one = 1;
+    return *(const unsigned char*) &one == 1;
+  } // host_little_endian()
+
+  static void put_le(unsigned char* p, uint64_t v, int bytes) {
+    for(int i = 0; i < bytes; ++ i) p[i] = (unsigned char) (v >> (8 * i));
+  } // put_le()
+
+  static uint64_t get_le(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for(int i = bytes - 1; i >= 0; -- i) v = (v << 8) | p[i];
+    return v;
+  } // get_le()
+
+  /* reverse the bytes of each of the n words of the given size */
+  static void swap_words(char* p, size_t n, int word) {
+    for(size_t i = 0; i < n; ++ i, p += word) std::reverse(p, p + word);
+  } // swap_words()
+
+  static int word_size(RawDataType t) {
+    return (t == raw_data_float32 || t == raw_data_complex64) ? 4 : 8;
+  } // word_size()
+
+  static int values_per_element(RawDataType t) {
+    return (t == raw_data_complex64 || t == raw_data_complex128) ? 2 : 1;
+  } // values_per_element()
+
+
+  const char* raw_data_extension(OutputFormatType f) {
+    return (f == output_format_text) ? ".out" : ".hgr";
+  } // raw_data_extension()
+
+
+  /**
+   * write the header and metadata, followed by the n payload values of type t (counting the
+   * real and imaginary parts separately) converted from the real_t values in data
+   */
+  static bool write_raw(const std::string& filename, const real_t* data, RawDataType t,
+                        unsigned int ndims, const unsigned int* dims, const std::string& meta) {
+    if(ndims < 1 || ndims > 3) {
+      std::cerr << "error: raw data must have 1 to 3 dimensions" << std::endl;
+      return false;
+    } // if
+    uint64_t d[3] = { 1, 1, 1 };
+    for(unsigned int i = 0; i < ndims; ++ i) d[i] = dims[i];
+    size_t n = d[0] * d[1] * d[2] * values_per_element(t);
+    int word = word_size(t);
+
+    size_t offset = RAW_DATA_HEADER_SIZE + meta.size();
+    offset = (offset + RAW_DATA_HEADER_SIZE - 1) / RAW_DATA_HEADER_SIZE * RAW_DATA_HEADER_SIZE;
+    std::vector<unsigned char> head(offset, 0);
+    std::memcpy(&head[0], RAW_DATA_MAGIC, 6);
+    put_le(&head[6], RAW_DATA_VERSION, 2);
+    head[8] = (unsigned char) t;
+    head[9] = (unsigned char) ndims;
+    put_le(&head[12], meta.size(), 4);
+    for(int i = 0; i < 3; ++ i) put_le(&head[16 + 8 * i], d[i], 8);
+    put_le(&head[40], offset, 8);
+    if(!meta.empty()) std::memcpy(&head[RAW_DATA_HEADER_SIZE], meta.data(), meta.size());
+
+    // the payload is written from data directly when it already has the file layout
+    const char* payload = (const char*) data;
+    std::vector<char> buffer;
+    if(word != sizeof(real_t) || !host_little_endian()) {
+      buffer.resize(n * word);
+      if(word == 4) {
+        float* f = (float*) &buffer[0];
+        for(size_t i = 0; i < n; ++ i) f[i] = (float) data[i];
+      } else {
+        double* f = (double*) &buffer[0];
+        for(size_t i = 0; i < n; ++ i) f[i] = (double) data[i];
+      } // if-else
+      if(!host_little_endian()) swap_words(&buffer[0], n, word);
+      payload = &buffer[0];
+    } // if
+
+    std::ofstream f(filename.c_str(), std::ios::out | std::ios::binary);
+    if(!f.is_open()) {
+      std::cerr << "error: could not open output file " << filename << std::endl;
+      return false;
+    } // if
+    f.write((const char*) &head[0], offset);
+    f.write(payload, n * word);
+    f.close();
+    if(!f) {
+      std::cerr << "error: failed to write raw data to " << filename << std::endl;
+      return false;
+    } // if
+    return true;
+  } // write_raw()
+
+
+  bool write_raw_data(const std::string& filename, const real_t* data, unsigned int ndims,
+                      const unsigned int* dims, bool single, const std::string& meta) {
+    return write_raw(filename, data, single ? raw_data_float32 : raw_data_float64,
+                     ndims, dims, meta);
+  } // write_raw_data()
+
+
+  bool write_raw_data(const std::string& filename, const complex_t* data, unsigned int ndims,
+                      const unsigned int* dims, bool single, const std::string& meta) {
+    // complex_t is laid out as its real and imaginary parts
+    return write_raw(filename, (const real_t*) data, single ? raw_data_complex64 : raw_data_complex128,
+                     ndims, dims, meta);
+  } // write_raw_data()
+
+
+  bool RawDataFile::parse_header(const unsigned char* head, size_t file_size) {
+    if(file_size < RAW_DATA_HEADER_SIZE || std::memcmp(head, RAW_DATA_MAGIC, 6) != 0) {
+      std::cerr << "error: not a raw data file" << std::endl;
+      return false;
+    } // if
+    if(get_le(head + 6, 2) > RAW_DATA_VERSION) {
+      std::cerr << "error: unsupported raw data file version " << get_le(head + 6, 2) << std::endl;
+      return false;
+    } // if
+    type_ = (RawDataType) head[8];
+    ndims_ = head[9];
+    if(type_ < raw_data_float32 || type_ > raw_data_complex128 || ndims_ < 1 || ndims_ > 3) {
+      std::cerr << "error: invalid raw data file header" << std::endl;
+      return false;
+    } // if
+    size_t meta_size = get_le(head + 12, 4);
+    for(int i = 0; i < 3; ++ i) dims_[i] = get_le(head + 16 + 8 * i, 8);
+    size_t offset = get_le(head + 40, 8);
+    size_t bytes = size() * values_per_element(type_) * word_size(type_);
+    if(offset < RAW_DATA_HEADER_SIZE + meta_size || offset + bytes > file_size) {
+      std::cerr << "error: truncated raw data file" << std::endl;
+      return false;
+    } // if
+    meta_.assign((const char*) head + RAW_DATA_HEADER_SIZE, meta_size);
+    return true;
+  } // RawDataFile::parse_header()
+
+
+  bool RawDataFile::open(const std::string& filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+      std::cerr << "error: could not open raw data file " << filename << std::endl;
+      return false;
+    } // if
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t) RAW_DATA_HEADER_SIZE) {
+      std::cerr << "error: could not read raw data file " << filename << std::endl;
+      ::close(fd);
+      return false;
+    } // if
+    size_t file_size = st.st_size;
+
+    if(host_little_endian()) {
+      void* map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if(map == MAP_FAILED) {
+        std::cerr << "error: could not map raw data file " << filename << std::endl;
+        return false;
+      } // if
+      map_ = map; map_size_ = file_size;
+      if(!parse_header((const unsigned char*) map_, file_size)) { close(); return false; }
+      payload_ = (const char*) map_ + get_le((const unsigned char*) map_ + 40, 8);
+      return true;
+    } // if
+
+    // big endian hosts read the file and swap the payload
+    std::vector<unsigned char> head(RAW_DATA_HEADER_SIZE);
+    bool ok = ::read(fd, &head[0], RAW_DATA_HEADER_SIZE) == (ssize_t) RAW_DATA_HEADER_SIZE;
+    size_t offset = ok ? get_le(&head[40], 8) : 0;
+    if(ok && offset > RAW_DATA_HEADER_SIZE && offset <= file_size) {
+      head.resize(offset);
+      ok = ::read(fd, &head[RAW_DATA_HEADER_SIZE], offset - RAW_DATA_HEADER_SIZE)
+           == (ssize_t) (offset - RAW_DATA_HEADER_SIZE);
+    } // if
+    if(!ok || !parse_header(&head[0], file_size)) {
+      std::cerr << "error: could not read raw data file " << filename << std::endl;
+      ::close(fd); close();
+      return false;
+    } // if
+    size_t n = size() * values_per_element(type_);
+    buffer_ = new (std::nothrow) char[n * word_size(type_)];
+    if(buffer_ == NULL || ::pread(fd, buffer_, n * word_size(type_), offset)
+                          != (ssize_t) (n * word_size(type_))) {
+      std::cerr << "error: could not read raw data file " << filename << std::endl;
+      ::close(fd); close();
+      return false;
+    } // if
+    ::close(fd);
+    swap_words(buffer_, n, word_size(type_));
+    payload_ = buffer_;
+    return true;
+  } // RawDataFile::open()
+
+
+  void RawDataFile::close() {
+    if(map_ != NULL) munmap(map_, map_size_);
+    if(buffer_ != NULL) delete[] buffer_;
+    map_ = NULL; map_size_ = 0; buffer_ = NULL; payload_ = NULL;
+    type_ = raw_data_error; ndims_ = 0;
+    dims_[0] = dims_[1] = dims_[2] = 0;
+    meta_.clear();
+  } // RawDataFile::close()
+
+
+  bool RawDataFile::meta(const std::string& key, std::string& value) const {
+    size_t pos = 0;
+    while(pos < meta_.size()) {
+      size_t end = meta_.find('\n', pos);
+      if(end == std::string::npos) end = meta_.size();
+      size_t eq = meta_.find('=', pos);
+      if(eq < end && meta_.compare(pos, eq - pos, key) == 0 && eq - pos == key.size()) {
+        value = meta_.substr(eq + 1, end - eq - 1);
+        return true;
+      } // if
+      pos = end + 1;
+    } // while
+    return false;
+  } // RawDataFile::meta()
+
+
+  const real_t* RawDataFile::real_data() const {
+    RawDataType t = (sizeof(real_t) == 4) ? raw_data_float32 : raw_data_float64;
+    return (type_ == t) ? (const real_t*) payload_ : NULL;
+  } // RawDataFile::real_data()
+
+
+  const complex_t* RawDataFile::complex_data() const {
+    RawDataType t = (sizeof(real_t) == 4) ? raw_data_complex64 : raw_data_complex128;
+    return (type_ == t) ? (const complex_t*) payload_ : NULL;
+  } // RawDataFile::complex_data()
+
+
+  bool RawDataFile::copy(real_t* data) const {
+    if(payload_ == NULL || data == NULL) return false;
+    size_t n = size();
+    if(type_ == raw_data_float32) {
+      const float* f = (const float*) payload_;
+      for(size_t i = 0; i < n; ++ i) data[i] = f[i];
+    } else if(type_ == raw_data_float64) {
+      const double* f = (const double*) payload_;
+      for(size_t i = 0; i < n; ++ i) data[i] = f[i];
+    } else {
+      std::cerr << "error: raw data file does not contain real values" << std::endl;
+      return false;
+    } // if-else
+    return true;
+  } // RawDataFile::copy()
+
+} // namespace hig
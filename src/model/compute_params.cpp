@@ -35,6 +35,10 @@ namespace hig {
     resolution_.push_back(1); resolution_.push_back(1);
     nslices_ = 0;
     correlation_ = structcorr_null;
+    triangle_method_ = triangle_method_approx;
+    triangle_tol_ = 0.1;
+    density_pad_ = 2;
+    output_format_ = output_format_binary;
     palette_ = "default";
   } // ComputeParams::init()
 
@@ -49,6 +53,10 @@ namespace hig {
       case compute_outregion_token:
       case compute_resolution_token:
       case compute_nslices_token:
+      case compute_trianglemethod_token:
+      case compute_triangletol_token:
+      case compute_densitypad_token:
+      case compute_outputformat_token:
         std::cerr << "earning: immutable param in '" << str << "'. ignoring." << std::endl;
         break;
 
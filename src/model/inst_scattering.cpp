@@ -35,6 +35,7 @@ namespace hig {
     spot_area_ = 0.01; //0.001;
     //smearing_[0] = smearing_[1] = smearing_[2] = 1;
     smearing_ = 1.0;
+    psf_.clear();
   } // ScatteringParams::init()
 
 
@@ -46,6 +47,7 @@ namespace hig {
       case instrument_scatter_expt_token:
       case instrument_scatter_polarize_token:
       case instrument_scatter_smearing_token:
+      case instrument_scatter_psf_token:
         std::cerr << "warning: immutable param in '" << str << "'. ignoring." << std::endl;
         break;
 
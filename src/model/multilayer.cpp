@@ -14,6 +14,9 @@
  */
 
 
+#include <cmath>
+#include <algorithm>
+
 #include <model/layer.hpp>
 #include <model/qgrid.hpp>
 #include <config/hig_input.hpp>
@@ -36,6 +39,8 @@ namespace hig {
     vacuum.refindex(RefractiveIndex(0, 0));
     vacuum.order(0);
     vacuum.thickness(0);
+    vacuum.z_val(0);
+    layers_.clear();
     layers_.push_back(vacuum); 
 
     Layer substr;
@@ -62,47 +67,129 @@ namespace hig {
     layers_.clear();
   }
 
-  complex_vec_t MultiLayer::parratt_recursion(real_t alpha, real_t k0, 
-          int order){
-
+  void MultiLayer::signature(std::vector<real_t>& sig) const {
+    sig.clear();
+    sig.reserve(3 * layers_.size());
+    for(int i = 0; i < layers_.size(); ++ i) {
+      complex_t dn2 = layers_[i].one_minus_n2();
+      sig.push_back(dn2.real());
+      sig.push_back(dn2.imag());
+      sig.push_back(layers_[i].z_val());
+    } // for
+  } // MultiLayer::signature()
+
+
+  /**
+   * the recursion for a block of at most PARRATT_BLOCK_ angles, in SoA form with the angles
+   * as the inner loop. kz and the transfer matrices are computed in real arithmetic:
+   *    kz_j = - k0 sqrt(sin^2 alpha - (1 - n_j^2)),
+   *    exp(-i w z) = exp(imag(w) z) (cos(real(w) z) - i sin(real(w) z))
+   */
+  void MultiLayer::parratt_block(const real_t* alpha, int n, real_t k0, int order,
+                                 complex_t* t_out, complex_t* r_out) const {
     const int NL = layers_.size();
-    real_t sina = std::sin(alpha);
-    complex_vec_t T; T.resize(NL, CMPLX_ZERO_);
-    complex_vec_t R; R.resize(NL, CMPLX_ZERO_);
-    T.back() = complex_t(1., 0);
-
-    // calc k-value
-    complex_vec_t kz; kz.resize(NL, CMPLX_ZERO_);
-    for (int i = 0; i < NL; i++)
-      kz[i] = - k0 * std::sqrt(sina * sina - layers_[i].one_minus_n2());
-
-    for (int i = NL-2; i > -1; i--){
-      complex_t pij = (kz[i] + kz[i+1])/(2. * kz[i]);
-      complex_t mij = (kz[i] - kz[i+1])/(2. * kz[i]);
-      real_t z = layers_[i].z_val();
-      complex_t exp_p = std::exp(CMPLX_MINUS_ONE_ * (kz[i+1] + kz[i]) * z);
-      complex_t exp_m = std::exp(CMPLX_MINUS_ONE_ * (kz[i+1] - kz[i]) * z);
-      complex_t a00 = pij * exp_m;
-      complex_t a01 = mij * std::conj(exp_p);
-      complex_t a10 = mij * exp_p;
-      complex_t a11 = pij * std::conj(exp_m);
-      T[i] = a00 * T[i+1] + a01 * R[i+1];
-      R[i] = a10 * T[i+1] + a11 * R[i+1];
-
-    }
-      
-    complex_t t0 = T[0];
-    for (int i = 0; i < NL; i++){
-      T[i] /= t0;
-      R[i] /= t0;
-    }
+    real_t s2[PARRATT_BLOCK_];
+    real_t kr[PARRATT_BLOCK_], ki[PARRATT_BLOCK_];      // kz of layer i
+    real_t kr1[PARRATT_BLOCK_], ki1[PARRATT_BLOCK_];    // kz of layer i + 1
+    real_t tr[PARRATT_BLOCK_], ti[PARRATT_BLOCK_], rr[PARRATT_BLOCK_], ri[PARRATT_BLOCK_];
+    real_t otr[PARRATT_BLOCK_], oti[PARRATT_BLOCK_], orr[PARRATT_BLOCK_], ori[PARRATT_BLOCK_];
+
+    #pragma omp simd
+    for(int j = 0; j < n; ++ j) {
+      real_t sa = std::sin(alpha[j]);
+      s2[j] = sa * sa;
+    } // for
+
+    for(int i = NL - 1; i > -1; -- i) {
+      // kz of layer i, the principal square root as std::sqrt
+      complex_t dn2 = layers_[i].one_minus_n2();
+      #pragma omp simd
+      for(int j = 0; j < n; ++ j) {
+        real_t x = s2[j] - dn2.real(), y = - dn2.imag();
+        real_t r = std::sqrt(x * x + y * y);
+        real_t sr = std::sqrt(std::max((real_t) 0., (r + x) / 2.));
+        real_t si = std::sqrt(std::max((real_t) 0., (r - x) / 2.));
+        kr[j] = - k0 * sr;
+        ki[j] = - k0 * (std::signbit(y) ? - si : si);
+      } // for
+
+      if(i == NL - 1) {
+        #pragma omp simd
+        for(int j = 0; j < n; ++ j) { tr[j] = 1.; ti[j] = 0.; rr[j] = 0.; ri[j] = 0.; }
+      } else {
+        real_t z = layers_[i].z_val();
+        #pragma omp simd
+        for(int j = 0; j < n; ++ j) {
+          // 1 / (2 kz_i)
+          real_t nrm = 2. * (kr[j] * kr[j] + ki[j] * ki[j]);
+          real_t ivr = kr[j] / nrm, ivi = - ki[j] / nrm;
+          real_t sr = kr[j] + kr1[j], si = ki[j] + ki1[j];
+          real_t dr = kr[j] - kr1[j], di = ki[j] - ki1[j];
+          real_t pr = sr * ivr - si * ivi, pi = sr * ivi + si * ivr;   // p_ij
+          real_t mr = dr * ivr - di * ivi, mi = dr * ivi + di * ivr;   // m_ij
+          // exp_p = exp(-i (k_i+1 + k_i) z), exp_m = exp(-i (k_i+1 - k_i) z)
+          real_t ep = std::exp(si * z), em = std::exp(- di * z);
+          real_t epr = ep * std::cos(sr * z), epi = - ep * std::sin(sr * z);
+          real_t emr = em * std::cos(dr * z), emi = em * std::sin(dr * z);
+          // a00 = p exp_m, a01 = m conj(exp_p), a10 = m exp_p, a11 = p conj(exp_m)
+          real_t a00r = pr * emr - pi * emi, a00i = pr * emi + pi * emr;
+          real_t a01r = mr * epr + mi * epi, a01i = mi * epr - mr * epi;
+          real_t a10r = mr * epr - mi * epi, a10i = mr * epi + mi * epr;
+          real_t a11r = pr * emr + pi * emi, a11i = pi * emr - pr * emi;
+          real_t t_r = a00r * tr[j] - a00i * ti[j] + a01r * rr[j] - a01i * ri[j];
+          real_t t_i = a00r * ti[j] + a00i * tr[j] + a01r * ri[j] + a01i * rr[j];
+          real_t r_r = a10r * tr[j] - a10i * ti[j] + a11r * rr[j] - a11i * ri[j];
+          real_t r_i = a10r * ti[j] + a10i * tr[j] + a11r * ri[j] + a11i * rr[j];
+          tr[j] = t_r; ti[j] = t_i; rr[j] = r_r; ri[j] = r_i;
+        } // for
+      } // if-else
+
+      if(i == order) {
+        #pragma omp simd
+        for(int j = 0; j < n; ++ j) { otr[j] = tr[j]; oti[j] = ti[j]; orr[j] = rr[j]; ori[j] = ri[j]; }
+      } // if
+      #pragma omp simd
+      for(int j = 0; j < n; ++ j) { kr1[j] = kr[j]; ki1[j] = ki[j]; }
+    } // for
+
+    // normalize with the transmission of the top layer
+    for(int j = 0; j < n; ++ j) {
+      if(alpha[j] > 0) {
+        complex_t t0(tr[j], ti[j]);
+        t_out[j] = complex_t(otr[j], oti[j]) / t0;
+        r_out[j] = complex_t(orr[j], ori[j]) / t0;
+      } else {
+        t_out[j] = CMPLX_ZERO_;
+        r_out[j] = CMPLX_ZERO_;
+      } // if-else
+    } // for
+  } // MultiLayer::parratt_block()
+
+
+  void MultiLayer::parratt_batch(const real_t* alpha, int n, real_t k0, int order,
+                                 complex_t* t_out, complex_t* r_out) const {
+    if(order < 0 || order >= (int) layers_.size()) return;
+    int num_blocks = (n + PARRATT_BLOCK_ - 1) / PARRATT_BLOCK_;
+    #pragma omp parallel for schedule(static) if(num_blocks > 1)
+    for(int b = 0; b < num_blocks; ++ b) {
+      int j0 = b * PARRATT_BLOCK_;
+      int nb = std::min(PARRATT_BLOCK_, n - j0);
+      parratt_block(alpha + j0, nb, k0, order, t_out + j0, r_out + j0);
+    } // for
+  } // MultiLayer::parratt_batch()
+
+
+  complex_vec_t MultiLayer::parratt_recursion(real_t alpha, real_t k0, int order) {
+    complex_t t, r;
+    parratt_block(&alpha, 1, k0, order, &t, &r);
     complex_vec_t coef;
-    coef.push_back(T[order]); 
-    coef.push_back(R[order]);
+    coef.push_back(t);
+    coef.push_back(r);
     return coef;
   }
 
-  bool MultiLayer::propagation_coeffs(complex_vec_t & coeff, real_t k0, real_t alpha_i, int order){
+  bool MultiLayer::propagation_coeffs(complex_vec_t & coeff, real_t k0, real_t alpha_i, int order,
+                                      const QGridView & qgrid){
     if (order == -1){
       std::cerr << "Error: shapes can't be buried inside the substrate." << std::endl;
       std::cerr  << "***** if your know what your are doing," << std::endl;
@@ -110,37 +197,24 @@ namespace hig {
       return false;
     }
     coeff.clear();
-    int nqz = QGrid::instance().nqz_extended();
-    int nqy = QGrid::instance().nqy();
-    int ncol= QGrid::instance().ncols();
+    int nqz = qgrid.nqz_extended();
+    int nqy = qgrid.nqy();
     coeff.resize(nqz, CMPLX_ZERO_);
  
-    size_t nalpha = QGrid::instance().nalpha();
-    complex_t Ti, Ri;
-    complex_vec_t Tf, Rf;
-    Tf.resize(nalpha, CMPLX_ZERO_);
-    Rf.resize(nalpha, CMPLX_ZERO_);
-
-    // Rs and Ts for incoming
-    complex_vec_t coef_in = parratt_recursion(alpha_i, k0, order);
-    Ti = coef_in[0];
-    Ri = coef_in[1];
-
-    // Rs and Ts for outgoing
-#pragma omp parallel for
-    for (int i = 0; i < nalpha; i++){
-      real_t alpha = QGrid::instance().alpha(i);
-      if (alpha > 0){
-        complex_vec_t coef_out = parratt_recursion(alpha, k0, order);
-        Tf[i] = coef_out[0];
-        Rf[i] = coef_out[1];
-      }
-    }
+    // all the exit angles and the incidence angle, as one batch
+    size_t nalpha = qgrid.nalpha();
+    real_vec_t alpha(nalpha + 1);
+    for (int i = 0; i < nalpha; i++) alpha[i] = qgrid.alpha(i);
+    alpha[nalpha] = alpha_i;
+    complex_vec_t Tf(nalpha + 1), Rf(nalpha + 1);
+    parratt_batch(&alpha[0], nalpha + 1, k0, order, &Tf[0], &Rf[0]);
+    complex_t Ti = Tf[nalpha];
+    complex_t Ri = Rf[nalpha];
 
     // fill in the Coefficients
 #pragma omp parallel for
     for (int i = 0; i < nqy; i++){
-      int j = i / ncol;
+      int j = qgrid.row(i);
       coeff[i          ] = Ti * std::conj(Tf[j]);
       coeff[i +     nqy] = Ti * std::conj(Rf[j]);
       coeff[i + 2 * nqy] = Ri * std::conj(Tf[j]);
@@ -19,6 +19,7 @@
 
 #include <common/constants.hpp>
 #include <model/qgrid.hpp>
+#include <file/raw_data.hpp>
 #include <config/hig_input.hpp>
 #include <utils/utilities.hpp>
 
@@ -56,7 +57,7 @@ namespace hig {
       dq = (max_point[0] - min_point[0])/(pixels[0]-1);
       real_t cos_ai = std::cos(alpha_i);
       real_t cos_af = std::cos(alpha_[0]);
-      real_vec_t theta; theta.resize(pixels[0]);
+      real_vec_t& theta = theta_; theta.resize(pixels[0]);
       for (int i = 0; i < pixels[0]; i++){
         real_t qpt = min_point[0] + i * dq;
         real_t kf2    = std::pow(qpt / k0, 2);
@@ -73,15 +74,9 @@ namespace hig {
        * on the detector.
        */
       std::reverse(alpha_.begin(), alpha_.end());
-      for (int i = 0; i < pixels[1]; i++) {
-        for (int j = 0; j < pixels[0]; j++) {
-          real_t tth = theta[j];
-          real_t alf = alpha_[i];
-          qx_.push_back (k0 * (std::cos(alf) * std::cos(tth) - std::cos(alpha_i)));
-          qy_.push_back (k0 * (std::cos(alf) * std::sin(tth)));
-          qz_.push_back (k0 * (std::sin(alf) + std::sin(alpha_i)));
-        }
-      }
+      k0_ = k0; alpha_i_ = alpha_i;
+      pixels_.clear();
+      fill_points();
     } else {
       std::cerr << "error: unknown output region type" << std::endl;
       return false;
@@ -101,27 +96,25 @@ namespace hig {
 
   bool QGrid::create_qz_extended(real_t k0, real_t alpha_i, complex_t dnl_q) {
 
-    // reset qz_extended_ 
-    size_t imsize = nrow_ * ncol_;
-    qz_extended_.clear();
-    qz_extended_.reserve(4 * imsize);
+    size_t imsize = qz_.size();
+    qz_extended_.resize(4 * imsize);
 
     // incoming vectors
     real_t sin_ai = std::sin(alpha_i);
     real_t kzi_0 = -1 * k0 * sin_ai;
     complex_t kzi = -1 * k0 * std::sqrt(sin_ai * sin_ai - dnl_q);
+    complex_t k02_dnl = k0 * k0 * dnl_q;
 
-    std::vector<complex_t> kzf;
-    for(int i = 0; i < imsize; ++ i){
+    // calculate 4 components
+    #pragma omp parallel for schedule(static)
+    for(long int i = 0; i < (long int) imsize; ++ i) {
       real_t kzf_0 = qz_[i] + kzi_0;
-      kzf.push_back(sgn(kzf_0) * std::sqrt(kzf_0 * kzf_0 - k0 * k0 * dnl_q));
+      complex_t kzf = sgn(kzf_0) * std::sqrt(kzf_0 * kzf_0 - k02_dnl);
+      qz_extended_[i             ] =  kzf - kzi;
+      qz_extended_[i +     imsize] = -kzf - kzi;
+      qz_extended_[i + 2 * imsize] =  kzf + kzi;
+      qz_extended_[i + 3 * imsize] = -kzf + kzi;
     } // for
-  
-    // calculate 4 components
-    for(int i = 0; i < imsize; ++ i) qz_extended_.push_back( kzf[i] - kzi);
-    for(int i = 0; i < imsize; ++ i) qz_extended_.push_back(-kzf[i] - kzi);
-    for(int i = 0; i < imsize; ++ i) qz_extended_.push_back( kzf[i] + kzi);
-    for(int i = 0; i < imsize; ++ i) qz_extended_.push_back(-kzf[i] + kzi);
 
     return true;
   } // QGrid::create_qz_extended()
@@ -149,7 +142,7 @@ namespace hig {
     dq = (qmaxy - qminy) / (nqy - 1);
     real_t cos_ai = std::cos(alpha_i);
     real_t cos_af = std::cos(alpha_[0]);
-    real_vec_t theta; theta.resize(nqy);
+    real_vec_t& theta = theta_; theta.resize(nqy);
     for(int i = 0; i < nqy; ++ i) {
       real_t qpt = qminy + i * dq;
       real_t kf2 = std::pow(qpt / k0, 2);
@@ -159,17 +152,10 @@ namespace hig {
     } // for
 
     // calculate q-vectors on the Ewald sphere for every pixel on the detector
-    qx_.clear(); qy_.clear(); qz_.clear();
     std::reverse(alpha_.begin(), alpha_.end());
-    for (int i = 0; i < nqz; i++) {
-      for (int j = 0; j < nqy; j++) {
-        real_t tth = theta[j];
-        real_t alf = alpha_[i];
-        qx_.push_back(k0 * (std::cos(alf) * std::cos(tth) - std::cos(alpha_i)));
-        qy_.push_back(k0 * (std::cos(alf) * std::sin(tth)));
-        qz_.push_back(k0 * (std::sin(alf) + std::sin(alpha_i)));
-      } // for
-    } // for
+    k0_ = k0; alpha_i_ = alpha_i;
+    pixels_.clear();
+    fill_points();
 
     // sanity check
     if(qy_.size() != nqy * nqz || qz_.size() != nqy * nqz) {
@@ -188,6 +174,39 @@ namespace hig {
   } // QGrid::update()
 
 
+  /* q-vectors on the Ewald sphere of the selected pixels */
+  void QGrid::fill_points() {
+    size_t n = pixels_.empty() ? (size_t) nrow_ * ncol_ : pixels_.size();
+    qx_.resize(n); qy_.resize(n); qz_.resize(n);
+    real_t cos_ai = std::cos(alpha_i_), sin_ai = std::sin(alpha_i_);
+    #pragma omp parallel for schedule(static)
+    for(long int i = 0; i < (long int) n; ++ i) {
+      unsigned int p = pixels_.empty() ? i : pixels_[i];
+      real_t alf = alpha_[p / ncol_];
+      real_t tth = theta_[p % ncol_];
+      qx_[i] = k0_ * (std::cos(alf) * std::cos(tth) - cos_ai);
+      qy_[i] = k0_ * (std::cos(alf) * std::sin(tth));
+      qz_[i] = k0_ * (std::sin(alf) + sin_ai);
+    } // for
+  } // QGrid::fill_points()
+
+
+  bool QGrid::select(const std::vector<unsigned int>& pixels) {
+    size_t imsize = (size_t) nrow_ * ncol_;
+    for(size_t i = 0; i < pixels.size(); ++ i) {
+      if(pixels[i] >= imsize || (i > 0 && pixels[i] <= pixels[i - 1])) {
+        std::cerr << "error: invalid q-grid pixel selection" << std::endl;
+        return false;
+      } // if
+    } // for
+    if(pixels.size() == imsize) pixels_.clear();
+    else pixels_ = pixels;
+    fill_points();
+    qz_extended_.clear();
+    return true;
+  } // QGrid::select()
+
+
   /**
    * converts given pixel into q-space point
    * TODO: This doesn't seem right, the pixel values and sample-detector distance
@@ -210,7 +229,17 @@ namespace hig {
   } // QGrid::pixel_to_kspace()
 
 
-  void QGrid::save (const char* filename) {
+  void QGrid::save (const char* filename, OutputFormatType format) {
+    if(format != output_format_text) {
+      // the points as (qx, qy, qz) triplets
+      unsigned int dims[2] = { 3, (unsigned int) qx_.size() };
+      std::vector<real_t> q(3 * qx_.size());
+      for(unsigned int i = 0; i < qx_.size(); ++ i) {
+        q[3 * i] = qx_[i]; q[3 * i + 1] = qy_[i]; q[3 * i + 2] = qz_[i];
+      } // for
+      write_raw_data(filename, &q[0], 2, dims, format == output_format_binary32, "quantity=q\n");
+      return;
+    } // if
     std::ofstream f(filename);
     for (int i = 0; i < qx_.size(); i++)
       f << qx_[i] << ", " << qy_[i] << ", " << qz_[i] << std::endl;
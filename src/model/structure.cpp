@@ -23,7 +23,6 @@
 #include <numerics/matrix.hpp>
 #include <numerics/numeric_utils.hpp>
 #include <common/constants.hpp>
-#include <model/qgrid.hpp>
 
 
 namespace hig {
@@ -181,7 +180,8 @@ namespace hig {
     return true;
   } // Lattice::construct_vectors()
 
-  void Lattice::bragg_angles(vector3_t repeats, vector3_t scaling, real_t k0, real_vec_t & angles){
+  void Lattice::bragg_angles(vector3_t repeats, vector3_t scaling, real_t k0,
+                             vector2_t qmin, vector2_t qmax, real_vec_t & angles){
     angles.clear();
 
     vector3_t a = a_ * scaling[0];
@@ -195,8 +195,6 @@ namespace hig {
     vector3_t mra = cross(b, c) * t1;
     vector3_t mrb = cross(c, a) * t1;
     vector3_t mrc = cross(a, b) * t1;
-    vector2_t qmin = QGrid::instance().qmin();
-    vector2_t qmax = QGrid::instance().qmax();
 
     const real_t d_ang = PI_ / 180. * 0.5;
     std::set<real_t> angs;
@@ -0,0 +1,165 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: fft.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <numerics/fft.hpp>
+#include <common/constants.hpp>
+
+namespace hig {
+
+  unsigned int fft_size(unsigned int n) {
+    unsigned int m = 1;
+    while(m < n) m <<= 1;
+    return m;
+  } // fft_size()
+
+
+  static bool is_pow2(unsigned int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+
+  /* twiddle factors exp(sign i 2 pi k / n), k < n / 2, each computed directly */
+  static void fft_twiddles(unsigned int n, int sign, std::vector<complex_t>& w) {
+    w.resize(n / 2);
+    for(unsigned int k = 0; k < n / 2; ++ k) {
+      real_t theta = sign * 2. * PI_ * k / n;
+      w[k] = complex_t(std::cos(theta), std::sin(theta));
+    } // for
+  } // fft_twiddles()
+
+
+  static void fft_line(complex_t* a, unsigned int n, const complex_t* w) {
+    // bit reversal permutation
+    for(unsigned int i = 1, j = 0; i < n; ++ i) {
+      unsigned int bit = n >> 1;
+      for(; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if(i < j) std::swap(a[i], a[j]);
+    } // for
+    // butterflies
+    for(unsigned int len = 2; len <= n; len <<= 1) {
+      unsigned int half = len >> 1, step = n / len;
+      for(unsigned int i = 0; i < n; i += len) {
+        for(unsigned int j = 0; j < half; ++ j) {
+          complex_t u = a[i + j], v = a[i + j + half] * w[j * step];
+          a[i + j] = u + v;
+          a[i + j + half] = u - v;
+        } // for
+      } // for
+    } // for
+  } // fft_line()
+
+
+  bool fft_1d(complex_t* data, unsigned int n, int sign) {
+    if(!is_pow2(n)) {
+      std::cerr << "error: fft size " << n << " is not a power of two" << std::endl;
+      return false;
+    } // if
+    std::vector<complex_t> w;
+    fft_twiddles(n, sign, w);
+    fft_line(data, n, w.empty() ? NULL : &w[0]);
+    return true;
+  } // fft_1d()
+
+
+  bool fft_3d(complex_t* data, unsigned int nx, unsigned int ny, unsigned int nz, int sign) {
+    if(!is_pow2(nx) || !is_pow2(ny) || !is_pow2(nz)) {
+      std::cerr << "error: fft size " << nx << " x " << ny << " x " << nz
+                << " is not a power of two" << std::endl;
+      return false;
+    } // if
+    const unsigned int n[3] = { nx, ny, nz };
+    const size_t stride[3] = { 1, nx, (size_t) nx * ny };
+    for(int d = 0; d < 3; ++ d) {
+      if(n[d] < 2) continue;
+      std::vector<complex_t> w;
+      fft_twiddles(n[d], sign, w);
+      const complex_t* pw = &w[0];
+      // the lines along dimension d, indexed by the other two coordinates
+      const int d1 = (d + 1) % 3, d2 = (d + 2) % 3;
+      const long int num_lines = (long int) n[d1] * n[d2];
+      #pragma omp parallel
+      {
+        std::vector<complex_t> line(n[d]);
+        #pragma omp for schedule(static)
+        for(long int l = 0; l < num_lines; ++ l) {
+          size_t base = (l % n[d1]) * stride[d1] + (l / n[d1]) * stride[d2];
+          for(unsigned int i = 0; i < n[d]; ++ i) line[i] = data[base + i * stride[d]];
+          fft_line(&line[0], n[d], pw);
+          for(unsigned int i = 0; i < n[d]; ++ i) data[base + i * stride[d]] = line[i];
+        } // for
+      } // omp parallel
+    } // for
+    return true;
+  } // fft_3d()
+
+
+  bool FFTPlan2D::init(unsigned int nx, unsigned int ny) {
+    if(!is_pow2(nx) || !is_pow2(ny)) {
+      std::cerr << "error: fft size " << nx << " x " << ny << " is not a power of two" << std::endl;
+      return false;
+    } // if
+    nx_ = nx; ny_ = ny;
+    fft_twiddles(nx, -1, wx_[0]); fft_twiddles(nx, 1, wx_[1]);
+    fft_twiddles(ny, -1, wy_[0]); fft_twiddles(ny, 1, wy_[1]);
+    return true;
+  } // FFTPlan2D::init()
+
+
+  /* transform along y of the (at most COLS_) columns starting at x0 */
+  void FFTPlan2D::columns(complex_t* data, unsigned int x0, const complex_t* w,
+                          complex_t* line) const {
+    unsigned int nc = std::min(COLS_, nx_ - x0);
+    for(unsigned int y = 0; y < ny_; ++ y) {
+      const complex_t* row = data + (size_t) y * nx_ + x0;
+      for(unsigned int c = 0; c < nc; ++ c) line[(size_t) c * ny_ + y] = row[c];
+    } // for
+    for(unsigned int c = 0; c < nc; ++ c) fft_line(line + (size_t) c * ny_, ny_, w);
+    for(unsigned int y = 0; y < ny_; ++ y) {
+      complex_t* row = data + (size_t) y * nx_ + x0;
+      for(unsigned int c = 0; c < nc; ++ c) row[c] = line[(size_t) c * ny_ + y];
+    } // for
+  } // FFTPlan2D::columns()
+
+
+  void FFTPlan2D::execute(complex_t* data, int sign, complex_t* line) const {
+    int d = (sign < 0) ? 0 : 1;
+    // rows are contiguous
+    if(nx_ > 1) for(unsigned int y = 0; y < ny_; ++ y) fft_line(data + (size_t) y * nx_, nx_, &wx_[d][0]);
+    if(ny_ > 1) for(unsigned int x = 0; x < nx_; x += COLS_) columns(data, x, &wy_[d][0], line);
+  } // FFTPlan2D::execute()
+
+
+  void FFTPlan2D::execute_parallel(complex_t* data, int sign) const {
+    int d = (sign < 0) ? 0 : 1;
+    if(nx_ > 1) {
+      #pragma omp parallel for schedule(static)
+      for(long int y = 0; y < (long int) ny_; ++ y) fft_line(data + (size_t) y * nx_, nx_, &wx_[d][0]);
+    } // if
+    if(ny_ > 1) {
+      #pragma omp parallel
+      {
+        std::vector<complex_t> line(line_size());
+        #pragma omp for schedule(static)
+        for(long int x = 0; x < (long int) nx_; x += COLS_) columns(data, x, &wy_[d][0], &line[0]);
+      } // omp parallel
+    } // if
+  } // FFTPlan2D::execute_parallel()
+
+} // namespace hig
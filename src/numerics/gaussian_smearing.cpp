@@ -0,0 +1,177 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: gaussian_smearing.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include <numerics/gaussian_smearing.hpp>
+#include <common/constants.hpp>
+
+namespace hig {
+
+  const real_t GaussianSmearing::RECURSIVE_MIN_SIGMA_ = 3.;
+
+  /* tile size of the transposes */
+  static const unsigned int SMEAR_TILE_ = 32;
+
+  /* dst (cols x rows) = transpose of src (rows x cols) */
+  static void transpose_tiled(const real_t* src, real_t* dst, unsigned int rows, unsigned int cols) {
+    const long int tr = (rows + SMEAR_TILE_ - 1) / SMEAR_TILE_;
+    const long int tc = (cols + SMEAR_TILE_ - 1) / SMEAR_TILE_;
+    #pragma omp parallel for schedule(static)
+    for(long int t = 0; t < tr * tc; ++ t) {
+      unsigned int r0 = (t / tc) * SMEAR_TILE_, c0 = (t % tc) * SMEAR_TILE_;
+      unsigned int r1 = std::min(rows, r0 + SMEAR_TILE_), c1 = std::min(cols, c0 + SMEAR_TILE_);
+      for(unsigned int r = r0; r < r1; ++ r)
+        for(unsigned int c = c0; c < c1; ++ c)
+          dst[(size_t) c * rows + r] = src[(size_t) r * cols + c];
+    } // for
+  } // transpose_tiled()
+
+
+  /**
+   * coefficients of Deriche's fourth order recursive Gaussian, from the fit
+   *    exp(-x^2 / 2) ~ sum_k (a_k cos(w_k x) + c_k sin(w_k x)) exp(-b_k x), x >= 0
+   * n[0 .. 3] for the causal part, m[0 .. 3] for x[i + 1 .. i + 4] in the anti-causal part,
+   * d[0 .. 3] for both
+   */
+  static void recursive_coeffs(real_t sigma, real_t* n, real_t* m, real_t* d) {
+    const real_t a0 = 1.680, c0 = 3.735, w0 = 0.6318, b0 = 1.783;
+    const real_t a1 = -0.6803, c1 = -0.2598, w1 = 1.997, b1 = 1.723;
+    real_t cw0 = std::cos(w0 / sigma), sw0 = std::sin(w0 / sigma);
+    real_t cw1 = std::cos(w1 / sigma), sw1 = std::sin(w1 / sigma);
+    real_t e0 = std::exp(- b0 / sigma), e1 = std::exp(- b1 / sigma);
+    n[0] = a0 + a1;
+    n[1] = e1 * (c1 * sw1 - (a1 + 2 * a0) * cw1) + e0 * (c0 * sw0 - (2 * a1 + a0) * cw0);
+    n[2] = 2 * e0 * e1 * ((a0 + a1) * cw1 * cw0 - c0 * cw1 * sw0 - c1 * cw0 * sw1)
+           + a1 * e0 * e0 + a0 * e1 * e1;
+    n[3] = e1 * e0 * e0 * (c1 * sw1 - a1 * cw1) + e0 * e1 * e1 * (c0 * sw0 - a0 * cw0);
+    d[0] = - 2 * e1 * cw1 - 2 * e0 * cw0;
+    d[1] = 4 * cw1 * cw0 * e0 * e1 + e1 * e1 + e0 * e0;
+    d[2] = - 2 * cw0 * e0 * e1 * e1 - 2 * cw1 * e1 * e0 * e0;
+    d[3] = e0 * e0 * e1 * e1;
+    for(int k = 0; k < 3; ++ k) m[k] = n[k + 1] - d[k] * n[0];
+    m[3] = - d[3] * n[0];
+  } // recursive_coeffs()
+
+
+  bool GaussianSmearing::smear(real_t* data, unsigned int nx, unsigned int ny, real_t sigma) {
+    if(data == NULL || !(sigma > 0) || nx == 0 || ny == 0) return true;
+    size_t size = (size_t) nx * ny;
+    if(scratch_.size() < size) scratch_.resize(size);
+    real_t* scratch = &scratch_[0];
+
+    // horizontal pass, then the vertical pass on the transposed image
+    filter_rows(data, scratch, ny, nx, sigma);
+    transpose_tiled(scratch, data, ny, nx);
+    filter_rows(data, scratch, nx, ny, sigma);
+    transpose_tiled(scratch, data, nx, ny);
+    return true;
+  } // GaussianSmearing::smear()
+
+
+  void GaussianSmearing::clear() {
+    std::vector<real_t>().swap(scratch_);
+    std::vector<real_t>().swap(weights_);
+    std::vector<real_t>().swap(norm_);
+  } // GaussianSmearing::clear()
+
+
+  void GaussianSmearing::init_direct(real_t sigma) {
+    int r = (int) std::ceil(4 * sigma);
+    weights_.resize(2 * r + 1);
+    for(int k = - r; k <= r; ++ k) weights_[k + r] = std::exp(- (k * k) / (2 * sigma * sigma));
+  } // GaussianSmearing::init_direct()
+
+
+  /* inverses of the kernel weights falling inside a line of length n */
+  void GaussianSmearing::line_norm(unsigned int n, real_t sigma) {
+    norm_.resize(n);
+    if(use_recursive(sigma)) {
+      std::vector<real_t> ones(n, 1.);
+      recursive_line(&ones[0], &norm_[0], n, sigma);
+    } else {
+      int r = weights_.size() / 2;
+      for(int i = 0; i < (int) n; ++ i) {
+        real_t sum = 0.;
+        for(int k = std::max(- r, - i); k <= std::min(r, (int) n - 1 - i); ++ k) sum += weights_[k + r];
+        norm_[i] = sum;
+      } // for
+    } // if-else
+    for(unsigned int i = 0; i < n; ++ i) norm_[i] = (norm_[i] > TINY_) ? 1. / norm_[i] : 0.;
+  } // GaussianSmearing::line_norm()
+
+
+  void GaussianSmearing::filter_rows(const real_t* src, real_t* dst, unsigned int rows,
+                                     unsigned int n, real_t sigma) {
+    bool recursive = use_recursive(sigma);
+    if(!recursive) init_direct(sigma);
+    line_norm(n, sigma);
+    #pragma omp parallel for schedule(static)
+    for(long int l = 0; l < (long int) rows; ++ l) {
+      const real_t* in = src + l * n;
+      real_t* out = dst + l * n;
+      if(recursive) recursive_line(in, out, n, sigma);
+      else direct_line(in, out, n);
+      for(unsigned int i = 0; i < n; ++ i) out[i] *= norm_[i];
+    } // for
+  } // GaussianSmearing::filter_rows()
+
+
+  /* unnormalized truncated kernel, each tap applied to the whole line */
+  void GaussianSmearing::direct_line(const real_t* in, real_t* out, unsigned int n) const {
+    int r = weights_.size() / 2;
+    for(unsigned int i = 0; i < n; ++ i) out[i] = 0.;
+    for(int k = - r; k <= r; ++ k) {
+      int lo = std::max(0, - k), hi = std::min((int) n, (int) n - k);
+      real_t w = weights_[k + r];
+      const real_t* in_k = in + k;
+      #pragma omp simd
+      for(int i = lo; i < hi; ++ i) out[i] += w * in_k[i];
+    } // for
+  } // GaussianSmearing::direct_line()
+
+
+  /**
+   * sum of the causal and the anti-causal recursions, both on the input. with zero
+   * histories these are exact for the zero extension of the line. the result is not
+   * normalized
+   */
+  void GaussianSmearing::recursive_line(const real_t* in, real_t* out, unsigned int n,
+                                        real_t sigma) const {
+    real_t nc[4], mc[4], d[4];
+    recursive_coeffs(sigma, nc, mc, d);
+    real_t x1 = 0., x2 = 0., x3 = 0., y1 = 0., y2 = 0., y3 = 0., y4 = 0.;
+    for(unsigned int i = 0; i < n; ++ i) {
+      real_t x0 = in[i];
+      real_t y = nc[0] * x0 + nc[1] * x1 + nc[2] * x2 + nc[3] * x3
+                 - d[0] * y1 - d[1] * y2 - d[2] * y3 - d[3] * y4;
+      out[i] = y;
+      x3 = x2; x2 = x1; x1 = x0;
+      y4 = y3; y3 = y2; y2 = y1; y1 = y;
+    } // for
+    real_t x4 = 0.;
+    x1 = x2 = x3 = 0.; y1 = y2 = y3 = y4 = 0.;
+    for(int i = n - 1; i >= 0; -- i) {
+      real_t y = mc[0] * x1 + mc[1] * x2 + mc[2] * x3 + mc[3] * x4
+                 - d[0] * y1 - d[1] * y2 - d[2] * y3 - d[3] * y4;
+      out[i] += y;
+      x4 = x3; x3 = x2; x2 = x1; x1 = in[i];
+      y4 = y3; y3 = y2; y2 = y1; y1 = y;
+    } // for
+  } // GaussianSmearing::recursive_line()
+
+} // namespace hig
@@ -0,0 +1,222 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: psf_convolution.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <numerics/psf_convolution.hpp>
+#include <common/constants.hpp>
+
+namespace hig {
+
+  bool PSFConvolution::kernel(const real_t* k, unsigned int kx, unsigned int ky) {
+    clear();
+    if(k == NULL || kx == 0 || ky == 0) {
+      std::cerr << "error: empty point spread kernel" << std::endl;
+      return false;
+    } // if
+    real_t sum = 0.;
+    for(size_t i = 0; i < (size_t) kx * ky; ++ i) sum += k[i];
+    if(!(sum > 0)) {
+      std::cerr << "error: point spread kernel does not have a positive sum" << std::endl;
+      return false;
+    } // if
+    kernel_.resize((size_t) kx * ky);
+    for(size_t i = 0; i < kernel_.size(); ++ i) kernel_[i] = k[i] / sum;
+    kx_ = kx; ky_ = ky;
+    return true;
+  } // PSFConvolution::kernel()
+
+
+  void PSFConvolution::clear() {
+    kernel_.clear(); kx_ = ky_ = 0;
+    nx_ = ny_ = 0; bx_ = by_ = 0;
+    plan_.clear();
+    std::vector<complex_t>().swap(spectrum_);
+    std::vector<real_t>().swap(norm_);
+    std::vector<real_t>().swap(full_);
+    std::vector<complex_t>().swap(tiles_);
+  } // PSFConvolution::clear()
+
+
+  /* tile transform size and image block along a dimension of size n, for kernel size k */
+  static void tile_size(unsigned int n, unsigned int k, unsigned int max_single, unsigned int min_tile,
+                        unsigned int& t, unsigned int& b) {
+    t = fft_size(n + k - 1);
+    if(t > max_single) t = std::min(t, fft_size(std::max(2 * k, min_tile)));
+    b = std::min(n, t - k + 1);
+  } // tile_size()
+
+
+  bool PSFConvolution::plan(unsigned int nx, unsigned int ny) {
+    nx_ = ny_ = 0;
+    if(kx_ * ky_ > MAX_DIRECT_TAPS_) {
+      unsigned int tx, ty;
+      tile_size(nx, kx_, MAX_SINGLE_TILE_, MIN_TILE_, tx, bx_);
+      tile_size(ny, ky_, MAX_SINGLE_TILE_, MIN_TILE_, ty, by_);
+      if(!plan_.init(tx, ty)) return false;
+
+      #ifdef _OPENMP
+        int num_threads = omp_get_max_threads();
+      #else
+        int num_threads = 1;
+      #endif
+      size_t tile = (size_t) tx * ty;
+      tiles_.resize(num_threads * (tile + plan_.line_size()));
+
+      // kernel transform, with the normalization of the inverse transform
+      spectrum_.assign(tile, CMPLX_ZERO_);
+      for(unsigned int y = 0; y < ky_; ++ y)
+        for(unsigned int x = 0; x < kx_; ++ x)
+          spectrum_[(size_t) y * tx + x] = kernel_[(size_t) y * kx_ + x];
+      plan_.execute_parallel(&spectrum_[0], -1);
+      real_t scale = 1. / tile;
+      for(size_t i = 0; i < tile; ++ i) spectrum_[i] *= scale;
+    } // if
+
+    nx_ = nx; ny_ = ny;
+    full_.resize((size_t) (nx + kx_ - 1) * (ny + ky_ - 1));
+
+    // weight of the kernel inside the image
+    std::vector<real_t> ones((size_t) nx * ny, 1.);
+    convolve_full(&ones[0]);
+    norm_.resize((size_t) nx * ny);
+    unsigned int fx = nx + kx_ - 1, cx = kx_ / 2, cy = ky_ / 2;
+    for(unsigned int y = 0; y < ny; ++ y) {
+      for(unsigned int x = 0; x < nx; ++ x) {
+        real_t w = full_[(size_t) (y + cy) * fx + x + cx];
+        norm_[(size_t) y * nx + x] = (w > TINY_) ? 1. / w : 0.;
+      } // for
+    } // for
+    return true;
+  } // PSFConvolution::plan()
+
+
+  /**
+   * transform the image blocks a and b (if b >= 0) packed into one tile, multiply with the
+   * kernel transform, and add the result to full_. with line == NULL the transforms are
+   * distributed over the threads
+   */
+  void PSFConvolution::tile_pair(const real_t* src, long int a, long int b, complex_t* buf,
+                                 complex_t* line) {
+    const unsigned int tx = plan_.nx(), ty = plan_.ny();
+    const unsigned int fx = nx_ + kx_ - 1, ntx = (nx_ + bx_ - 1) / bx_;
+    const size_t tile = (size_t) tx * ty;
+    const long int block[2] = { a, b };
+    const int num = (b < 0) ? 1 : 2;
+
+    std::fill(buf, buf + tile, CMPLX_ZERO_);
+    // the first block in the real parts, the second in the imaginary parts
+    for(int i = 0; i < num; ++ i) {
+      unsigned int ox = (block[i] % ntx) * bx_, oy = (block[i] / ntx) * by_;
+      unsigned int w = std::min(bx_, nx_ - ox), h = std::min(by_, ny_ - oy);
+      for(unsigned int y = 0; y < h; ++ y) {
+        const real_t* in = src + (size_t) (oy + y) * nx_ + ox;
+        complex_t* row = buf + (size_t) y * tx;
+        if(i == 0) for(unsigned int x = 0; x < w; ++ x) row[x] = complex_t(in[x], 0.);
+        else for(unsigned int x = 0; x < w; ++ x) row[x] = complex_t(row[x].real(), in[x]);
+      } // for
+    } // for
+    if(line == NULL) plan_.execute_parallel(buf, -1);
+    else plan_.execute(buf, -1, line);
+    for(size_t i = 0; i < tile; ++ i) buf[i] *= spectrum_[i];
+    if(line == NULL) plan_.execute_parallel(buf, 1);
+    else plan_.execute(buf, 1, line);
+    for(int i = 0; i < num; ++ i) {
+      unsigned int ox = (block[i] % ntx) * bx_, oy = (block[i] / ntx) * by_;
+      unsigned int w = std::min(bx_, nx_ - ox) + kx_ - 1, h = std::min(by_, ny_ - oy) + ky_ - 1;
+      for(unsigned int y = 0; y < h; ++ y) {
+        real_t* out = &full_[(size_t) (oy + y) * fx + ox];
+        const complex_t* row = buf + (size_t) y * tx;
+        if(i == 0) for(unsigned int x = 0; x < w; ++ x) out[x] += row[x].real();
+        else for(unsigned int x = 0; x < w; ++ x) out[x] += row[x].imag();
+      } // for
+    } // for
+  } // PSFConvolution::tile_pair()
+
+
+  /* full linear convolution of the image into full_, directly for small kernels */
+  void PSFConvolution::convolve_full(const real_t* src) {
+    const unsigned int fx = nx_ + kx_ - 1, fy = ny_ + ky_ - 1;
+    std::fill(full_.begin(), full_.end(), 0.);
+
+    if(kx_ * ky_ <= MAX_DIRECT_TAPS_) {
+      #pragma omp parallel for schedule(static)
+      for(long int y = 0; y < (long int) fy; ++ y) {
+        real_t* out = &full_[(size_t) y * fx];
+        for(unsigned int q = 0; q < ky_; ++ q) {
+          if(y < (long int) q || y - q >= ny_) continue;
+          const real_t* in = src + (size_t) (y - q) * nx_;
+          for(unsigned int p = 0; p < kx_; ++ p) {
+            real_t k = kernel_[(size_t) q * kx_ + p];
+            real_t* out_p = out + p;
+            #pragma omp simd
+            for(unsigned int x = 0; x < nx_; ++ x) out_p[x] += k * in[x];
+          } // for
+        } // for
+      } // for
+      return;
+    } // if
+
+    const unsigned int ntx = (nx_ + bx_ - 1) / bx_, nty = (ny_ + by_ - 1) / by_;
+    if(ntx * nty <= 2) {
+      // not enough tiles to go around, parallelize the transforms instead
+      tile_pair(src, 0, (ntx * nty == 2) ? 1 : -1, &tiles_[0], NULL);
+      return;
+    } // if
+
+    // overlap-add. the outputs of tiles two blocks apart do not overlap, since a block is at
+    // least the kernel size, so the tiles are processed in four sets by their block parities
+    const size_t stride = (size_t) plan_.nx() * plan_.ny() + plan_.line_size();
+    for(int parity = 0; parity < 4; ++ parity) {
+      std::vector<long int> blocks;
+      for(unsigned int iy = parity / 2; iy < nty; iy += 2)
+        for(unsigned int ix = parity % 2; ix < ntx; ix += 2) blocks.push_back(iy * ntx + ix);
+      const long int num_pairs = (blocks.size() + 1) / 2;
+
+      #pragma omp parallel for schedule(dynamic)
+      for(long int p = 0; p < num_pairs; ++ p) {
+        #ifdef _OPENMP
+          complex_t* buf = &tiles_[omp_get_thread_num() * stride];
+        #else
+          complex_t* buf = &tiles_[0];
+        #endif
+        long int b = (2 * p + 1 < (long int) blocks.size()) ? blocks[2 * p + 1] : -1;
+        tile_pair(src, blocks[2 * p], b, buf, buf + stride - plan_.line_size());
+      } // for
+    } // for
+  } // PSFConvolution::convolve_full()
+
+
+  bool PSFConvolution::convolve(real_t* data, unsigned int nx, unsigned int ny) {
+    if(kernel_.empty() || data == NULL || nx == 0 || ny == 0) return true;
+    if((nx != nx_ || ny != ny_) && !plan(nx, ny)) return false;
+    convolve_full(data);
+    unsigned int fx = nx + kx_ - 1, cx = kx_ / 2, cy = ky_ / 2;
+    #pragma omp parallel for schedule(static)
+    for(long int y = 0; y < (long int) ny; ++ y) {
+      for(unsigned int x = 0; x < nx; ++ x) {
+        size_t i = (size_t) y * nx + x;
+        data[i] = full_[(size_t) (y + cy) * fx + x + cx] * norm_[i];
+      } // for
+    } // for
+    return true;
+  } // PSFConvolution::convolve()
+
+} // namespace hig
@@ -34,7 +34,7 @@ namespace hig {
 #pragma omp parallel for
     for (int i = 0; i < nz_; i++){
       int j = i % ny_;
-      real_t qy = QGrid::instance().qy(j);
+      real_t qy = qgrid_.qy(j);
       real_t qysy = stddev_dist * qy;
       real_t exp_v2 = std::exp(-1.0 * qysy * qysy);
       real_t exp_v3 = std::exp(-0.5 * qysy * qysy);
@@ -53,8 +53,8 @@ namespace hig {
 #pragma omp parallel for
     for (int i = 0; i < nz_; i++){
       int j = i % ny_;
-      real_t qx = QGrid::instance().qx(j);
-      real_t qy = QGrid::instance().qy(j);
+      real_t qx = qgrid_.qx(j);
+      real_t qy = qgrid_.qy(j);
       real_t qpar = std::sqrt(qx * qx + qy * qy);
       real_t cos_vx = std::cos(qpar * mean_dist_x);
       real_t cos_vy = std::cos(qpar * mean_dist_y);
@@ -87,8 +87,8 @@ namespace hig {
 #pragma omp parallel for
     for (int i = 0; i < nz_; i++){
       int j = i % ny_;
-      real_t qx = QGrid::instance().qx(j);
-      real_t qy = QGrid::instance().qy(j);
+      real_t qx = qgrid_.qx(j);
+      real_t qy = qgrid_.qy(j);
       real_t qpar = std::sqrt(qx*qx + qy*qy);
       real_t qpsx = qpar * stddev_dist_x;
       real_t qpsy = qpar * stddev_dist_y;
@@ -133,8 +133,8 @@ namespace hig {
 #pragma omp parallel for
       for (int i = 0; i < nz_; i++){
         int j = i % ny_;
-        real_t qx = QGrid::instance().qx(j);
-        real_t qy = QGrid::instance().qy(j);
+        real_t qx = qgrid_.qx(j);
+        real_t qy = qgrid_.qy(j);
         real_t qval = std::sqrt(qx * qx + qy * qy);
         if ( qval < 1.0E-06 )
           sf_[i] = alpha / 3. + beta / 4. + gamma;
@@ -148,9 +148,9 @@ namespace hig {
 #pragma omp parallel for
       for (int i = 0; i < nz_; i++){
         int j = i % ny_;
-        real_t qx = QGrid::instance().qx(j);
-        real_t qy = QGrid::instance().qy(j);
-        complex_t qz = QGrid::instance().qz_extended(i);
+        real_t qx = qgrid_.qx(j);
+        real_t qy = qgrid_.qy(j);
+        complex_t qz = qgrid_.qz_extended(i);
         real_t qval = std::sqrt(qx * qx + qy * qy + std::norm(qz));
         if (qval < 1.0E-06)
           sf_[i] = alpha / 3. + beta / 4. + gamma;
@@ -21,6 +21,7 @@
 
 #include <woo/timer/woo_boostchronotimers.hpp>
 #include <sf/sf.hpp>
+#include <file/raw_data.hpp>
 #include <model/qgrid.hpp> 
 #include <utils/utilities.hpp>
 #include <common/constants.hpp>
@@ -46,6 +47,7 @@ namespace hig {
     ny_ = rhs.ny_;
     nz_ = rhs.nz_;
     type_ = rhs.type_;
+    qgrid_ = rhs.qgrid_;
     if(sf_ != NULL) delete[] sf_;
     sf_ = new (std::nothrow) complex_t[nz_];
     if(sf_ == NULL) {
@@ -79,13 +81,29 @@ namespace hig {
     #endif
   } // StructureFactor::clear()
 
+  /**
+   * sum over n repetitions along one lattice direction, centered at the origin:
+   * exp(i (1 - n) x / 2) (1 - exp(i n x)) / (1 - exp(i x)), with x = xr + i xi
+   */
+  static inline complex_t lattice_sum(real_t xr, real_t xi, real_t n, real_t eps) {
+    complex_t e1 = std::exp(- xi) * complex_t(std::cos(xr), std::sin(xr));
+    complex_t en = std::exp(- n * xi) * complex_t(std::cos(n * xr), std::sin(n * xr));
+    complex_t den = (real_t) 1.0 - e1;
+    complex_t s = n;
+    if(fabs(den.real()) > eps || fabs(den.imag()) > eps) s = ((real_t) 1.0 - en) / den;
+    real_t h = ((real_t) 1.0 - n) / (real_t) 2.0;
+    return s * std::exp(- h * xi) * complex_t(std::cos(h * xr), std::sin(h * xr));
+  } // lattice_sum()
+
+
   /**
    * compute structure factor on cpu
    */
   bool StructureFactor::compute_structure_factor(std::string expt, vector3_t center,
                Lattice* lattice, vector3_t repet, vector3_t scaling,
                RotMatrix_t & rot,
-               std::shared_ptr<Paracrystal> pc, std::shared_ptr<PercusYevick> py
+               std::shared_ptr<Paracrystal> pc, std::shared_ptr<PercusYevick> py,
+               const QGridView& qgrid
                #ifdef USE_MPI
                  , woo::MultiNode& world_comm, std::string comm_key
                #endif
@@ -96,9 +114,10 @@ namespace hig {
       bool master = true;
     #endif
 
-    ny_ = QGrid::instance().nqy();
-    if(expt == "saxs") nz_ = QGrid::instance().nqz();
-    else if(expt == "gisaxs") nz_ = QGrid::instance().nqz_extended();
+    qgrid_ = qgrid;
+    ny_ = qgrid_.nqy();
+    if(expt == "saxs") nz_ = qgrid_.nqz();
+    else if(expt == "gisaxs") nz_ = qgrid_.nqz_extended();
     else return false;
 
     woo::BoostChronoTimer maintimer, computetimer;
@@ -174,88 +193,47 @@ namespace hig {
       if(master) std::cerr << "-- Computing structure factor on CPU ... " << std::flush;
     #endif
 
-    std::complex<real_t> unit_c(1, 0);
-    std::complex<real_t> unit_ci(0, 1);
-
     real_t mach_eps = std::numeric_limits<real_t>::epsilon() ; //move to constants.hpp if not there
     computetimer.start();
 
-    /* TODO:
-     *  Rotating q-vector is done for every single q-vector.
-     *  This can be avoided by rotation of lattice vectors which 
-     *  will not change for the grain.
-     */
+    // (rot q) . v = q . (rot^T v): rotate the lattice vectors and the center once for the grain
+    // instead of rotating every q-vector
+    real_t ra[3], rb[3], rc[3], rcenter[3];
+    for(int k = 0; k < 3; ++ k) {
+      ra[k] = rot(0, k) * la[0] + rot(1, k) * la[1] + rot(2, k) * la[2];
+      rb[k] = rot(0, k) * lb[0] + rot(1, k) * lb[1] + rot(2, k) * lb[2];
+      rc[k] = rot(0, k) * lc[0] + rot(1, k) * lc[1] + rot(2, k) * lc[2];
+      rcenter[k] = rot(0, k) * center[0] + rot(1, k) * center[1] + rot(2, k) * center[2];
+    } // for
+    bool center_phase = (center[0] != 0 || center[1] != 0 || center[2] != 0);
+
+    const real_t* qx = qgrid_.qx();
+    const real_t* qy = qgrid_.qy();
+    // experiment type decides the qz used, resolve it once outside the loop
+    bool gisaxs = (expt == "gisaxs");
+    const real_t* qz_r = gisaxs ? NULL : qgrid_.qz();
+    const complex_t* qz_c = gisaxs ? qgrid_.qz_extended() : NULL;
 
     #pragma omp parallel for
     for(unsigned int i = 0; i < nz_; ++ i) {
-      complex_t temp1, temp_x2, temp_y3, temp_y4, temp_x5;
-      unsigned j = i % ny_;
-      real_t temp_f;
-      complex_t sa, sb, sc;
-      real_t qx = QGrid::instance().qx(j);
-      real_t qy = QGrid::instance().qy(j);
-
-      complex_t qz;
-      if(expt == "saxs") qz = QGrid::instance().qz(i);
-      else if(expt == "gisaxs") qz = QGrid::instance().qz_extended(i);
-      std::vector<complex_t> mq = rot.rotate(qx, qy, qz);
-
-      complex_t e_iqa = exp(unit_ci * (la[0] * mq[0] + la[1] * mq[1] + la[2] * mq[2]));
-      complex_t Xa_0 = unit_c - pow(e_iqa, repet[0]);
-      complex_t Ya_0 = unit_c - e_iqa;
-
-      real_t tempya = sqrt(Ya_0.real() * Ya_0.real() + Ya_0.imag() * Ya_0.imag());
-      if(fabs(Ya_0.imag()) > mach_eps || fabs(Ya_0.real()) > mach_eps) sa = Xa_0 / Ya_0;
-      else sa = repet[0];
-      sa = pow(e_iqa, ((real_t) 1.0 - repet[0]) / (real_t) 2.0) * sa;
-
-      complex_t iqb = unit_ci *  (lb[0] * mq[0] + lb[1] * mq[1] + lb[2] * lb[2]) ;
-      complex_t iqNb =  repet[1] * iqb;
-
-      complex_t e_iqb = exp(iqb);
-      complex_t Xb_0 = unit_c - exp(iqNb);
-      complex_t Yb_0 = unit_c - exp(iqb);
-
-      real_t tempyb = sqrt(Yb_0.real() * Yb_0.real() + Yb_0.imag() * Yb_0.imag());
-      if(fabs(Yb_0.imag()) > mach_eps || fabs(Yb_0.real()) > mach_eps) sb = Xb_0 / Yb_0;
-      else sb = repet[1];
-      sb = pow(e_iqb, ((real_t) 1.0 - repet[1]) / (real_t) 2.0) * sb;
-
-
-      complex_t e_iqc = exp(unit_ci * (lc[0] * mq[0] + lc[1] * mq[1] + lc[2] * mq[2]));
-      complex_t Xc_0 = unit_c - pow(e_iqc, repet[2]);
-      complex_t Yc_0 = unit_c - e_iqc;
-
-      real_t tempyc = sqrt(Yc_0.real() * Yc_0.real() + Yc_0.imag() * Yc_0.imag());
-      if(fabs(Yc_0.imag()) > mach_eps || fabs(Yc_0.real()) > mach_eps) sc = Xc_0 / Yc_0;
-      else sc = repet[2];
-      sc = pow(e_iqc, ((real_t) 1.0 - repet[2]) / (real_t) 2.0) * sc;
-
-      if(!((boost::math::isfinite)(sa.real()) && (boost::math::isfinite)(sa.imag()))) {
-        std::cerr << "sa sa sa sa sa sa sa: " << i << ", " << j << std::endl; }
-      if(!((boost::math::isfinite)(sb.real()) && (boost::math::isfinite)(sb.imag()))) {
-        std::cerr << "sb sb sb sb sb sb sb: " << i << ", " << j << std::endl; }
-      if(!((boost::math::isfinite)(sc.real()) && (boost::math::isfinite)(sc.imag()))) {
-        std::cerr << "sc sc sc sc sc sc sc: " << i << ", " << j << std::endl; }
-
-      complex_t temp3 = center[0] * mq[0] + center[1] * mq[1] + center[2] * mq[2];
-      temp3 = exp(complex_t(-temp3.imag(), temp3.real()));
-      //complex_t temp2 = l_t[0] * qx + l_t[1] * qy + l_t[2] * qz;
-      //temp2 = unit_c + exp(complex_t(-temp2.imag(), temp2.real()));
-      sf_[i] = temp3 * sa * sb * sc;
-
-      /************
-      if(!((boost::math::isfinite)(temp3.real()) && (boost::math::isfinite)(temp3.imag()))) {
-        std::cerr << "error: here it is not finite (666) " << i << ", " << j
-              << ": here it is finite (444) " << center[0] << ", "
-              << center[1] << ", " << center[2] << std::endl;
+      unsigned int j = i % ny_;
+      real_t qzr = gisaxs ? qz_c[i].real() : qz_r[i];
+      real_t qzi = gisaxs ? qz_c[i].imag() : 0.0;
+
+      // phases q.a, q.b, q.c (complex through qz)
+      real_t xar = qx[j] * ra[0] + qy[j] * ra[1] + qzr * ra[2], xai = qzi * ra[2];
+      real_t xbr = qx[j] * rb[0] + qy[j] * rb[1] + qzr * rb[2], xbi = qzi * rb[2];
+      real_t xcr = qx[j] * rc[0] + qy[j] * rc[1] + qzr * rc[2], xci = qzi * rc[2];
+
+      complex_t temp = lattice_sum(xar, xai, repet[0], mach_eps) *
+                       lattice_sum(xbr, xbi, repet[1], mach_eps) *
+                       lattice_sum(xcr, xci, repet[2], mach_eps);
+      if(center_phase) {
+        real_t xr = qx[j] * rcenter[0] + qy[j] * rcenter[1] + qzr * rcenter[2];
+        real_t xi = qzi * rcenter[2];
+        temp *= std::exp(- xi) * complex_t(std::cos(xr), std::sin(xr));
       } // if
-
-      if(!((boost::math::isfinite)(temp2.real()) && (boost::math::isfinite)(temp2.imag()))) {
-        std::cerr << "error: here it is not finite (888) " << i << ", " << j << std::endl;
-      } // if
-      ************/
-
+      sf_[i] = temp;
     } // for i
 
     computetimer.stop();
@@ -318,7 +296,13 @@ namespace hig {
     f.close();
   } // StructureFactor::save_sf()
 
-  void StructureFactor::save_sf(const std::string& filename) {
+  void StructureFactor::save_sf(const std::string& filename, OutputFormatType format) {
+    if(format != output_format_text) {
+      std::vector<real_t> mag(nz_);
+      for(unsigned int z = 0; z < nz_; ++ z) mag[z] = std::abs(sf_[z]);
+      write_raw_data(filename, &mag[0], 1, &nz_, format == output_format_binary32, "quantity=|sf|\n");
+      return;
+    } // if
     std::ofstream f(filename.c_str());
     for(unsigned int z = 0; z < nz_; ++ z) {
       f << std::abs(sf_[z]) << std::endl;
@@ -0,0 +1,71 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: dwba_combine.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+
+#include <common/constants.hpp>
+#include <sim/dwba_combine.hpp>
+
+namespace hig {
+
+  bool DWBACombine::prepare(const complex_t* fc, const std::vector<complex_t>& ff,
+                            unsigned int imsize, unsigned int nchannels) {
+    unsigned int size = imsize * nchannels;
+    if(ff.size() < size) {
+      std::cerr << "error: form factor is smaller than the dwba channels" << std::endl;
+      return false;
+    } // if
+    imsize_ = imsize;
+    nchannels_ = nchannels;
+    fcff_.resize(size);    // keeps its capacity across grains
+    if(fc == NULL) {
+      #pragma omp parallel for
+      for(unsigned int i = 0; i < size; ++ i) fcff_[i] = ff[i];
+    } else {
+      #pragma omp parallel for
+      for(unsigned int i = 0; i < size; ++ i) fcff_[i] = fc[i] * ff[i];
+    } // if-else
+    return true;
+  } // DWBACombine::prepare()
+
+
+  bool DWBACombine::accumulate(const StructureFactor& sf, real_t weight, real_t* image) const {
+    if(image == NULL || nchannels_ == 0) return false;
+    const complex_t* fcff = &fcff_[0];
+    unsigned int imsize = imsize_;
+    if(nchannels_ == 4) {
+      #pragma omp parallel for
+      for(unsigned int i = 0; i < imsize; ++ i) {
+        complex_t temp = fcff[i] * sf[i] +
+                         fcff[imsize + i] * sf[imsize + i] +
+                         fcff[2 * imsize + i] * sf[2 * imsize + i] +
+                         fcff[3 * imsize + i] * sf[3 * imsize + i];
+        temp *= weight;
+        image[i] += temp.real() * temp.real() + temp.imag() * temp.imag();
+      } // for
+    } else {
+      #pragma omp parallel for
+      for(unsigned int i = 0; i < imsize; ++ i) {
+        complex_t temp = CMPLX_ZERO_;
+        for(unsigned int k = 0; k < nchannels_; ++ k) temp += fcff[k * imsize + i] * sf[k * imsize + i];
+        temp *= weight;
+        image[i] += temp.real() * temp.real() + temp.imag() * temp.imag();
+      } // for
+    } // if-else
+    return true;
+  } // DWBACombine::accumulate()
+
+} // namespace hig
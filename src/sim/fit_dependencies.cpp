@@ -0,0 +1,122 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: fit_dependencies.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <iostream>
+
+#include <sim/fit_dependencies.hpp>
+#include <utils/string_utils.hpp>
+#include <config/token_mapper.hpp>
+
+namespace hig {
+
+  bool FitDependencies::param_stages(const std::string& param, const Input& input,
+                                     stage_map_t& dirty) {
+    const structure_list_t& structs = input.structures();
+    std::string keyword, rem_param, keyword_name, keyword_key;
+    if(param.empty() || !extract_first_keyword(param, keyword, rem_param) ||
+        !extract_keyword_name_and_key(keyword, keyword_name, keyword_key)) {
+      // unknown, be conservative
+      for(structure_citerator_t s = structs.begin(); s != structs.end(); ++ s)
+        dirty[(*s).first] |= fit_stage_all;
+      return true;
+    } // if
+
+    switch(TokenMapper::instance().get_keyword_token(keyword_name)) {
+      case shape_token:
+        // only the form factors of structures containing the shape
+        for(structure_citerator_t s = structs.begin(); s != structs.end(); ++ s) {
+          unitcell_list_t::const_iterator u = input.unitcells().find((*s).second.grain_unitcell_key());
+          if(u == input.unitcells().end()) continue;
+          for(Unitcell::element_citerator_t e = (*u).second.element_cbegin();
+              e != (*u).second.element_cend(); ++ e) {
+            if((*e).first == keyword_key) { dirty[(*s).first] |= fit_stage_ff; break; }
+          } // for
+        } // for
+        break;
+
+      case layer_token:
+        // the propagation coefficients, qz_extended and dn2 depend on all the layers
+        for(structure_citerator_t s = structs.begin(); s != structs.end(); ++ s)
+          dirty[(*s).first] |= fit_stage_layer | fit_stage_ff | fit_stage_sf;
+        break;
+
+      case struct_token: {
+          structure_citerator_t s = structs.find(keyword_key);
+          if(s == structs.end()) {
+            std::cerr << "error: unknown structure in fit parameter '" << param << "'" << std::endl;
+            return false;
+          } // if
+          // bragg orientations are computed from the lattice, scaling and repetitions
+          bool bragg = ((*s).second.grain_orientation() == "bragg");
+          unsigned int& stages = dirty[(*s).first];
+          std::string keyword2, rem_param2;
+          extract_first_keyword(rem_param, keyword2, rem_param2);
+          switch(TokenMapper::instance().get_keyword_token(keyword2)) {
+            case struct_iratio_token:
+              break;    // used only when combining the structures
+
+            case struct_grain_token: {
+                std::string keyword3, rem_param3;
+                extract_first_keyword(rem_param2, keyword3, rem_param3);
+                switch(TokenMapper::instance().get_keyword_token(keyword3)) {
+                  case struct_grain_lattice_token:
+                    stages |= fit_stage_sf;
+                    if(bragg) stages |= fit_stage_grains | fit_stage_ff;
+                    break;
+                  case struct_grain_scaling_token:
+                  case struct_grain_repetition_token:
+                    stages |= fit_stage_samples | fit_stage_sf;
+                    if(bragg) stages |= fit_stage_grains | fit_stage_ff;
+                    break;
+                  case struct_grain_transvec_token:
+                    stages |= fit_stage_sf;   // only moves the grain centers
+                    break;
+                  default:
+                    stages |= fit_stage_ff | fit_stage_sf;
+                } // switch
+              } // case
+              break;
+
+            case struct_ensemble_token:
+              stages |= fit_stage_grains | fit_stage_samples | fit_stage_ff | fit_stage_sf;
+              break;
+
+            default:
+              stages |= fit_stage_all;
+          } // switch
+        } // case
+        break;
+
+      default:
+        // instrument and compute parameters may change anything
+        for(structure_citerator_t s = structs.begin(); s != structs.end(); ++ s)
+          dirty[(*s).first] |= fit_stage_all;
+    } // switch
+    return true;
+  } // FitDependencies::param_stages()
+
+
+  bool FitDependencies::update(const map_t& params, const Input& input, stage_map_t& dirty) {
+    for(map_t::const_iterator p = params.begin(); p != params.end(); ++ p) {
+      map_t::iterator v = values_.find((*p).first);
+      if(v != values_.end() && (*v).second == (*p).second) continue;   // unchanged
+      if(!param_stages(input.fit_param_string((*p).first), input, dirty)) return false;
+      values_[(*p).first] = (*p).second;
+    } // for
+    return true;
+  } // FitDependencies::update()
+
+} // namespace hig
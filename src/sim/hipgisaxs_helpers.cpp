@@ -15,17 +15,67 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include <boost/math/special_functions/fpclassify.hpp>
 
 #include <sim/hipgisaxs_main.hpp>
-#include <numerics/convolutions.hpp>
+#include <file/hig_file_reader.hpp>
 
 namespace hig {
 
   bool HipGISAXS::gaussian_smearing(real_t*& data, real_t sigma) {
-    return Convolutions::instance().convolution_gaussian_2d(data, ncol_, nrow_, sigma);
+    return smearing_.smear(data, ncol_, nrow_, sigma);
   } // HipGISAXS::gaussian_smearing()
 
+  bool HipGISAXS::load_psf() {
+    psf_.clear();
+    psf_kernel_.clear(); psf_kx_ = psf_ky_ = 0;
+    const std::string& filename = input_->scattering().psf();
+    if(filename.empty()) return true;
+    if(HiGFileReader::instance().psf_reader(filename.c_str(), psf_kernel_, psf_kx_, psf_ky_) == 0)
+      return false;
+    return bin_psf(qbin_);
+  } // HipGISAXS::load_psf()
+
+  /**
+   * set the point spread kernel for a q-grid of bin x bin detector pixel bins. the response
+   * between two bins is the kernel convolved with the bin box and sampled every bin pixels,
+   * so a value at offset d = D * bin + r from the center goes to the offsets D and D + 1 with
+   * the weights (bin - r) and r along each axis. psf_ normalizes the result
+   */
+  bool HipGISAXS::bin_psf(unsigned int bin) {
+    if(psf_kernel_.empty()) return true;
+    if(bin <= 1) return psf_.kernel(&psf_kernel_[0], psf_kx_, psf_ky_);
+    int b = bin, cx = psf_kx_ / 2, cy = psf_ky_ / 2;
+    int rx = (std::max(cx, (int) psf_kx_ - 1 - cx) + b - 1) / b;
+    int ry = (std::max(cy, (int) psf_ky_ - 1 - cy) + b - 1) / b;
+    unsigned int kx = 2 * rx + 1, ky = 2 * ry + 1;
+    std::vector<real_t> kernel((size_t) kx * ky, 0.);
+    for(int y = 0; y < (int) psf_ky_; ++ y) {
+      int dy = y - cy + ry * b;     // shifted to be non-negative
+      int ly = dy / b, fy = dy % b;
+      for(int x = 0; x < (int) psf_kx_; ++ x) {
+        int dx = x - cx + rx * b;
+        int lx = dx / b, fx = dx % b;
+        real_t k = psf_kernel_[(size_t) y * psf_kx_ + x];
+        for(int j = 0; j < 2; ++ j) {
+          real_t wy = j ? fy : b - fy;
+          if(wy == 0) continue;
+          for(int i = 0; i < 2; ++ i) {
+            real_t wx = i ? fx : b - fx;
+            if(wx == 0) continue;
+            kernel[(size_t) (ly + j) * kx + lx + i] += k * wx * wy;
+          } // for
+        } // for
+      } // for
+    } // for
+    return psf_.kernel(&kernel[0], kx, ky);
+  } // HipGISAXS::bin_psf()
+
+  bool HipGISAXS::psf_convolution(real_t* data) {
+    return psf_.convolve(data, ncol_, nrow_);
+  } // HipGISAXS::psf_convolution()
+
   bool HipGISAXS::check_finite(real_t* arr, unsigned int size) {
     for(unsigned int i = 0; i < size; ++ i) {
       if(!(boost::math::isfinite)(arr[i])) {
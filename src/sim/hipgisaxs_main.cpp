@@ -22,6 +22,7 @@
 #include <ctime>
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
 #ifdef _OPENMP
   #include <omp.h>
 #endif // _OPENMP
@@ -35,6 +36,9 @@
 #include <numerics/matrix.hpp>
 #include <numerics/numeric_utils.hpp>
 #include <file/edf_reader.hpp>
+#include <file/raw_data.hpp>
+#include <ff/ff_cache.hpp>
+#include <sim/dwba_combine.hpp>
 
 #if defined USE_GPU || defined FF_ANA_GPU || defined FF_NUM_GPU
   #include <init/gpu/init_gpu.cuh>
@@ -55,7 +59,7 @@
 namespace hig {
 
   HipGISAXS::HipGISAXS(int narg, char** args): freq_(0.0), k0_(0.0),
-        nqx_(0), nqy_(0), nqz_(0), nqz_extended_(0)
+        psf_kx_(0), psf_ky_(0), qbin_(1), nqx_(0), nqy_(0), nqz_(0), nqz_extended_(0)
         #ifdef USE_MPI
           , multi_node_(narg, args)
         #endif
@@ -71,8 +75,8 @@ namespace hig {
         //  ff_()
         //#endif
           {
-    // construct the qgrid -- to be changed to be not singleton ...
-    QGrid::instance();
+    // the q-grid is owned by context_
+    sweep_index_[0] = sweep_index_[1] = sweep_index_[2] = 0;
   } // HipGISAXS::HipGISAXS()
 
 
@@ -116,6 +120,9 @@ namespace hig {
             //   + compute cell size
     // TODO first check if the input has been constructed ...
 
+    // anything kept from previous runs is invalid for a new q-grid
+    sweep_.end();
+
     #ifdef USE_MPI
       root_comm_ = multi_node_.universe_key();
       int mpi_rank = multi_node_.rank(root_comm_);
@@ -174,23 +181,29 @@ namespace hig {
 
     // create Q-grid
     real_t min_alphai = input_->scattering().alphai_min() * PI_ / 180;
-    if(!QGrid::instance().create(input_->compute(), min_alphai, k0_, mpi_rank)) {
+    if(!context_.qgrid().create(input_->compute(), min_alphai, k0_, mpi_rank)) {
       if(master) std::cerr << "error: could not create Q-grid" << std::endl;
       return false;
     } // if
 
-    nrow_ = QGrid::instance().nrows();
-    ncol_ = QGrid::instance().ncols();
-    nqx_ = QGrid::instance().nqx();
-    nqy_ = QGrid::instance().nqy();
-    nqz_ = QGrid::instance().nqz();
-    nqz_extended_ = QGrid::instance().nqz_extended();
+    nrow_ = context_.qgrid().nrows();
+    ncol_ = context_.qgrid().ncols();
+    nqx_ = context_.qgrid().nqx();
+    nqy_ = context_.qgrid().nqy();
+    nqz_ = context_.qgrid().nqz();
+    nqz_extended_ = context_.qgrid().nqz_extended();
 
     if(!multilayer_.init(input_->layers())){
       if(master) std::cerr << "error: could not construct layer profile" << std::endl;
       return false;
     } // if
 
+    qbin_ = 1;    // the q-grid has the full detector resolution
+    if(!load_psf()) {
+      if(master) std::cerr << "error: could not load the detector point spread kernel" << std::endl;
+      return false;
+    } // if
+
     /* get initialization data from structures */
     num_structures_ = input_->structures().size();
 
@@ -233,13 +246,37 @@ namespace hig {
 
 
   // for fitting, update the qgrid when they are different
-  bool HipGISAXS::override_qregion(unsigned int ny, unsigned int nz, unsigned int i) {
+  bool HipGISAXS::override_qregion(unsigned int ny, unsigned int nz, unsigned int i,
+                                   unsigned int bin) {
+    sweep_.end();   // the q-grid changes
 
     OutputRegionType type = input_->compute().output_region().type_;
     real_t miny = input_->reference_region_min_x(i);
     real_t minz = input_->reference_region_min_y(i);
     real_t maxy = input_->reference_region_max_x(i);
     real_t maxz = input_->reference_region_max_y(i);
+    if(miny == maxy || minz == maxz) {
+      // no fit region given, the reference covers the output region
+      miny = input_->compute().output_minpoint()[0];
+      minz = input_->compute().output_minpoint()[1];
+      maxy = input_->compute().output_maxpoint()[0];
+      maxz = input_->compute().output_maxpoint()[1];
+    } // if
+    if(bin > 1) {
+      // columns are binned from qy min, rows from qz max (the first row)
+      if(ny / bin < 2 || nz / bin < 2) {
+        std::cerr << "error: q-region is too small for " << bin << " x " << bin << " bins"
+                  << std::endl;
+        return false;
+      } // if
+      real_t dy = (maxy - miny) / (ny - 1), dz = (maxz - minz) / (nz - 1);
+      real_t center = (bin - 1) / 2.0;
+      ny /= bin; nz /= bin;
+      maxy = miny + ((ny - 1) * bin + center) * dy;
+      miny += center * dy;
+      minz = maxz - ((nz - 1) * bin + center) * dz;
+      maxz -= center * dz;
+    } // if
 
     #ifdef USE_MPI
       // this is done at the universal level
@@ -253,18 +290,25 @@ namespace hig {
     if(type == region_qspace) {
       // update Q-grid
       real_t min_alphai = input_->scattering().alphai_min() * PI_ / 180;
-      if(!QGrid::instance().update(ny, nz, miny, minz, maxy, maxz,
+      if(!context_.qgrid().update(ny, nz, miny, minz, maxy, maxz,
                                    freq_, min_alphai, k0_, mpi_rank)) {
         if(master) std::cerr << "error: could not update Q-grid" << std::endl;
         return false;
       } // if
 
-      nrow_ = QGrid::instance().nrows();
-      ncol_ = QGrid::instance().ncols();
-      nqx_ = QGrid::instance().nqx();
-      nqy_ = QGrid::instance().nqy();
-      nqz_ = QGrid::instance().nqz();
-      nqz_extended_ = QGrid::instance().nqz_extended();
+      nrow_ = context_.qgrid().nrows();
+      ncol_ = context_.qgrid().ncols();
+      nqx_ = context_.qgrid().nqx();
+      nqy_ = context_.qgrid().nqy();
+      nqz_ = context_.qgrid().nqz();
+      nqz_extended_ = context_.qgrid().nqz_extended();
+
+      // the smearing and the point spread kernel are in detector pixels
+      if(bin != qbin_ && !bin_psf(bin)) {
+        if(master) std::cerr << "error: could not bin the point spread kernel" << std::endl;
+        return false;
+      } // if
+      qbin_ = bin;
 
     } else if(type == region_pixels) {
       std::cerr << "uh-oh: override option for pixels has not yet been implemented" << std::endl;
@@ -276,6 +320,68 @@ namespace hig {
     return true;
   } // HipGISAXS::override_qregion()
 
+  /* flag the pixels of each line of n within r of a flagged one, using running counts */
+  static void dilate_lines(std::vector<unsigned char>& flags, unsigned int nlines,
+                           unsigned int n, size_t stride, size_t step, unsigned int r) {
+    #pragma omp parallel
+    {
+      std::vector<unsigned int> count(n + 1);
+      #pragma omp for schedule(static)
+      for(long int l = 0; l < (long int) nlines; ++ l) {
+        unsigned char* line = &flags[l * stride];
+        count[0] = 0;
+        for(unsigned int i = 0; i < n; ++ i) count[i + 1] = count[i] + (line[i * step] != 0);
+        for(unsigned int i = 0; i < n; ++ i) {
+          unsigned int lo = (i > r) ? i - r : 0, hi = std::min(n, i + r + 1);
+          line[i * step] = (count[hi] > count[lo]);
+        } // for
+      } // for
+    } // omp parallel
+  } // dilate_lines()
+
+
+  bool HipGISAXS::select_pixels(const std::vector<unsigned int>& mask) {
+    sweep_.end();   // the q-points change
+    size_t imsize = (size_t) nrow_ * ncol_;
+    std::vector<unsigned int> pixels;
+    if(!mask.empty()) {
+      if(mask.size() != imsize) {
+        std::cerr << "error: pixel selection mask does not match the image size" << std::endl;
+        return false;
+      } // if
+      // the smearing kernel is truncated at 4 sigma, the point spread kernel is centered
+      real_t sigma = input_->scattering().smearing() / qbin_;
+      unsigned int halo = (sigma > TINY_) ? (unsigned int) std::ceil(4 * sigma) : 0;
+      std::vector<unsigned char> flags(imsize);
+      for(size_t i = 0; i < imsize; ++ i) flags[i] = (mask[i] != 0);
+      dilate_lines(flags, nrow_, ncol_, ncol_, 1, halo + psf_.kx() / 2);
+      dilate_lines(flags, ncol_, nrow_, 1, ncol_, halo + psf_.ky() / 2);
+      for(size_t i = 0; i < imsize; ++ i) if(flags[i]) pixels.push_back(i);
+    } // if
+    if(!context_.qgrid().select(pixels)) return false;
+    nqx_ = context_.qgrid().nqx();
+    nqy_ = context_.qgrid().nqy();
+    nqz_ = context_.qgrid().nqz();
+    nqz_extended_ = context_.qgrid().nqz_extended();
+
+    #ifdef USE_MPI
+      bool master = multi_node_.is_master(root_comm_);
+    #else
+      bool master = true;
+    #endif
+    if(master && context_.qgrid().sparse())
+      std::cout << "-- Simulating " << nqz_ << " of " << imsize << " pixels" << std::endl;
+    return true;
+  } // HipGISAXS::select_pixels()
+
+
+  /* index of a value in a sweep starting at min with the given step */
+  static int sweep_position(real_t val, real_t min, real_t step) {
+    if(step == 0) return 0;
+    return (int) std::floor((val - min) / step + 0.5);
+  } // sweep_position()
+
+
   /**
    * This is the main function called from outside
    * It loops over all configurations and calls the simulation routine
@@ -317,6 +423,17 @@ namespace hig {
             << "**                    Num tilt: " << num_tilt << std::endl;
     } // if
 
+    // the container covers the whole sweep, before it is divided among the processes
+    if(use_container()) {
+      std::vector<real_t> alphai_vals, phi_vals, tilt_vals;
+      for(int i = 0; i < num_alphai; ++ i) alphai_vals.push_back(alphai_min + i * alphai_step);
+      for(int i = 0; i < num_phi; ++ i) phi_vals.push_back(phi_min + i * phi_step);
+      for(int i = 0; i < num_tilt; ++ i) tilt_vals.push_back(tilt_min + i * tilt_step);
+      if(!open_container(alphai_vals, phi_vals, tilt_vals, num_phi > 1 || num_tilt > 1))
+        return false;
+    } // if
+    const real_t alphai_start = alphai_min, phi_start = phi_min, tilt_start = tilt_min;
+
     // loop over all alphai, phi, and tilt
 
     #ifdef USE_MPI
@@ -342,14 +459,28 @@ namespace hig {
       int *amasters = new (std::nothrow) int[multi_node_.size(sim_comm_)];
       // all alphai masters tell the world master about who they are
       multi_node_.allgather(sim_comm_, &temp_amaster, 1, amasters, 1);
+
+      // the container writes are collective, so all processes take part in as many of
+      // them as the one with the most incidence angles
+      int max_alphai = num_alphai;
+      if(use_container()) {
+        std::vector<int> proc_alphai(multi_node_.size(sim_comm_));
+        multi_node_.allgather(sim_comm_, &num_alphai, 1, &proc_alphai[0], 1);
+        max_alphai = *std::max_element(proc_alphai.begin(), proc_alphai.end());
+      } // if
     #else
       bool amaster = true;
     #endif // USE_MPI
 
+    // work independent of the angles is shared by all the runs of the sweep, and work
+    // depending only on alpha_i by the batch of phi and tilt runs of each incidence angle
+    sweep_.begin();
+
     // for each incidence angle
     real_t alpha_i = alphai_min;
     for(int i = 0; i < num_alphai; i ++, alpha_i += alphai_step) {
       real_t alphai = alpha_i * PI_ / 180;
+      sweep_.begin_batch(alphai);
 
       real_t* averaged_data = NULL;    // to hold summation of all (if needed)
 
@@ -427,6 +558,9 @@ namespace hig {
 
           /* run a gisaxs simulation */
 
+          sweep_index_[0] = sweep_position(alpha_i, alphai_start, alphai_step);
+          sweep_index_[1] = sweep_position(phi, phi_start, phi_step);
+          sweep_index_[2] = sweep_position(tilt, tilt_start, tilt_step);
           real_t* final_data = NULL;
           if(!run_gisaxs(alpha_i, alphai, phi_rad, tilt_rad, final_data,
                 #ifdef USE_MPI
@@ -435,11 +569,21 @@ namespace hig {
                 0)) {
             if(tmaster)
               std::cerr << "error: could not finish successfully" << std::endl;
+            sweep_.end();
             return false;
           } // if
 
+          #ifdef USE_PARALLEL_HDF5
+          if(use_container() && tmaster) {
+            results_.stage_intensity(sweep_index_[0], sweep_index_[1], sweep_index_[2], final_data);
+            #ifndef USE_MPI
+              results_.flush();
+            #endif
+          } // if
+          #endif
+
           #ifdef FILEIO
-          if(tmaster) {
+          if(tmaster && !use_container()) {
             std::cout << "-- Constructing GISAXS image ... " << std::flush;
             Image img(ncol_, nrow_, input_->compute().palette());
             img.construct_image(final_data, 0); // merge this into the contructor ...
@@ -465,10 +609,11 @@ namespace hig {
             // save the actual data into a file also
             std::string data_file(output_subdir_ + 
                     "/gisaxs_ai=" + alphai_s + "_rot=" + phi_s +
-                    "_tilt=" + tilt_s + ".out");
+                    "_tilt=" + tilt_s + raw_data_extension(input_->compute().output_format()));
             std::cout << "-- Saving raw data in " << data_file << " ... "
                 << std::flush;
-            save_gisaxs(final_data, data_file);
+            save_gisaxs(final_data, data_file,
+                        "alphai=" + alphai_s + "\nphi=" + phi_s + "\ntilt=" + tilt_s + "\n");
             std::cout << "done." << std::endl;
           } // if
           #else
@@ -577,6 +722,18 @@ namespace hig {
 
       #endif
 
+      #ifdef USE_PARALLEL_HDF5
+      if(use_container()) {
+        if(amaster && (num_phi > 1 || num_tilt > 1) && averaged_data != NULL) {
+          results_.stage_averaged(sweep_index_[0], averaged_data);
+          delete[] averaged_data;
+          averaged_data = NULL;
+        } // if
+        // all processes have done the same number of incidence angles here
+        results_.flush();
+      } // if
+      #endif
+
       #ifdef FILEIO
       if(amaster && (num_phi > 1 || num_tilt > 1)) {
         if(averaged_data != NULL) {
@@ -595,9 +752,10 @@ namespace hig {
 
           // save the actual data into a file also
           std::string data_file(output_subdir_ + 
-                  "/gisaxs_ai=" + alphai_s + "_averaged.out");
+                  "/gisaxs_ai=" + alphai_s + "_averaged" +
+                  raw_data_extension(input_->compute().output_format()));
           std::cout << "-- Saving averaged raw data in " << data_file << " ... " << std::flush;
-          save_gisaxs(averaged_data, data_file);
+          save_gisaxs(averaged_data, data_file, "alphai=" + alphai_s + "\naveraged=1\n");
           std::cout << "done." << std::endl;
 
           delete[] averaged_data;
@@ -606,9 +764,21 @@ namespace hig {
       #endif // FILEIO
 
     } // for alphai
+    #ifdef USE_PARALLEL_HDF5
+    if(use_container()) {
+      #ifdef USE_MPI
+        for(int i = num_alphai; i < max_alphai; ++ i) results_.flush();
+      #endif
+      if(!results_.close()) {
+        sweep_.end();
+        return false;
+      } // if
+    } // if
+    #endif
     #ifdef USE_MPI
       multi_node_.free(alphai_comm);
     #endif
+    sweep_.end();
 
     sim_timer.stop();
     if(master) {
@@ -662,6 +832,9 @@ namespace hig {
     real_t alphai = alpha_i * PI_ / 180;
     real_t phi_rad = phi_min * PI_ / 180;
     real_t tilt_rad = tilt_min * PI_ / 180;
+    // keep the intermediate products across the evaluations of a fit, update_params
+    // invalidates those depending on the updated parameters
+    if(!sweep_.fitting()) sweep_.begin(true);
     #if VERBOSE_LEVEL > VERBOSE_LEVEL_ZERO
     if(master) std::cout << "-- Computing GISAXS ... " << std::endl << std::flush;
     #endif
@@ -702,7 +875,7 @@ namespace hig {
     // if(!run_init(alphai, phi, tilt, rotation_matrix)) return false;
     rot_ = RotMatrix_t(2, phi);
 
-    //QGrid::instance().save ("qgrid.out");
+    //context_.qgrid().save ("qgrid.out");
     #ifdef USE_MPI
       bool master = multi_node_.is_master(comm_key);
       int ss = multi_node_.size(comm_key);
@@ -743,8 +916,9 @@ namespace hig {
       bool smaster = true;
     #endif // USE_MPI
 
-    // initialize memory for struct_intensity
-    unsigned int size = nrow_ * ncol_;
+    // initialize memory for struct_intensity, with one value per q-point. with a pixel
+    // selection these are scattered into the image only after the structures are combined
+    unsigned int size = context_.qgrid().npoints();
     real_t* struct_intensity = NULL;
     complex_t* c_struct_intensity = NULL;
     if(smaster) {
@@ -778,33 +952,110 @@ namespace hig {
       /* calulate propagation coefficients for current layer*/
       std::string layer_key = curr_struct->grain_layer_key();
       int order = curr_struct->layer_order();
-      layer_qgrid_qz(alphai, multilayer_[order].one_minus_n2());
       complex_vec_t fc; 
-      if (!multilayer_.propagation_coeffs(fc, k0_, alphai, order)){
-        //TODO call mpi abort
-        std::exit(1);
-      }
+      std::vector<real_t> stack;
+      multilayer_.signature(stack);
+      const SweepCache::layer_t* layer = sweep_.find_layer(order, alphai, stack);
+      if(layer != NULL) {
+        // same incidence angle and layers as a previous structure or run
+        context_.qgrid().qz_extended(layer->qz_extended_);
+        nqz_extended_ = context_.qgrid().nqz_extended();
+        fc = layer->fc_;
+      } else {
+        layer_qgrid_qz(alphai, multilayer_[order].one_minus_n2());
+        if (!multilayer_.propagation_coeffs(fc, k0_, alphai, order, context_.qgrid_view())){
+          //TODO call mpi abort
+          std::exit(1);
+        }
+        if(sweep_.active()) {
+          SweepCache::layer_t l;
+          l.alphai_ = alphai;
+          l.stack_.swap(stack);
+          l.qz_extended_.assign(context_.qgrid().qz_extended_begin(),
+                                context_.qgrid().qz_extended_end());
+          l.fc_ = fc;
+          sweep_.insert_layer(order, l);
+        } // if
+      } // if-else
+      const QGridView qgrid = context_.qgrid_view();
 
-      real_t *dd = NULL, *nn = NULL, *wght = NULL;    // come back to this ...
-                        // these structures can be improved ...
-      real_t tz = 0;
-      int num_dimen = 3;
-      int ndx = 0, ndy = 0;
-      // compute dd and nn
-      spatial_distribution(s, tz, num_dimen, ndx, ndy, dd);
-      orientation_distribution(s, dd, ndx, ndy, nn, wght);
+      // the grain ensemble does not depend on the angles, in a sweep it is set up only once
+      SweepCache::grains_t local_grains = { 0, NULL, NULL, NULL, false };
+      SweepCache::grains_t* grains = sweep_.find_grains((*s).first);
       std::string struct_dist = (*s).second.grain_orientation();
-      int num_grains = ndx;
+      if(grains == NULL) {
+        real_t *dd = NULL, *nn = NULL, *wght = NULL;    // come back to this ...
+                          // these structures can be improved ...
+        real_t tz = 0;
+        int num_dimen = 3;
+        int ndx = 0, ndy = 0;
+        // compute dd and nn
+        spatial_distribution(s, tz, num_dimen, ndx, ndy, dd);
+        orientation_distribution(s, dd, ndx, ndy, nn, wght);
+        if(struct_dist == "bragg") {
+          // TODO this is a hack
+          if(dd) delete[] dd;
+          dd = new (std::nothrow) real_t[ndx * 3];
+          for(int i = 0; i < ndx * 3; i++) dd[i] = REAL_ZERO_;
+        } // if
+        local_grains.num_grains_ = ndx;
+        local_grains.dd_ = dd;
+        local_grains.nn_ = nn;
+        local_grains.wght_ = wght;
+
+        grains = sweep_.insert_grains((*s).first, local_grains);
+        if(grains == NULL) grains = &local_grains;
+      } // if
+
+      if(!grains->samples_valid_) {
+        SweepCache::grains_t& g = *grains;
+        g.scaling_samples_.clear();
+        g.scaling_weights_.clear();
+        g.repeats_.clear();
+
+        /* grain scalings */
+        std::vector<StatisticType> dist = s->second.grain_scaling_dist();
+        vector3_t mean, stddev;
+        std::vector<int> scaling_nvals;
+        for(int i = 0; i < 3; ++ i) {
+          if(s->second.grain_scaling_is_dist(i)) {
+            mean[i] = s->second.grain_scaling()[i];
+            stddev[i] = s->second.grain_scaling_stddev()[i];
+            // if sigma is zero set sampling count to 1
+            if(stddev[i] == 0) scaling_nvals.push_back(1);
+            else scaling_nvals.push_back(s->second.grain_scaling_nvals()[i]);
+          } else {
+            mean[i] = s->second.grain_scaling()[i];
+            stddev[i] = 0;
+            scaling_nvals.push_back(1);
+          } // if-else
+        } // for
+        construct_scaling_distribution(dist, mean, stddev, scaling_nvals,
+                                       g.scaling_samples_, g.scaling_weights_);
+
+        /* grain repetitions */
+        if((*s).second.grain_is_repetition_dist()) {
+          // get nvalues from scaling distribution
+          int num_repeats;
+          if(g.scaling_samples_.size() > 1) num_repeats = g.scaling_samples_.size();
+          else num_repeats = g.num_grains_;
+          construct_repetition_distribution((*s).second.grain_repetitiondist(), 
+                                            num_repeats, g.repeats_);
+        } else {
+          vector3_t grain_repeats = (*s).second.grain_repetition();
+          g.repeats_.push_back(grain_repeats);
+        } // if-else
+        g.samples_valid_ = true;
+      } // if
+
+      real_t *dd = grains->dd_, *nn = grains->nn_, *wght = grains->wght_;
+      int num_grains = grains->num_grains_;
 
       int r1axis, r2axis, r3axis;
       if(struct_dist == "bragg") {
         r1axis = 2;
         r2axis = 0;
         r3axis = 1;
-        // TODO this is a hack
-        if(dd) delete[] dd;
-        dd = new (std::nothrow) real_t[ndx * 3];
-        for(int i = 0; i < ndx * 3; i++) dd[i] = REAL_ZERO_;
       } else {
         r1axis = (int) (*s).second.rotation_rot1()[0];
         r2axis = (int) (*s).second.rotation_rot2()[0];
@@ -817,44 +1068,10 @@ namespace hig {
       } // if
       #endif
 
-      /* grain scalings */
-      bool is_scaling_distribution = false;
-      std::vector<StatisticType> dist = s->second.grain_scaling_dist();
-      vector3_t mean, stddev;
-      std::vector<int> scaling_nvals;
-      for(int i = 0; i < 3; ++ i) {
-        if(s->second.grain_scaling_is_dist(i)) {
-          is_scaling_distribution = true;
-          mean[i] = s->second.grain_scaling()[i];
-          stddev[i] = s->second.grain_scaling_stddev()[i];
-          // if sigma is zero set sampling count to 1
-          if(stddev[i] == 0) scaling_nvals.push_back(1);
-          else scaling_nvals.push_back(s->second.grain_scaling_nvals()[i]);
-        } else {
-          mean[i] = s->second.grain_scaling()[i];
-          stddev[i] = 0;
-          scaling_nvals.push_back(1);
-        } // if-else
-      } // for
-      std::vector<real_t> scaling_samples, scaling_weights;
-      construct_scaling_distribution(dist, mean, stddev, scaling_nvals,
-                                     scaling_samples, scaling_weights);
-
-      /* grain repetitions */
-      bool is_grain_repetition_dist = false;
-      std::vector<vector3_t> all_grains_repeats;
-      if((*s).second.grain_is_repetition_dist()) {
-        is_grain_repetition_dist = true;
-        // get nvalues from scaling distribution
-        int num_repeats;
-        if(scaling_samples.size() > 1) num_repeats = scaling_samples.size();
-        else num_repeats = num_grains;
-        construct_repetition_distribution((*s).second.grain_repetitiondist(), 
-                                          num_repeats, all_grains_repeats);
-      } else {
-        vector3_t grain_repeats = (*s).second.grain_repetition();
-        all_grains_repeats.push_back(grain_repeats);
-      } // if-else
+      const std::vector<real_t>& scaling_samples = grains->scaling_samples_;
+      const std::vector<real_t>& scaling_weights = grains->scaling_weights_;
+      bool is_grain_repetition_dist = (*s).second.grain_is_repetition_dist();
+      const std::vector<vector3_t>& all_grains_repeats = grains->repeats_;
 
       int num_repeat_scaling,
           num_scaling = scaling_samples.size() / 3,
@@ -912,17 +1129,80 @@ namespace hig {
 
       real_t *grain_id = NULL;
       if(gmaster) {    // only the structure master needs this
-        grain_id = new (std::nothrow) real_t[nrow_ * ncol_];
+        grain_id = new (std::nothrow) real_t[size];
         if(grain_id == NULL) {
           std::cerr << "error: could not allocate memory for 'id'" << std::endl;
           return false;
         } // if
         // initialize to 0
-        memset(grain_id, 0 , nrow_ * ncol_ * sizeof(real_t));
+        memset(grain_id, 0 , size * sizeof(real_t));
       } // if
 
+      // when fitting, nothing needs to be done for a structure unaffected by the last
+      // parameter update, and grain form factors are reused when only the sf changed
+      SweepCache::products_t* products = sweep_.products((*s).first, num_gr);
+      bool reuse_intensity = (products != NULL && products->intensity_valid_);
+      if(reuse_intensity && gmaster)
+        std::copy(products->intensity_.begin(), products->intensity_.end(), grain_id);
+      int grain_end = reuse_intensity ? grain_min : grain_max;
+
+      // grain invariant structure factors are computed once for the structure, and in a
+      // sweep once for all the runs with the same incidence angle
+      bool sf_invariant = StructureFactor::grain_invariant(curr_struct->getStructureType());
+      StructureFactor local_sf;
+      StructureFactor* struct_sf_p = sf_invariant ? sweep_.find_sf((*s).first) : NULL;
+      bool compute_struct_sf = sf_invariant && struct_sf_p == NULL && !reuse_intensity;
+      if(compute_struct_sf) struct_sf_p = sweep_.insert_sf((*s).first);
+      if(struct_sf_p == NULL) struct_sf_p = &local_sf;
+      StructureFactor& struct_sf = *struct_sf_p;
+      if(compute_struct_sf) {
+        struct_sf.putStructureType(curr_struct->getStructureType());
+        vector3_t origin(0., 0., 0.), unit_scaling(1., 1., 1.);
+        vector3_t grain_repeats = all_grains_repeats[0];
+        RotMatrix_t identity;
+        if(!structure_factor(struct_sf, input_->scattering().experiment(), origin, curr_lattice,
+                grain_repeats, unit_scaling, identity,
+                curr_struct->paracrystal(), curr_struct->percusyevick()
+                #ifdef USE_MPI
+                  , grain_comm
+                #endif
+                )) {
+          std::cerr << "error: aborting run due to previous errors" << std::endl;
+          std::exit(1);
+        } // if
+      } // if
+
+      // without MPI, the grains are distributed among threads instead, each thread
+      // accumulating into its own image. these are summed up after all grains are done
+      int num_grain_threads = 1;
+      #if defined _OPENMP && !defined USE_MPI
+        num_grain_threads = std::max(1, std::min(omp_get_max_threads(), grain_end - grain_min));
+      #endif
+      std::vector<std::vector<real_t> > thread_grain_id(num_grain_threads > 1 ? num_grain_threads : 0);
+      int team_size = 1;    // the runtime may give fewer threads than asked for
+
+      #pragma omp parallel num_threads(num_grain_threads) if(num_grain_threads > 1)
+      {
+      #ifdef _OPENMP
+        int thread_num = omp_get_thread_num();
+        #pragma omp single
+        team_size = omp_get_num_threads();
+      #else
+        int thread_num = 0;
+      #endif
+      real_t* thread_id = grain_id;
+      if(num_grain_threads > 1 && gmaster) {
+        thread_grain_id[thread_num].resize(size, 0.0);
+        thread_id = &thread_grain_id[thread_num][0];
+      } // if
+      // untranslated form factors are valid only for the current qz_extended
+      FormFactorCache ff_cache;
+      // scratch for combining the dwba channels, reused across grains
+      DWBACombine dwba;
+
       // loop over grains - each process processes num_gr grains
-      for(int grain_i = grain_min; grain_i < grain_max; grain_i ++) {  // or distributions
+      #pragma omp for schedule(dynamic, 1)
+      for(int grain_i = grain_min; grain_i < grain_end; grain_i ++) {  // or distributions
 
         #if VERBOSE_LEVEL > VERBOSE_LEVEL_ONE
         if(gmaster) {
@@ -965,56 +1245,80 @@ namespace hig {
         std::vector<complex_t> ff;
         unsigned int sz = nqz_;
         if(input_->scattering().experiment() == "gisaxs") sz = nqz_extended_;
-        ff.clear();
-        ff.resize(sz, CMPLX_ZERO_);
-
-        // loop over all elements in the unit cell
-        for(Unitcell::element_iterator_t e = curr_unitcell.element_begin();
-            e != curr_unitcell.element_end(); ++ e) {
-
-          std::string shape_key = e->first;
-          Shape shape = input_->shapes().at(shape_key);
-          ShapeName shape_name = shape.name();
-          real_t zrot = shape.zrot();
-          real_t yrot = shape.yrot();
-          real_t xrot = shape.xrot();
-          std::string shape_file = shape.filename();
-          shape_param_list_t shape_params = shape.param_list();
-          complex_t dn2 = multilayer_[order].one_minus_n2() - shape.one_minus_n2();
-
-          // shape rotation matrix
-          RotMatrix_t shape_rot = rot *  RotMatrix_t(0, xrot) * RotMatrix_t(1, yrot) * RotMatrix_t(2, zrot);
-
-          for(Unitcell::location_iterator_t l = (*e).second.begin(); l != (*e).second.end(); ++ l) {
-            vector3_t transvec = (*l);
-            #ifdef FF_NUM_GPU   // use GPU
-              #ifdef FF_NUM_GPU_FUSED
-                FormFactor eff(64, 8);
-              #elif defined KERNEL2
-                FormFactor eff(2, 4, 4);
-              #else
-                FormFactor eff(64);
+        unsigned int local_grain = grain_i - grain_min;
+        if(products != NULL && !products->grain_ff_[local_grain].empty()) {
+          // unchanged since the previous fitting evaluation
+          ff = products->grain_ff_[local_grain];
+        } else {
+          ff.clear();
+          ff.resize(sz, CMPLX_ZERO_);
+
+          // loop over all elements in the unit cell
+          for(Unitcell::element_iterator_t e = curr_unitcell.element_begin();
+              e != curr_unitcell.element_end(); ++ e) {
+
+            std::string shape_key = e->first;
+            Shape shape = input_->shapes().at(shape_key);
+            ShapeName shape_name = shape.name();
+            real_t zrot = shape.zrot();
+            real_t yrot = shape.yrot();
+            real_t xrot = shape.xrot();
+            std::string shape_file = shape.filename();
+            shape_param_list_t shape_params = shape.param_list();
+            complex_t dn2 = multilayer_[order].one_minus_n2() - shape.one_minus_n2();
+
+            // shape rotation matrix
+            RotMatrix_t shape_rot = rot *  RotMatrix_t(0, xrot) * RotMatrix_t(1, yrot) * RotMatrix_t(2, zrot);
+
+            // compute the untranslated form factor once per shape and rotation
+            std::string ff_key = FormFactorCache::key(shape_key, shape_name, shape_file,
+                                                      shape_params, shape_rot);
+            const FormFactorCache::ff_vec_t* ff0 = ff_cache.find(ff_key);
+            if(ff0 == NULL) {
+              #ifdef FF_NUM_GPU   // use GPU
+                #ifdef FF_NUM_GPU_FUSED
+                  FormFactor eff(64, 8);
+                #elif defined KERNEL2
+                  FormFactor eff(2, 4, 4);
+                #else
+                  FormFactor eff(64);
+                #endif
+              #else   // use CPU or MIC
+                FormFactor eff;
               #endif
-            #else   // use CPU or MIC
-              FormFactor eff;
-            #endif
+              eff.triangle_method(input_->compute().triangle_method(),
+                                  input_->compute().triangle_tolerance());
+              eff.density_padding(input_->compute().density_padding());
+
+              // TODO remove these later
+              real_t shape_tau = 0., shape_eta = 0.;
+              vector3_t origin(0., 0., 0.);
+              fftimer.resume();
+              //read_form_factor("curr_ff.out");
+              form_factor(eff, shape_name, shape_file, shape_params, origin,
+                    shape_tau, shape_eta, shape_rot
+                    #ifdef USE_MPI
+                      , grain_comm
+                    #endif
+                    );
+              fftimer.pause();
+              std::vector<complex_t> eff_data;
+              eff.swap_ff(eff_data);
+              ff0 = ff_cache.insert(ff_key, eff_data);
+            } // if
 
-            // TODO remove these later
-            real_t shape_tau = 0., shape_eta = 0.;
+            // numeric form factors do not apply the translation, keep it that way
+            bool translate = (shape_name != shape_custom);
             fftimer.resume();
-            //read_form_factor("curr_ff.out");
-            form_factor(eff, shape_name, shape_file, shape_params, transvec,
-                  shape_tau, shape_eta, shape_rot
-                  #ifdef USE_MPI
-                    , grain_comm
-                  #endif
-                  );
+            for(Unitcell::location_iterator_t l = (*e).second.begin(); l != (*e).second.end(); ++ l) {
+              vector3_t transvec = (*l);
+              // for each location, add the FFs
+              FormFactorCache::accumulate(*ff0, dn2, transvec, shape_rot, translate, sz, qgrid, ff);
+            } // for l
             fftimer.pause();
-
-            // for each location, add the FFs
-            for(unsigned int i = 0; i < sz; ++ i) ff[i] += dn2 * eff[i]; 
-          } // for l
-        } // for e
+          } // for e
+          sweep_.keep_ff(products, local_grain, ff);
+        } // if-else
 
         fftimer.stop();
         #if VERBOSE_LEVEL > VERBOSE_LEVEL_ONE
@@ -1027,6 +1331,14 @@ namespace hig {
           std::cerr << "** ARRAY CHECK ** ff failed check" << std::endl;
         } // if*/
 
+        // fc * ff is the same for all scaling samples of this grain
+        unsigned int imsize = size;
+        bool is_gisaxs = (input_->scattering().experiment() == "gisaxs");
+        if(gmaster && !dwba.prepare(is_gisaxs ? &fc[0] : NULL, ff, imsize, is_gisaxs ? 4 : 1)) {
+          std::cerr << "error: aborting run due to previous errors" << std::endl;
+          std::exit(1);
+        } // if
+
         sftimer.start(); sftimer.pause();
         for(int i_scale = 0; i_scale < num_repeat_scaling; ++ i_scale) {
 
@@ -1059,62 +1371,70 @@ namespace hig {
 
           /* calulate structure factor for the grain */
           real_t weight = gauss_weight * scaling_wght;
-          StructureFactor sf;
-          sf.putStructureType(curr_struct->getStructureType());
-          std::shared_ptr<Paracrystal> pc = curr_struct->paracrystal();
-          std::shared_ptr<PercusYevick> py = curr_struct->percusyevick();
-          sftimer.resume();
-          if(!structure_factor(sf, input_->scattering().experiment(), center, curr_lattice,
-                  grain_repeats, grain_scaling, rot, pc, py
-                  #ifdef USE_MPI
-                    , grain_comm
-                  #endif
-                  )){
-              std::cerr << "error: aborting run due to previous errors" << std::endl;
-              std::exit(1);
-          }
-          sftimer.pause();
+          StructureFactor grain_sf;
+          StructureFactor& sf = sf_invariant ? struct_sf : grain_sf;
+          if(!sf_invariant) {
+            sf.putStructureType(curr_struct->getStructureType());
+            std::shared_ptr<Paracrystal> pc = curr_struct->paracrystal();
+            std::shared_ptr<PercusYevick> py = curr_struct->percusyevick();
+            sftimer.resume();
+            if(!structure_factor(sf, input_->scattering().experiment(), center, curr_lattice,
+                    grain_repeats, grain_scaling, rot, pc, py
+                    #ifdef USE_MPI
+                      , grain_comm
+                    #endif
+                    )){
+                std::cerr << "error: aborting run due to previous errors" << std::endl;
+                std::exit(1);
+            }
+            sftimer.pause();
+          } // if
 
           /* compute intensities using sf and ff */
           if(gmaster) {  // grain master
-            //complex_t* base_id = grain_ids + (grain_i - grain_min) * nrow_ * ncol_;
-            real_t* base_id = grain_id;
+            real_t* base_id = thread_id;
             unsigned int nslices = input_->compute().nslices();
-            unsigned int imsize = nrow_ * ncol_;
             if(nslices <= 1) {
               /* without slicing */
-              if(input_->scattering().experiment() == "gisaxs") { // GISAXS
-                for(unsigned int i = 0; i < imsize; ++ i) {
-                  unsigned int curr_index   = i;
-                  unsigned int curr_index_0 = i; 
-                  unsigned int curr_index_1 = 1 * imsize + i;
-                  unsigned int curr_index_2 = 2 * imsize + i;
-                  unsigned int curr_index_3 = 3 * imsize + i;
-                  //base_id[curr_index] = weight * 
-                  complex_t temp = weight * 
-                                   (fc[curr_index_0] * sf[curr_index_0] * ff[curr_index_0] +
-                                   fc[curr_index_1] * sf[curr_index_1] * ff[curr_index_1] +
-                                   fc[curr_index_2] * sf[curr_index_2] * ff[curr_index_2] +
-                                   fc[curr_index_3] * sf[curr_index_3] * ff[curr_index_3]);
-                  base_id[curr_index] += temp.real() * temp.real() + temp.imag() * temp.imag();
-                } // for i
-              } else {                                            // SAXS
-                for(unsigned int i = 0; i < imsize; ++ i) {
-                  complex_t temp = weight * sf[i] * ff[i];
-                  base_id[i] = temp.real() * temp.real() + temp.imag() * temp.imag();
-                } // for i
-              } // if-else
-              if(input_->compute().save_ff()){
-                std::string ffoutput(output_subdir_ + "/ff.out");
-                std::ofstream fout(ffoutput, std::ios::out);
-                for (int i = 0; i < nqz_extended_; i++)
-                  fout << std::abs(ff[i]) << std::endl;
-                fout.close();
+              dwba.accumulate(sf, weight, base_id);
+              #pragma omp critical (grain_output)
+              {
+              OutputFormatType format = input_->compute().output_format();
+              if(use_container()) {
+                #ifdef USE_PARALLEL_HDF5
+                // the factors of the first grain of each structure
+                if(grain_i == 0) {
+                  int struct_index = s_num;
+                  #ifdef USE_MPI
+                    struct_index += soffset;
+                  #endif
+                  if(input_->compute().save_ff())
+                    results_.stage_factor(HDF5ResultWriter::ff, sweep_index_[0], sweep_index_[1],
+                                          sweep_index_[2], struct_index, &ff[0]);
+                  if(input_->compute().savesf())
+                    results_.stage_factor(HDF5ResultWriter::sf, sweep_index_[0], sweep_index_[1],
+                                          sweep_index_[2], struct_index, &sf[0]);
+                } // if
+                #endif
+              } else if(input_->compute().save_ff()){
+                std::string ffoutput(output_subdir_ + "/ff" + raw_data_extension(format));
+                if(format == output_format_text) {
+                  std::ofstream fout(ffoutput, std::ios::out);
+                  for (int i = 0; i < nqz_extended_; i++)
+                    fout << std::abs(ff[i]) << std::endl;
+                  fout.close();
+                } else {
+                  std::vector<real_t> ffmag(nqz_extended_);
+                  for (int i = 0; i < nqz_extended_; i++) ffmag[i] = std::abs(ff[i]);
+                  write_raw_data(ffoutput, &ffmag[0], 1, &nqz_extended_,
+                                 format == output_format_binary32, "quantity=|ff|\n");
+                } // if-else
               } // if
-              if(input_->compute().savesf()) {
-                std::string sfoutput(output_subdir_ + "/sf.out");
-                sf.save_sf(sfoutput);
+              if(input_->compute().savesf() && !use_container()) {
+                std::string sfoutput(output_subdir_ + "/sf" + raw_data_extension(format));
+                sf.save_sf(sfoutput, format);
               } // if
+              } // omp critical
             } else {
               /* perform slicing */
               // not yet implemented ...
@@ -1140,6 +1460,22 @@ namespace hig {
 
       } // for num_gr
 
+      // sum up the per thread images
+      if(num_grain_threads > 1 && gmaster) {
+        #pragma omp for
+        for(unsigned int z = 0; z < size; ++ z) {
+          real_t sum = 0.0;
+          for(int t = 0; t < team_size; ++ t) sum += thread_grain_id[t][z];
+          grain_id[z] += sum;
+        } // for
+      } // if
+      } // omp parallel
+
+      if(products != NULL && !reuse_intensity) {
+        if(gmaster) products->intensity_.assign(grain_id, grain_id + size);
+        products->intensity_valid_ = true;
+      } // if
+
       //complex_t* id = NULL;
       real_t* id = NULL;
       #ifdef USE_MPI
@@ -1147,7 +1483,7 @@ namespace hig {
           // collect grain_ids from all procs in struct_comm
           if(smaster) {
             //id = new (std::nothrow) complex_t[num_grains * nrow_ * ncol_];
-            id = new (std::nothrow) real_t[multi_node_.size(struct_comm) * nrow_ * ncol_];
+            id = new (std::nothrow) real_t[multi_node_.size(struct_comm) * size];
           } // if
           int *proc_sizes = new (std::nothrow) int[multi_node_.size(struct_comm)];
           int *proc_displacements = new (std::nothrow) int[multi_node_.size(struct_comm)];
@@ -1156,14 +1492,14 @@ namespace hig {
           if(smaster) {
             // make sure you get data only from the gmasters
             for(int i = 0; i < multi_node_.size(struct_comm); ++ i)
-              proc_sizes[i] *= (gmasters[i] * nrow_ * ncol_);
+              proc_sizes[i] *= (gmasters[i] * size);
             proc_displacements[0] = 0;
             for(int i = 1; i < multi_node_.size(struct_comm); ++ i)
               proc_displacements[i] = proc_displacements[i - 1] + proc_sizes[i - 1];
           } // if
           //multi_node_.gatherv(struct_comm, grain_ids, gmaster * num_gr * nrow_ * ncol_,
           //                    id, proc_sizes, proc_displacements);
-          multi_node_.gatherv(struct_comm, grain_id, gmaster * nrow_ * ncol_,
+          multi_node_.gatherv(struct_comm, grain_id, gmaster * size,
                               id, proc_sizes, proc_displacements);
           delete[] proc_displacements;
           delete[] proc_sizes;
@@ -1175,9 +1511,9 @@ namespace hig {
 
           // reduce data from all procs [ alt. use reduction instead of gatherv above ]
           if(smaster) {
-            for(int z = 0; z < nrow_ * ncol_; ++ z) {
+            for(int z = 0; z < size; ++ z) {
               real_t sum = 0.0;
-              for(int p = 0; p < multi_node_.size(struct_comm); ++ p) sum += id[p * nrow_ * ncol_ + z];
+              for(int p = 0; p < multi_node_.size(struct_comm); ++ p) sum += id[p * size + z];
               grain_id[z] = sum;
             } // for
             if(id != NULL) delete[] id;
@@ -1195,9 +1531,10 @@ namespace hig {
         id = grain_id;
       #endif
 
-      delete[] nn;
-      delete[] dd;
-      delete[] wght;
+      // these are owned by the sweep cache when sweeping
+      delete[] local_grains.nn_;
+      delete[] local_grains.dd_;
+      delete[] local_grains.wght_;
 
       if(smaster) {
         // new stuff for grain/ensemble correlation
@@ -1207,8 +1544,8 @@ namespace hig {
           case structcorr_nGnE:  // no correlation
             // struct_intensity = sum_grain(abs(grain_intensity)^2)
             // intensity = sum_struct(struct_intensity)
-            soffset = s_num * nrow_ * ncol_;
-            for(unsigned int i = 0; i < nrow_ * ncol_ ; ++ i) {
+            soffset = s_num * size;
+            for(unsigned int i = 0; i < size ; ++ i) {
               //unsigned int curr_index = i;
               //real_t sum = 0.0;
               //for(int d = 0; d < num_grains; ++ d) {
@@ -1232,12 +1569,12 @@ namespace hig {
           case structcorr_GnE:  // corr grains, non corr ensemble
             // struct_intensity = abs(sum_grain(grain_intensity))^2
             // intensty = sum_struct(struct_intensity)
-            soffset = s_num * nrow_ * ncol_;
-            for(unsigned int i = 0; i < nrow_ * ncol_; ++ i) {
+            soffset = s_num * size;
+            for(unsigned int i = 0; i < size; ++ i) {
               unsigned int curr_index = i;
               complex_t sum(0.0, 0.0);
               for(int d = 0; d < num_grains; ++ d) {
-                unsigned int id_index = d * nrow_ * ncol_ + curr_index;
+                unsigned int id_index = d * size + curr_index;
                 sum += id[id_index];
               } // for d
               struct_intensity[soffset + curr_index] = sum.real() * sum.real() +
@@ -1248,12 +1585,12 @@ namespace hig {
           case structcorr_GE:    // both correlated
             // struct_intensity = sum_grain(grain_intensity)
             // intensity = abs(sum_struct(struct_intensity))^2
-            soffset = s_num * nrow_ * ncol_;
+            soffset = s_num * size;
             for(unsigned int i = 0; i < nqz_; ++ i) {
               unsigned int curr_index = i;
               complex_t sum(0.0, 0.0);
               for(int d = 0; d < num_grains; ++ d) {
-                unsigned int id_index = d * nrow_ * ncol_ + curr_index;
+                unsigned int id_index = d * size + curr_index;
                 sum += id[id_index];
               } // for d
               c_struct_intensity[soffset + curr_index] = sum;
@@ -1291,10 +1628,10 @@ namespace hig {
         if(master) {
           if(input_->compute().param_structcorrelation() == structcorr_GE) {
             all_c_struct_intensity =
-                new (std::nothrow) complex_t[num_structures_ * nrow_ * ncol_];
+                new (std::nothrow) complex_t[num_structures_ * size];
           } else {
             all_struct_intensity =
-                new (std::nothrow) real_t[num_structures_ * nrow_ * ncol_];
+                new (std::nothrow) real_t[num_structures_ * size];
           } // if-else
         } // if
         int *proc_sizes = new (std::nothrow) int[multi_node_.size(comm_key)];
@@ -1303,18 +1640,18 @@ namespace hig {
         if(master) {
           // make sure you get data only from the smasters
           for(int i = 0; i < multi_node_.size(comm_key); ++ i)
-            proc_sizes[i] *= (smasters[i] * nrow_ * ncol_);
+            proc_sizes[i] *= (smasters[i] * size);
           proc_displacements[0] = 0;
           for(int i = 1; i < multi_node_.size(comm_key); ++ i)
             proc_displacements[i] = proc_displacements[i - 1] + proc_sizes[i - 1];
         } // if
         if(input_->compute().param_structcorrelation() == structcorr_GE) {
           multi_node_.gatherv(comm_key, c_struct_intensity,
-                    smaster * num_structs * nrow_ * ncol_,
+                    smaster * num_structs * size,
                     all_c_struct_intensity, proc_sizes, proc_displacements);
         } else {
           multi_node_.gatherv(comm_key, struct_intensity,
-                    smaster * num_structs * nrow_ * ncol_,
+                    smaster * num_structs * size,
                     all_struct_intensity, proc_sizes, proc_displacements);
         } // if-else
         delete[] proc_displacements;
@@ -1345,6 +1682,9 @@ namespace hig {
         std::cerr << "error: unable to allocate memeory." << std::endl;
         std::exit(1);
       } // if
+      // pixels outside of the selection are not simulated
+      const QGridView qgrid = context_.qgrid_view();
+      if(context_.qgrid().sparse()) memset(img3d, 0, nrow_ * ncol_ * sizeof(real_t));
 
       // sum of all struct_intensity into intensity
       // new stuff for correlation
@@ -1353,13 +1693,13 @@ namespace hig {
         case structcorr_nGnE:  // no correlation
           // struct_intensity = sum_grain(abs(grain_intensity)^2)
           // intensity = sum_struct(struct_intensity)
-          for(unsigned int z = 0; z < nrow_ * ncol_; ++ z) {
+          for(unsigned int z = 0; z < size; ++ z) {
             real_t sum = 0.0;
             for(int s = 0; s < num_structures_; ++ s) {
-              unsigned int index = s * nrow_ * ncol_ + z;
+              unsigned int index = s * size + z;
               sum += all_struct_intensity[index] * iratios[s];
             } // for d
-            img3d[z] = sum;
+            img3d[qgrid.pixel(z)] = sum;
           } // for z
           break;
 
@@ -1374,26 +1714,26 @@ namespace hig {
         case structcorr_GnE:  // corr grains, non corr ensemble
           // struct_intensity = abs(sum_grain(grain_intensity))^2
           // intensty = sum_struct(struct_intensity)
-          for(unsigned int z = 0; z < nrow_ * ncol_; ++ z) {
+          for(unsigned int z = 0; z < size; ++ z) {
             real_t sum = 0.0;
             for(int s = 0; s < num_structures_; ++ s) {
-              unsigned int index = s * nrow_ * ncol_ + z;
+              unsigned int index = s * size + z;
               sum += all_struct_intensity[index] * iratios[s];
             } // for d
-            img3d[z] = sum;
+            img3d[qgrid.pixel(z)] = sum;
           } // for z
           break;
 
         case structcorr_GE:    // both correlated
           // struct_intensity = sum_grain(grain_intensity)
           // intensity = abs(sum_struct(struct_intensity))^2
-          for(unsigned int z = 0; z < nrow_ * ncol_; ++ z) {
+          for(unsigned int z = 0; z < size; ++ z) {
             complex_t sum = 0.0;
             for(int s = 0; s < num_structures_; ++ s) {
-              unsigned int index = s * nrow_ * ncol_ + z;
+              unsigned int index = s * size + z;
               sum += all_c_struct_intensity[index] * iratios[s];
             } // for d
-            img3d[z] = sum.real() * sum.real() + sum.imag() * sum.imag();
+            img3d[qgrid.pixel(z)] = sum.real() * sum.real() + sum.imag() * sum.imag();
           } // for z
           break;
 
@@ -1412,7 +1752,8 @@ namespace hig {
     if(master) {
       // convolute/smear the computed intensities
       //real_t sigma = HiGInput::instance().scattering_smearing();
-      real_t sigma = input_->scattering().smearing();
+      // sigma is in detector pixels, the q-grid may be binned (coarse fitting levels)
+      real_t sigma = input_->scattering().smearing() / qbin_;
       if(sigma > TINY_) {
         woo::BoostChronoTimer smear_timer;
         #if VERBOSE_LEVEL > VERBOSE_LEVEL_ONE
@@ -1430,6 +1771,20 @@ namespace hig {
                   << smear_timer.elapsed_msec() << " ms." << std::endl;
         #endif
       } // if
+      // detector resolution
+      if(!psf_.empty() && img3d != NULL) {
+        woo::BoostChronoTimer psf_timer;
+        psf_timer.start();
+        if(!psf_convolution(img3d)) {
+          std::cerr << "error: failed to apply the detector point spread kernel" << std::endl;
+          return false;
+        } // if
+        psf_timer.stop();
+        #if VERBOSE_LEVEL > VERBOSE_LEVEL_ONE
+        std::cout << "**       Point spread conv. time: "
+                  << psf_timer.elapsed_msec() << " ms." << std::endl;
+        #endif
+      } // if
     } // if master
 
     return true;
@@ -1461,7 +1816,7 @@ namespace hig {
                   ) {
     #ifndef SF_GPU
       return sf.compute_structure_factor(expt, center, curr_lattice, grain_repeats,
-                      grain_scaling, rot, pc, py
+                      grain_scaling, rot, pc, py, context_.qgrid_view()
                       #ifdef USE_MPI
                         , multi_node_, comm_key 
                       #endif
@@ -1476,7 +1831,7 @@ namespace hig {
                       );
       else
         return sf.compute_structure_factor(expt, center, curr_lattice, grain_repeats,
-                      grain_scaling, rot, pc, py
+                      grain_scaling, rot, pc, py, context_.qgrid_view()
                       #ifdef USE_MPI
                         , multi_node_, comm_key 
                       #endif
@@ -1496,7 +1851,7 @@ namespace hig {
                 ) {
     return ff.compute_form_factor(shape_name, shape_file, shape_params,
                       single_layer_thickness_,
-                      curr_transvec, shp_tau, shp_eta, rot
+                      curr_transvec, shp_tau, shp_eta, rot, context_.qgrid_view()
                       #ifdef USE_MPI
                         , multi_node_, comm_key
                       #endif
@@ -1547,11 +1902,11 @@ namespace hig {
 
   bool HipGISAXS::layer_qgrid_qz(real_t alpha_i, complex_t dnl_j) {
 
-    if(!QGrid::instance().create_qz_extended(k0_, alpha_i, dnl_j)){
+    if(!context_.qgrid().create_qz_extended(k0_, alpha_i, dnl_j)){
       std::cerr << "error: something went wrong while creating qz_extended" << std::endl;
       return false;
     } // if
-    nqz_extended_ = QGrid::instance().nqz_extended();
+    nqz_extended_ = context_.qgrid().nqz_extended();
     return true;
   } // HipGISAXS::layer_qgrid_qz()
 
@@ -1611,7 +1966,7 @@ namespace hig {
 //
 //    for(unsigned int z = 0; z < nqz_; ++ z) {
 //      complex_t a1m_nkfz1, a1p_nkfz1;
-//      real_t kfz0 = QGrid::instance().qz(z) + kiz0;
+//      real_t kfz0 = context_.qgrid().qz(z) + kiz0;
 //      unsigned int idx = 4 * imsize + z;
 //
 //      if(kfz0 < 0) {
@@ -1681,7 +2036,7 @@ namespace hig {
 //    } // if
 //
 //    for(unsigned int z = 0; z < nqz_; ++ z) {
-//      real_t kzf = QGrid::instance().qz(z) + kzi;
+//      real_t kzf = context_.qgrid().qz(z) + kzi;
 //      if(kzf < 0) {
 //        fc[z] = fc[imsize + z] = fc[2*imsize + z] = fc[3*imsize + z] = CMPLX_ZERO_;
 //      } else {
@@ -1878,7 +2233,8 @@ namespace hig {
       Lattice * lattice = (Lattice *) s->second.lattice();
       vector3_t gr_scaling = s->second.grain_scaling();
       vector3_t gr_repetitions = s->second.grain_repetition();
-      lattice->bragg_angles(gr_repetitions, gr_scaling, k0_, angles);
+      lattice->bragg_angles(gr_repetitions, gr_scaling, k0_,
+                            context_.qgrid().qmin(), context_.qgrid().qmax(), angles);
       if (angles.size() > 0 ) {
         ndx = angles.size();
         nn = new (std::nothrow) real_t[ndx * 3];
@@ -2239,7 +2595,18 @@ namespace hig {
     //HiGInput::instance().print_all();
     #endif
     //return HiGInput::instance().update_params(params);
-    return input_->update_params(params);
+    if(!input_->update_params(params)) return false;
+    // the layer profile is a copy of the input layers
+    if(!multilayer_.init(input_->layers())) return false;
+    // drop the cached products which depend on the changed parameters
+    FitDependencies::stage_map_t dirty;
+    if(!fit_deps_.update(params, *input_, dirty)) {
+      sweep_.end();
+      return true;
+    } // if
+    for(FitDependencies::stage_map_t::const_iterator i = dirty.begin(); i != dirty.end(); ++ i)
+      sweep_.invalidate((*i).first, (*i).second);
+    return true;
   } // HipGISAXS::update_params()
 
 
@@ -2247,7 +2614,39 @@ namespace hig {
    * miscellaneous functions
    */
 
-  void HipGISAXS::save_gisaxs(real_t *final_data, std::string output) {
+  bool HipGISAXS::open_container(const std::vector<real_t>& alphai, const std::vector<real_t>& phi,
+                                 const std::vector<real_t>& tilt, bool average) {
+    #ifdef USE_PARALLEL_HDF5
+      std::string filename(output_subdir_ + "/gisaxs.h5");
+      unsigned int nq = (input_->scattering().experiment() == "gisaxs") ? nqz_extended_ : nqz_;
+      #ifdef USE_MPI
+        if(multi_node_.is_master(sim_comm_))
+      #endif
+      std::cout << "-- Saving results in " << filename << std::endl;
+      return results_.open(filename, alphai, phi, tilt, nrow_, ncol_, average,
+                           num_structures_, nq, input_->compute().save_ff(),
+                           input_->compute().savesf()
+                           #ifdef USE_MPI
+                             , multi_node_.comm(sim_comm_)
+                           #endif
+                           );
+    #else
+      std::cerr << "error: the hdf5 output format needs the hdf5 support enabled in your "
+                << "installation" << std::endl;
+      return false;
+    #endif
+  } // HipGISAXS::open_container()
+
+
+  void HipGISAXS::save_gisaxs(real_t *final_data, std::string output, const std::string& meta) {
+    OutputFormatType format = input_->compute().output_format();
+    if(format != output_format_text) {
+      // one bulk write of the whole image, ncol_ varying fastest
+      unsigned int dims[2] = { ncol_, nrow_ };
+      write_raw_data(output, final_data, 2, dims, format == output_format_binary32,
+                     "quantity=intensity\n" + meta);
+      return;
+    } // if
     std::ofstream f(output.c_str());
     for(unsigned int z = 0; z < nrow_; ++ z) {
       for(unsigned int y = 0; y < ncol_; ++ y) {
@@ -2286,16 +2685,16 @@ namespace hig {
  
     qout << nqx_ << " " << nqy_ << " " << nqz_extended_ << std::endl;
     for(unsigned int i = 0; i < nqx_; ++ i) {
-      qout << QGrid::instance().qx(i) << " ";
+      qout << context_.qgrid().qx(i) << " ";
     } // for
     qout << std::endl;
     for(unsigned int i = 0; i < nqy_; ++ i) {
-      qout << QGrid::instance().qy(i) << " ";
+      qout << context_.qgrid().qy(i) << " ";
     } // for
     qout << std::endl;
     for(unsigned int i = 0; i < nqz_extended_; ++ i) {
-      qout << QGrid::instance().qz_extended(i).real() << " "
-          << QGrid::instance().qz_extended(i).imag();
+      qout << context_.qgrid().qz_extended(i).real() << " "
+          << context_.qgrid().qz_extended(i).imag();
     }
     qout.close();
     return true;
@@ -0,0 +1,161 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: sweep_cache.cpp
+ *  Created: Oct 15, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+#include <sim/sweep_cache.hpp>
+
+namespace hig {
+
+  void SweepCache::clear_grains() {
+    for(std::map<std::string, grains_t>::iterator i = grains_.begin(); i != grains_.end(); ++ i) {
+      delete[] (*i).second.dd_;
+      delete[] (*i).second.nn_;
+      delete[] (*i).second.wght_;
+    } // for
+    grains_.clear();
+  } // SweepCache::clear_grains()
+
+
+  void SweepCache::erase_grains(const std::string& key) {
+    std::map<std::string, grains_t>::iterator i = grains_.find(key);
+    if(i == grains_.end()) return;
+    delete[] (*i).second.dd_;
+    delete[] (*i).second.nn_;
+    delete[] (*i).second.wght_;
+    grains_.erase(i);
+  } // SweepCache::erase_grains()
+
+
+  void SweepCache::clear_ff(products_t& p) {
+    for(unsigned int g = 0; g < p.grain_ff_.size(); ++ g) {
+      ff_bytes_ -= p.grain_ff_[g].size() * sizeof(complex_t);
+      std::vector<complex_t>().swap(p.grain_ff_[g]);
+    } // for
+  } // SweepCache::clear_ff()
+
+
+  void SweepCache::invalidate(const std::string& key, unsigned int stages) {
+    if(!active_ || stages == fit_stage_none) return;
+    if(stages & fit_stage_grains) erase_grains(key);
+    if(stages & fit_stage_samples) {
+      std::map<std::string, grains_t>::iterator i = grains_.find(key);
+      if(i != grains_.end()) (*i).second.samples_valid_ = false;
+    } // if
+    if(stages & fit_stage_sf) sfs_.erase(key);
+    std::map<std::string, products_t>::iterator p = products_.find(key);
+    if(p != products_.end()) {
+      if(stages & (fit_stage_layer | fit_stage_grains | fit_stage_ff)) clear_ff((*p).second);
+      (*p).second.intensity_valid_ = false;
+    } // if
+  } // SweepCache::invalidate()
+
+
+  SweepCache::grains_t* SweepCache::find_grains(const std::string& key) {
+    if(!active_) return NULL;
+    std::map<std::string, grains_t>::iterator i = grains_.find(key);
+    if(i == grains_.end()) return NULL;
+    return &(*i).second;
+  } // SweepCache::find_grains()
+
+
+  const SweepCache::layer_t* SweepCache::find_layer(int order, real_t alphai,
+                                                   const std::vector<real_t>& stack) const {
+    if(!active_) return NULL;
+    std::map<int, layer_t>::const_iterator i = layers_.find(order);
+    if(i == layers_.end()) return NULL;
+    if((*i).second.alphai_ != alphai || (*i).second.stack_ != stack) return NULL;
+    return &(*i).second;
+  } // SweepCache::find_layer()
+
+
+  StructureFactor* SweepCache::find_sf(const std::string& key) {
+    if(!active_) return NULL;
+    std::map<std::string, StructureFactor>::iterator i = sfs_.find(key);
+    if(i == sfs_.end()) return NULL;
+    return &(*i).second;
+  } // SweepCache::find_sf()
+
+
+  SweepCache::products_t* SweepCache::products(const std::string& key, unsigned int num_grains) {
+    if(!fitting()) return NULL;
+    std::map<std::string, products_t>::iterator i = products_.find(key);
+    if(i == products_.end()) {
+      i = products_.insert(std::make_pair(key, products_t())).first;
+      (*i).second.intensity_valid_ = false;
+    } // if
+    products_t& p = (*i).second;
+    if(p.grain_ff_.size() != num_grains) {
+      clear_ff(p);
+      p.grain_ff_.resize(num_grains);
+      p.intensity_valid_ = false;
+    } // if
+    return &p;
+  } // SweepCache::products()
+
+
+  SweepCache::grains_t* SweepCache::insert_grains(const std::string& key, grains_t& grains) {
+    if(!active_) return NULL;
+    std::map<std::string, grains_t>::iterator i = grains_.find(key);
+    if(i == grains_.end()) {
+      grains_t empty = { 0, NULL, NULL, NULL, false };
+      i = grains_.insert(std::make_pair(key, empty)).first;
+    } // if
+    grains_t& entry = (*i).second;
+    delete[] entry.dd_;
+    delete[] entry.nn_;
+    delete[] entry.wght_;
+    entry.num_grains_ = grains.num_grains_;
+    entry.dd_ = grains.dd_; grains.dd_ = NULL;
+    entry.nn_ = grains.nn_; grains.nn_ = NULL;
+    entry.wght_ = grains.wght_; grains.wght_ = NULL;
+    entry.samples_valid_ = grains.samples_valid_;
+    entry.scaling_samples_.swap(grains.scaling_samples_);
+    entry.scaling_weights_.swap(grains.scaling_weights_);
+    entry.repeats_.swap(grains.repeats_);
+    return &entry;
+  } // SweepCache::insert_grains()
+
+
+  const SweepCache::layer_t* SweepCache::insert_layer(int order, layer_t& layer) {
+    if(!active_) return NULL;
+    layer_t& entry = layers_[order];
+    entry.alphai_ = layer.alphai_;
+    entry.stack_.swap(layer.stack_);
+    entry.qz_extended_.swap(layer.qz_extended_);
+    entry.fc_.swap(layer.fc_);
+    return &entry;
+  } // SweepCache::insert_layer()
+
+
+  StructureFactor* SweepCache::insert_sf(const std::string& key) {
+    if(!active_) return NULL;
+    sfs_.erase(key);
+    return &sfs_[key];
+  } // SweepCache::insert_sf()
+
+
+  bool SweepCache::keep_ff(products_t* p, unsigned int g, const std::vector<complex_t>& ff) {
+    if(p == NULL || g >= p->grain_ff_.size()) return false;
+    size_t bytes = ff.size() * sizeof(complex_t);
+    bool fits = false;
+    #pragma omp critical (sweep_cache_ff)
+    {
+      if(ff_bytes_ + bytes <= max_ff_bytes_) { ff_bytes_ += bytes; fits = true; }
+    } // omp critical
+    if(fits) p->grain_ff_[g] = ff;
+    return fits;
+  } // SweepCache::keep_ff()
+
+} // namespace hig
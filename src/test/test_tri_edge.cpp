@@ -0,0 +1,73 @@
+/**
+ *  Project: HipGISAXS (High-Performance GISAXS)
+ *
+ *  File: test_tri_edge.cpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Abhinav Sarje <asarje@lbl.gov>
+ *
+ *  Licensing: The HipGISAXS software is only available to be downloaded and
+ *  used by employees of academic research institutions, not-for-profit
+ *  research laboratories, or governmental research facilities. Please read the
+ *  accompanying LICENSE file before downloading the software. By downloading
+ *  the software, you are agreeing to be bound by the terms of this
+ *  NON-COMMERCIAL END USER LICENSE AGREEMENT.
+ */
+
+/**
+ * The exact triangle form factor switches to its edge special case (case 2) when q is
+ * perpendicular to an edge, and must agree with the general case (case 3) on both sides of
+ * it. For the triangle (0,0,0), (1,0,0), (0,1,0) the first edge lies along x, so qx = 0 is
+ * case 2, and qx = +-eps are case 3.
+ * Standalone: link with the CPU triangle kernels (src/ff/cpu, src/ff/triangle_*.cpp).
+ */
+
+#include <iostream>
+#include <cmath>
+
+#include <ff/cpu/ff_num_cpu.hpp>
+#include <ff/triangle_table.hpp>
+
+using namespace hig;
+
+int main(int narg, char** args) {
+  triangle_t tri = { { 0., 0., 0. }, { 1., 0., 0. }, { 0., 1., 0. } };
+  TriangleTable table;
+  if(!table.build(&tri, 1)) {
+    std::cerr << "error: failed to build the triangle table" << std::endl;
+    return 1;
+  } // if
+
+  const real_t eps = 1e-5;
+  // exactly representable, so that q.n_v and proj_eq are exactly zero at qx = 0
+  const real_t qy_vals[] = { 0.75, -1.25, 2.5 };
+  const real_t qz_vals[] = { 0.5, 1.0, -2.0 };
+  int failed = 0;
+  for(int c = 0; c < 3; ++ c) {
+    real_t qx[3] = { - eps, 0., eps };
+    real_t qy[3] = { qy_vals[c], qy_vals[c], qy_vals[c] };
+    complex_t qz[3] = { qz_vals[c], qz_vals[c], qz_vals[c] };
+    complex_t* ff = NULL;
+    real_t time = 0.;
+    RotMatrix_t rot;
+    NumericFormFactorC nff;
+    if(nff.compute_exact_triangle(table, ff, 3, qx, qy, 3, qz, rot, time) != 1) {
+      std::cerr << "error: failed to compute the form factor" << std::endl;
+      return 1;
+    } // if
+    real_t scale = std::abs(ff[1]);
+    real_t err = std::max(std::abs(ff[0] - ff[1]), std::abs(ff[2] - ff[1])) / scale;
+    std::cout << "q = (+-eps, " << qy_vals[c] << ", " << qz_vals[c] << "): case 2 = " << ff[1]
+              << ", case 3 = " << ff[0] << " " << ff[2] << ", relative difference = " << err
+              << std::endl;
+    if(!(err < 1e-3)) ++ failed;
+    delete[] ff;
+  } // for
+
+  if(failed) {
+    std::cerr << "FAILED: case 2 does not match the limit of case 3" << std::endl;
+    return 1;
+  } // if
+  std::cout << "PASSED" << std::endl;
+  return 0;
+} // main()